@@ -35,6 +35,9 @@
  *   activate.
  * - Every function has a unique ID
  *   - The ID is the same used by the probing toolkit (\ref probing)
+ * - The front end functions call through a dispatch table of function pointers,
+ *   which is resolved whenever the configuration map changes,
+ *   so a call costs a single indirect jump, instead of a map lookup.
  *
  **/
 
@@ -83,6 +86,68 @@ bool soBinSelected(uint32_t id);
 
 /* *************************************** */
 
+/**
+ *  \brief Generic function pointer, used to store the entries of the dispatch table
+ */
+typedef void (*SoBinFn)(void);
+
+/* *************************************** */
+
+/**
+ *  \brief Register a front end dispatch slot.
+ *  \details The slot is immediately pointed to the binary or group version,
+ *    according to the current configuration map,
+ *    and is pointed again every time the map changes.
+ *  \param [in] id ID of the function
+ *  \param [in] slot pointer to the function pointer used by the front end
+ *  \param [in] bin the binary version of the function (NULL if there is none)
+ *  \param [in] grp the group version of the function
+ */
+void soBinRegister(uint32_t id, SoBinFn *slot, SoBinFn bin, SoBinFn grp);
+
+/* *************************************** */
+
+/**
+ *  \brief Type-safe version of \c soBinRegister
+ *  \param [in] id ID of the function
+ *  \param [in] slot pointer to the function pointer used by the front end
+ *  \param [in] bin the binary version of the function (NULL if there is none)
+ *  \param [in] grp the group version of the function
+ */
+template <typename F>
+inline void soBinDispatch(uint32_t id, F *slot, F bin, F grp)
+{
+    soBinRegister(id, reinterpret_cast<SoBinFn*>(slot), 
+            reinterpret_cast<SoBinFn>(bin), reinterpret_cast<SoBinFn>(grp));
+}
+
+/* *************************************** */
+
+/**
+ *  \brief Indication that the data types have the layout the binary versions were built with
+ *  \details The binary versions are built with 32-bit addresses, sizes and times, 4 segments per process
+ *    and 100 processes;
+ *    a build with \c SOMM23_WIDE or another \c MAX_SEGMENTS or \c MAX_PROCESSES defined has no binary versions.
+ */
+#if defined(SOMM23_WIDE) || (defined(MAX_SEGMENTS) && MAX_SEGMENTS != 4) || (defined(MAX_PROCESSES) && MAX_PROCESSES != 100)
+#define SOMM23_BINARY_LAYOUT 0
+#else
+#define SOMM23_BINARY_LAYOUT 1
+#endif
+
+/**
+ *  \brief The binary version of a function, as given to \c soBinDispatch
+ *  \details If there are no binary versions, it is NULL, and the group version is always used.
+ *  \param [in] fn name of the function
+ */
+#if SOMM23_BINARY_LAYOUT
+#define SOBIN(fn) (binaries::fn)
+#else
+#define SOBIN(fn) ((decltype(&group::fn))NULL)
+#endif
+
+/* *************************************** */
+
 /** @} */
 
 #endif /* __SOMM23_BIN_SELECTION__ */
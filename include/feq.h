@@ -122,7 +122,7 @@ void feqPrint(FILE *fout);
  * \param [in] time Time at which the event will occur
  * \param [in] pid Id of the process associated to the event
  */
-void feqInsert(FutureEventType type, uint32_t time, uint32_t pid);
+void feqInsert(FutureEventType type, SimTime time, uint32_t pid);
 
 // ================================================================================== //
 
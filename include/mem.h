@@ -31,6 +31,19 @@
  *   For the buddy system approach,
  *   the memory is splitted into halves until a block has enough size to host a segment
  *   but half of it has not.
+ *   With the \c BuddyForest variant, the memory is first covered by the biggest blocks whose size
+ *   is a power of two and whose address is a multiple of it, each one the root of a buddy tree,
+ *   so no memory is lost when its size is not a power of two.
+ *
+ *   For the slab approach, on top of the first fit lists,
+ *   segments of the most frequent sizes, the first \c MEM_SLAB_CLASSES multiples of the chunk size,
+ *   are given objects of slabs, blocks holding \c MEM_SLAB_OBJECTS objects of the same size,
+ *   while segments of other sizes are given first fit blocks.
+ *
+ *   For the two-level segregated fit (TLSF) approach,
+ *   the free blocks are kept in lists per size class, every power of two being split into
+ *   \c 1 << MEM_TLSF_SECOND_LEVEL classes, with bitmaps telling which lists are not empty,
+ *   so a block is found, and a released one merged with its neighbours, in constant time.
  *
  *   In order to minimize its external fragmentation, memory is managed in chunks bigger
  *   than a single byte.
@@ -53,8 +66,25 @@
  *   <tr> <td> \c memFree() <td align="center"> 507 <td> 3 (low medium) <td> Free a previously allocated address space mapping
  *   <tr> <td> \c memFirstFitFree() <td align="center"> 508 <td> 6 (high) <td> Free a previously (first fit) allocated block of memory
  *   <tr> <td> \c memBuddySystemFree() <td align="center"> 509 <td> 6 (high) <td> Free a previously (buddy system) allocated block of memory
+ *   <tr> <td> \c memDeferMerge() <td align="center"> 510 <td> 3 (low medium) <td> Defer the merging of released blocks to a single later pass
+ *   <tr> <td> \c memGetStats() <td align="center"> 511 <td> 4 (medium) <td> Get the external fragmentation statistics of the free memory
+ *   <tr> <td> \c memCompact() <td align="center"> 512 <td> 4 (medium) <td> Slide the occupied blocks down, joining all the free memory in a single block
+ *   <tr> <td> \c memSlabAlloc() <td align="center"> 513 <td> 5 (medium high) <td> Try to allocate a block of memory of the given size, using the slab algorithm
+ *   <tr> <td> \c memSlabFree() <td align="center"> 514 <td> 3 (low medium) <td> Free a previously (slab) allocated block of memory
+ *   <tr> <td> \c memTlsfAlloc() <td align="center"> 515 <td> 6 (high) <td> Try to allocate a block of memory of the given size, using the two-level segregated fit algorithm
+ *   <tr> <td> \c memTlsfFree() <td align="center"> 516 <td> 5 (medium high) <td> Free a previously (two-level segregated fit) allocated block of memory
+ *   <tr> <td> \c memLazyMerge() <td align="center"> 517 <td> 3 (low medium) <td> Leave up to a number of free blocks per order unmerged by the buddy system
+ *   <tr> <td> \c memShadowBitmap() <td align="center"> 518 <td> 4 (medium) <td> Keep a bitmap of the occupied chunks, also used by the first fit search
+ *   <tr> <td> \c memBitmapCheck() <td align="center"> 519 <td> 3 (low medium) <td> Check that the blocks of the active policy agree with the shadow bitmap
+ *   <tr> <td> \c memFirstFitArray() <td align="center"> 520 <td> 5 (medium high) <td> Mirror the first fit lists in sorted arrays, the free sizes scanned with vector compares
+ *   <tr> <td> \c memBitmapFind() <td align="center"> 521 <td> 4 (medium) <td> Find the first run of free chunks of the given size in the shadow bitmap
  *   </table>
  *
+ *  Functions \c memDeferMerge, \c memGetStats, \c memCompact, \c memSlabAlloc, \c memSlabFree,
+ *  \c memTlsfAlloc, \c memTlsfFree, \c memLazyMerge, \c memShadowBitmap, \c memBitmapCheck, \c memFirstFitArray
+ *  and \c memBitmapFind have no binary version,
+ *  so the \c Slab and \c Tlsf policies are only supported by the group versions.
+ *
  *  \author Artur Pereira - 2023
  */
 
@@ -75,15 +105,40 @@
  */
 #define NULL_ADDRESS 0x0
 
+/**
+ * \brief PID of the blocks of the occupied list holding slabs
+ */
+#define MEM_SLAB_PID UINT32_MAX
+
+/**
+ * \brief Number of size classes of the slab policy: segments of 1 to MEM_SLAB_CLASSES chunks
+ */
+#define MEM_SLAB_CLASSES 8
+
+/**
+ * \brief Number of objects of a slab
+ */
+#define MEM_SLAB_OBJECTS 16
+
+/**
+ * \brief Log2 of the number of size classes every power of two is split into, by the TLSF policy
+ */
+#define MEM_TLSF_SECOND_LEVEL 4
+
+/**
+ * \brief Maximum number of free blocks of a bucket of the first fit array
+ */
+#define MEM_FIT_BUCKET 256
+
 // ================================================================================== //
 
 /**
  * \brief Global memory parameters
  */
 struct MemParameters {
-    uint32_t chunkSize;      ///< The number of bytes of the unit of allocation
-    uint32_t totalSize;      ///< The total amount of memory in bytes
-    uint32_t kernelSize;     ///< The amount of memory used by the operating system
+    MemSize chunkSize;       ///< The number of bytes of the unit of allocation
+    MemSize totalSize;       ///< The total amount of memory in bytes
+    MemSize kernelSize;      ///< The amount of memory used by the operating system
     AllocationPolicy policy; ///< The allocation policy in use
 };
 
@@ -94,12 +149,48 @@ struct MemParameters {
  */
 struct MemBlock {
     uint32_t pid;       ///< The PID of the process using the block; 0 if free
-    uint32_t size;      ///< The size in bytes of the block
+    MemSize size;       ///< The size in bytes of the block
     Address address;    ///< The start address of the block
 };
 
 // ================================================================================== //
 
+/**
+ * \brief A memory block, in chunk units
+ * \details
+ *  As every block starts and ends at a multiple of the chunk size, allocators may keep their
+ *  blocks in this compact form, of 8 bytes whatever the width of \c Address and \c MemSize,
+ *  converting them to and from \c MemBlock only when crossing the module interface.
+ *  The PID is not kept, only whether the block is occupied, so an allocator keeps the PIDs
+ *  of its occupied blocks apart, where it finds them when they are freed.
+ *  A block can take up to 2^31 - 1 chunks.
+ */
+struct MemChunkBlock {
+    uint32_t start;             ///< The start address of the block, in chunks
+    uint32_t count : 31;        ///< The size of the block, in chunks
+    uint32_t occupied : 1;      ///< 1 if the block is used by a process; 0 if free
+};
+
+static_assert(sizeof(MemChunkBlock) == 8, "a block in chunk units must take 8 bytes");
+
+/**
+ * \brief Convert a block to chunk units, given the chunk size
+ */
+inline MemChunkBlock memChunkBlock(const MemBlock &block, MemSize chunkSize)
+{
+    return { (uint32_t)(block.address / chunkSize), (uint32_t)(block.size / chunkSize), block.pid != 0 };
+}
+
+/**
+ * \brief Convert a block in chunk units to bytes, given the chunk size and the PID of the process using it
+ */
+inline MemBlock memByteBlock(const MemChunkBlock &block, MemSize chunkSize, uint32_t pid)
+{
+    return { block.occupied ? pid : 0, (MemSize)block.count * chunkSize, (Address)block.start * chunkSize };
+}
+
+// ================================================================================== //
+
 /**
  * \brief The node to support the linked lists used by the first fit algorithm
  */
@@ -135,6 +226,21 @@ struct MemTreeNode {
 
 // ================================================================================== //
 
+/**
+ * \brief External fragmentation statistics of the free memory
+ * \details
+ *   Kept up to date by the allocation and free functions,
+ *   every time a free block is created, splitted, merged or removed.
+ */
+struct MemStats {
+    uint32_t freeBlocks;        ///< The number of free blocks
+    MemSize freeBytes;          ///< The total amount of free memory, in bytes
+    MemSize largestFree;        ///< The size of the largest free block, in bytes (see \c memGetStats)
+    uint32_t histogram[8 * sizeof(MemSize)]; ///< Number of free blocks whose size has its highest bit set at the index position
+};
+
+// ================================================================================== //
+
 extern MemParameters memParameters;     ///< Global memory management parameters
 
 extern MemListNode *memFreeHead;        ///< Head of the free list for first fit algorithm
@@ -162,6 +268,10 @@ extern MemTreeNode *memTreeRoot;        ///< Root of the buddy system tree
  *    \c memOccupiedHead must be initialized properly.
  *  - If policy is \c BuddySystem, \c memFreeHead and \c memOccupiedHead must be put at NULL and
  *    \c memTreeRoot must be initialized properly.
+ *  - If policy is \c Slab, it is initialized as for \c FirstFit, with no slabs.
+ *  - If policy is \c Tlsf, all three must be put at NULL, its blocks being kept by the module itself.
+ *  - If policy is \c BuddyForest, \c memTreeRoot joins the trees of the forest, in ascending order of addresses,
+ *    by splitted nodes that are never merged; the chunk size must be a power of two.
  *  - The operating system should occupy the lower part of the available main memory.
  *  - In case of an error, an appropriate exception must be thrown.
  *  - All exceptions must be of the type defined in this project (Exception).
@@ -171,7 +281,7 @@ extern MemTreeNode *memTreeRoot;        ///< Root of the buddy system tree
  * \param [in] chunkSize The unit of allocation, in bytes
  * \param [in] policy The allocation policy to be used
  */
-void memInit(uint32_t memSize, uint32_t memSizeOS, uint32_t chunkSize, AllocationPolicy policy);
+void memInit(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy);
 
 // ================================================================================== //
 
@@ -195,7 +305,11 @@ void memTerm();
  *    while the second one corresponds to the linked list of occupied blocks.
  *  - If the active policy is buddy system allocation,
  *    the binary tree must be traversed twice, one to print the free blocks
- *    and another to print the occupied blocks.
+ *    and another to print the occupied blocks; the same applies to the buddy forest.
+ *  - If the active policy is slab allocation,
+ *    the objects of the slabs appear in place of the slabs, among the first fit blocks.
+ *  - If the active policy is two-level segregated fit allocation,
+ *    its blocks are printed as the ones of the first fit lists.
  *
  *  The following must be considered:
  *  - For the first fit policy, the linked-lists must be printed in natural order
@@ -214,8 +328,8 @@ void memPrint(FILE *fout);
 /**
  * \brief Try to allocate the address space profile of a process
  * \details
- *  This is the front end allocation function, that uses the \c memFirstFitAlloc or
- *  \c memBuddySystemAlloc, depending on the active allocation policy
+ *  This is the front end allocation function, that uses the \c memFirstFitAlloc,
+ *  \c memBuddySystemAlloc, \c memSlabAlloc or \c memTlsfAlloc, depending on the active allocation policy
  *
  *  The following must be considered:
  *  - Each segment size must be rounded up to the smallest multiple of the chunk size.
@@ -227,10 +341,11 @@ void memPrint(FILE *fout);
  *  - If the memory required to allocate the whole address space exceds the total memory for
  *    processes, IMPOSSIBLE_MAPPING should be returned.<br>
  *    Note that the memory required depends on the allocation policy:
- *    - for the \c FirstFit policy, every allocated block has a size equal to the rounded up size
+ *    - for the \c FirstFit, \c Slab and \c Tlsf policies, every allocated block has a size equal to the rounded up size
  *      of its corresponding segment;
- *    - for the \c BuddySystem policy, the allocated block may be bigger than the rounded up
- *      size, because of the division into halves.
+ *    - for the \c BuddySystem and \c BuddyForest policies, the allocated block may be bigger than the rounded up
+ *      size, because of the division into halves;
+ *      for the \c BuddyForest policy, every block must also fit in a single tree of the forest.
  *    
  * \param [in] pid PID of the process requesting memory
  * \param [in] profile Pointer to a variable containing the process' address space profile
@@ -260,7 +375,7 @@ AddressSpaceMapping *memAlloc(uint32_t pid, AddressSpaceProfile *profile);
  * \param [in] size Size of the block to be allocated, in bytes
  * \return The start address of the block allocated or \c NULL_ADDRESS if no block was found
  */
-Address memFirstFitAlloc(uint32_t pid, uint32_t size);
+Address memFirstFitAlloc(uint32_t pid, MemSize size);
 
 // ================================================================================== //
 
@@ -279,6 +394,8 @@ Address memFirstFitAlloc(uint32_t pid, uint32_t size);
  *  - The leaf-nodes, when seen from left to right, represent blocks, free or occupied,
  *    appearing in ascending order of block addresses.
  *  - The first, best fit free block, according to a left-right, depth-first search, must be used.
+ *  - For the \c BuddyForest policy, the first tree having a free block big enough is taken
+ *    from a summary of the free blocks per size and tree, and only that tree is searched.
  *  - The previous block, may have to be splitted, in acordance with the buddy system approach.
  *  - When a free block is splitted, the lower sub-block should be used for the allocation,
  *    and the upper sub-block should remain free.
@@ -289,15 +406,15 @@ Address memFirstFitAlloc(uint32_t pid, uint32_t size);
  * \param [in] size Size of the block to be allocated, in bytes
  * \return The start address of the block allocated or \c NULL_ADDRESS if no block was found
  */
-Address memBuddySystemAlloc(uint32_t pid, uint32_t size);
+Address memBuddySystemAlloc(uint32_t pid, MemSize size);
 
 // ================================================================================== //
 
 /**
  * \brief Free a previously allocated address space mapping
  * \details
- *  This is the front end free function, that uses the \c memFirstFitFree or
- *  \c memBuddySystemFree, depending on the active allocation policy,
+ *  This is the front end free function, that uses the \c memFirstFitFree,
+ *  \c memBuddySystemFree, \c memSlabFree or \c memTlsfFree, depending on the active allocation policy,
  *  to free all blocks of the given mapping.
  *
  *  The following must be considered:
@@ -342,6 +459,270 @@ void memBuddySystemFree(Address address);
 
 // ================================================================================== //
 
+/**
+ * \brief Try to allocate a block of memory of the given size, using the slab algorithm
+ * \details
+ *  This function may assume that the given size was already rounded up by the 
+ *  front end allocation function.
+ *
+ *  The following must be considered:
+ *  - A size of up to \c MEM_SLAB_CLASSES chunks is given the lowest free object of a slab of its size class
+ *    with free objects, in constant time.
+ *  - If there is no such slab, a new one, with \c MEM_SLAB_OBJECTS objects, is taken from the first fit lists,
+ *    as a block of PID \c MEM_SLAB_PID.
+ *  - Other sizes, and sizes whose slab does not fit in memory, are given a block by \c memFirstFitAlloc.
+ *  - The last empty slab of every class is kept, unless a first fit allocation fails without it.
+ *  - In case of an error, an appropriate exception must be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ *  This function has no binary version.
+ *
+ * \param [in] pid PID of the process requesting memory
+ * \param [in] size Size of the block to be allocated, in bytes
+ * \return The start address of the block allocated or \c NULL_ADDRESS if no block was found
+ */
+Address memSlabAlloc(uint32_t pid, MemSize size);
+
+// ================================================================================== //
+
+/**
+ * \brief Free a previously (slab) allocated block of memory
+ * \details
+ *
+ *  The following must be considered:
+ *  - An object is given back to its slab, in constant time; an empty slab is given back
+ *    to the first fit lists, unless it is the only empty one of its class.
+ *  - Any other block is freed by \c memFirstFitFree.
+ *  - If address is not valid, the EINVAL exceptions must be thrown.
+ *  - In case of an error, an appropriate exception must be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ *  This function has no binary version.
+ *
+ * \param [in] address Start address of the block to be freed
+ */
+void memSlabFree(Address address);
+
+// ================================================================================== //
+
+/**
+ * \brief Try to allocate a block of memory of the given size, using the two-level segregated fit algorithm
+ * \details
+ *  This function may assume that the given size was already rounded up by the 
+ *  front end allocation function.
+ *
+ *  The following must be considered:
+ *  - The size is rounded up to the lowest size class above it, and the first free block
+ *    of the smallest non empty class from there on is used, in constant time.
+ *  - Only if there is no such block, the free blocks of the size class of the given size are searched.
+ *  - When a free block is splitted, the lower sub-block should be used for the allocation,
+ *    and the upper sub-block should remain free.
+ *  - In case of an error, an appropriate exception must be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ *  This function has no binary version.
+ *
+ * \param [in] pid PID of the process requesting memory
+ * \param [in] size Size of the block to be allocated, in bytes
+ * \return The start address of the block allocated or \c NULL_ADDRESS if no block was found
+ */
+Address memTlsfAlloc(uint32_t pid, MemSize size);
+
+// ================================================================================== //
+
+/**
+ * \brief Free a previously (two-level segregated fit) allocated block of memory
+ * \details
+ *
+ *  The following must be considered:
+ *  - If the block to be freed is contiguous to an empty block, merging must take place,
+ *    in constant time.
+ *  - If address is not valid, the EINVAL exceptions must be thrown.
+ *  - In case of an error, an appropriate exception must be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ *  This function has no binary version.
+ *
+ * \param [in] address Start address of the block to be freed
+ */
+void memTlsfFree(Address address);
+
+// ================================================================================== //
+
+/**
+ * \brief Defer the merging of released blocks to a single later pass
+ * \details
+ *  While merging is deferred, the free functions only mark blocks as free,
+ *  leaving adjacent free blocks (or free buddies) unmerged.
+ *  When merging is turned on again, a single pass merges all of them,
+ *  leading to the same state as if every block had been merged when released.
+ *
+ *  The following must be considered:
+ *  - No allocation can be done while merging is deferred.
+ *  - The binary versions of the free functions ignore this setting and always merge.
+ *
+ * \param [in] defer \c true to defer merging; \c false to merge pending blocks and stop deferring
+ */
+void memDeferMerge(bool defer);
+
+// ================================================================================== //
+
+/**
+ * \brief Leave up to a number of free blocks per order unmerged by the buddy system
+ * \details
+ *  With a watermark, the buddy system free function only merges two free buddies
+ *  while there are more free blocks of their size than the watermark,
+ *  so blocks that are freed and soon allocated again are not merged and splitted every time.
+ *  The blocks left unmerged are all merged, in a single pass, when an allocation finds no
+ *  free block big enough, before trying again.
+ *
+ *  The following must be considered:
+ *  - Any blocks left unmerged are merged when the watermark is changed.
+ *  - The watermark is kept across \c memTerm and \c memInit.
+ *  - The binary versions of the buddy system functions ignore this setting and always merge.
+ *
+ *  This function has no binary version.
+ *
+ * \param [in] watermark Number of free blocks per order left unmerged; 0 to merge eagerly (default)
+ */
+void memLazyMerge(uint32_t watermark);
+
+// ================================================================================== //
+
+/**
+ * \brief Keep a bitmap of the occupied chunks
+ * \details
+ *  While enabled, a bit per chunk of the memory for processes tells whether it belongs to an occupied block,
+ *  updated by the allocation and free functions of every policy.
+ *  Unless \c memFirstFitArray is enabled, the first fit allocation function then finds the first run
+ *  of free chunks big enough in the bitmap, a word of 64 chunks at a time, instead of walking the free list,
+ *  and takes the node of the free block starting there from the first fit arrays, which are kept
+ *  while the bitmap is enabled, by binary search.
+ *  Also, \c memBitmapCheck can validate the blocks of any policy against it.
+ *
+ *  The following must be considered:
+ *  - The bitmap is built from the current blocks when enabled, and again by \c memInit and \c memCompact.
+ *  - The setting is kept across \c memTerm and \c memInit.
+ *  - Slab objects are not tracked, a slab being a single occupied block.
+ *  - For the buddy system policies, the chunk size must be a power of two.
+ *  - While merging is deferred, the first fit allocation function walks the free list, as usual.
+ *  - The binary versions of the allocation and free functions do not update the bitmap.
+ *
+ *  This function has no binary version.
+ *
+ * \param [in] enable \c true to keep the bitmap; \c false to drop it (default)
+ */
+void memShadowBitmap(bool enable);
+
+// ================================================================================== //
+
+/**
+ * \brief Check that the blocks of the active policy agree with the shadow bitmap
+ * \details
+ *  Every free block must have all its chunks clear in the bitmap, every occupied block all of them set,
+ *  and no other chunk may be set, so a block lost, duplicated or overlapping another one is detected.
+ *  Meant as an invariant check in stress runs.
+ *
+ *  The following must be considered:
+ *  - The shadow bitmap must be enabled.
+ *
+ *  This function has no binary version.
+ *
+ * \return \c true if the blocks and the bitmap agree
+ */
+bool memBitmapCheck();
+
+// ================================================================================== //
+
+/**
+ * \brief Mirror the first fit lists in sorted arrays, the free sizes scanned with vector compares
+ * \details
+ *  While enabled, the free and the occupied blocks are also kept, in ascending order of addresses,
+ *  in parallel arrays of addresses, sizes (both in chunks) and list nodes,
+ *  split in buckets of up to \c MEM_FIT_BUCKET blocks, along with the largest size of every bucket.
+ *  The first fit allocation function then scans the largest sizes, and the sizes of the bucket found,
+ *  several sizes per vector compare, instead of walking the free list,
+ *  and the places of the blocks in both lists are found by binary search, instead of walking them.
+ *  Inserting or removing a block only moves the blocks after it in its bucket.
+ *
+ *  The following must be considered:
+ *  - The arrays are built from the lists when enabled, and again by \c memInit and \c memCompact.
+ *  - The setting is kept across \c memTerm and \c memInit.
+ *  - The blocks chosen are the same as the ones found walking the free list, deferred merging included.
+ *  - The binary versions of the first fit functions do not update the arrays, so they must not be mixed with them.
+ *
+ *  This function has no binary version.
+ *
+ * \param [in] enable \c true to keep the arrays; \c false to drop them (default)
+ */
+void memFirstFitArray(bool enable);
+
+// ================================================================================== //
+
+/**
+ * \brief Find the first run of free chunks of the given size in the shadow bitmap
+ * \details
+ *  The bitmap is searched a word of 64 chunks at a time, fully occupied words being skipped
+ *  4 at a time if AVX2 is available; a run within a word is found with shifts and ands.
+ *  With all free blocks merged, the run found starts at the first fit for the given size.
+ *
+ *  The following must be considered:
+ *  - The shadow bitmap must be enabled.
+ *  - The size is rounded up to the chunk size.
+ *
+ *  This function has no binary version.
+ *
+ * \param [in] size The size of the run, in bytes
+ * \return The address of the first chunk of the run, or \c NULL_ADDRESS if there is none
+ */
+Address memBitmapFind(MemSize size);
+
+// ================================================================================== //
+
+/**
+ * \brief Get the external fragmentation statistics of the free memory
+ * \details
+ *  The statistics are maintained incrementally, on every split and merge of a free block,
+ *  so this function never walks the free list or the binary tree.
+ *
+ *  The following must be considered:
+ *  - The statistics are only kept by the group versions of the init, allocation and free functions.
+ *  - While merging is deferred, every unmerged free block counts as a separate block.
+ *  - The largest free block is exact if it is the only one of its power of two,
+ *    or if the free blocks of its power of two are all powers of two, as with the buddy policies;
+ *    otherwise, it is an upper bound, below the next power of two.
+ *  - In case of an error, an appropriate exception must be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ * \param [out] stats Pointer to the variable where the statistics must be copied to
+ */
+void memGetStats(MemStats *stats);
+
+// ================================================================================== //
+
+/**
+ * \brief Slide the occupied blocks down, joining all the free memory in a single block
+ * \details
+ *  Occupied blocks are moved, in the order of the occupied list, to the lowest address
+ *  available above the previous one, so the free memory ends up as a single block
+ *  at the top of memory.
+ *  The blocks that were moved are returned in a relocation table,
+ *  which should be used to update the address space mappings of their processes.
+ *
+ *  The following must be considered:
+ *  - Compaction only applies to the \c FirstFit policy.
+ *  - No compaction can be done while merging is deferred.
+ *  - The statistics returned by \c memGetStats are reset to the single free block.
+ *  - The table is grown to the number of occupied blocks, and released by \c memTerm.
+ *  - In case of an error, an appropriate exception must be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ * \return a pointer to a static table with the blocks that were moved
+ */
+RelocationTable *memCompact();
+
+// ================================================================================== //
+
 /** @} */
 
 #endif /* __SOMM23_MEM__ */
@@ -0,0 +1,229 @@
+/**
+ * \anchor metrics
+ *
+ * \defgroup metrics Metrics
+ * \details This toolkit keeps aggregate results of a simulation, updated as events are processed
+ *
+ * This toolkit is fed by the simulation, every time a process changes state, and keeps:
+ * - the number of processes that arrived, were swapped, discarded, activated and finished;
+ * - the waiting time (activation time minus arrival time) of the activated processes;
+ * - the turnaround time (finish time minus arrival time) of the finished processes;
+ * - the memory utilization and the length of the swap queue, integrated over time;
+ * - the number of memory compactions, with the memory moved and the time charged for them;
+ * - the throughput, in finished processes per 1000 time units.
+ *
+ * Every update takes constant time, and no per-process history is kept:
+ * times are accumulated in log-linear histograms, with 16 linear sub-buckets per power of two,
+ * from which percentiles are estimated with a relative error below 1/16.
+ * Thus, the summary is available at \c simTerm without going through the process control table.
+ *
+ *   The interface of this module is predefined, being composed of the following functions:
+ *   <table>
+ *   <tr> <th> \c function <th>role
+ *   <tr> <td> \c soMetricsOpen <td> Set the report stream
+ *   <tr> <td> \c soMetricsClose <td> Close the report stream
+ *   <tr> <td> \c soMetricsReset <td> Clear all metrics, given the memory available for processes
+ *   <tr> <td> \c soMetricsArrival <td> Record the arrival of a process
+ *   <tr> <td> \c soMetricsSwap <td> Record a process put in the swap queue
+ *   <tr> <td> \c soMetricsDiscard <td> Record a discarded process
+ *   <tr> <td> \c soMetricsActivate <td> Record the activation of a process
+ *   <tr> <td> \c soMetricsFinish <td> Record the end of a process
+ *   <tr> <td> \c soMetricsCompact <td> Record a memory compaction
+ *   <tr> <td> \c soMetricsGet <td> Get the current metrics
+ *   <tr> <td> \c soMetricsSet <td> Replace the current metrics
+ *   <tr> <td> \c soMetricsPercentile <td> Estimate a percentile from a histogram
+ *   <tr> <td> \c soMetricsPrint <td> Print the summary to the given stream
+ *   <tr> <td> \c soMetricsReport <td> Print the summary to the report stream, if one is set
+ *   </table>
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#ifndef __SOMM23_METRICS__
+#define __SOMM23_METRICS__
+
+#include <stdio.h>
+#include <stdint.h>
+
+/** @{ */
+
+/* *************************************** */
+
+/**
+ * \brief Number of buckets of the metrics histograms
+ * \details Values below 32 have a bucket of their own;
+ *   above that, every power of two, up to 2^63, is split in 16 linear sub-buckets.
+ */
+#define SOMETRICS_BUCKETS 976
+
+/* *************************************** */
+
+/**
+ * \brief Log-linear histogram of time values
+ */
+struct SoMetricsHistogram {
+    uint64_t count;                         ///< Number of values recorded
+    uint64_t sum;                           ///< Sum of the values recorded
+    uint64_t min;                           ///< Smallest value recorded
+    uint64_t max;                           ///< Largest value recorded
+    uint32_t bucket[SOMETRICS_BUCKETS];     ///< Number of values per bucket
+};
+
+/* *************************************** */
+
+/**
+ * \brief Aggregate results of a simulation
+ */
+struct SoMetrics {
+    uint64_t memCapacity;           ///< Memory available for processes, in bytes
+    uint64_t startTime;             ///< Time of the first arrival
+    uint64_t lastTime;              ///< Time of the last event recorded
+    uint32_t arrived;               ///< Number of processes that arrived
+    uint32_t swapped;               ///< Number of processes put in the swap queue
+    uint32_t discarded;             ///< Number of processes discarded
+    uint32_t activated;             ///< Number of processes activated
+    uint32_t finished;              ///< Number of processes finished
+    uint64_t memUsed;               ///< Memory currently in use by processes, in bytes
+    uint64_t memPeak;               ///< Largest amount of memory used by processes, in bytes
+    uint32_t swapLength;            ///< Current length of the swap queue
+    uint32_t swapPeak;              ///< Largest length of the swap queue
+    uint64_t memIntegral;           ///< Memory in use integrated over time, in bytes times time units
+    uint64_t swapIntegral;          ///< Swap queue length integrated over time
+    uint32_t compactions;           ///< Number of memory compactions
+    uint64_t relocatedBytes;        ///< Memory moved by compactions, in bytes
+    uint64_t compactionTime;        ///< Time charged for compactions
+    SoMetricsHistogram waiting;     ///< Waiting times of the activated processes
+    SoMetricsHistogram turnaround;  ///< Turnaround times of the finished processes
+};
+
+/* *************************************** */
+
+/**
+ *  \brief Set the stream where \c soMetricsReport sends the summary.
+ *  \details Metrics are always kept; the stream only decides whether the summary is printed.
+ *  \param [in] fp the report stream (may be NULL)
+ */
+void soMetricsOpen(FILE *fp);
+
+/* *************************************** */
+
+/**
+ *  \brief Close the report stream, unless it is \c stdout or \c stderr.
+ */
+void soMetricsClose(void);
+
+/* *************************************** */
+
+/**
+ *  \brief Clear all metrics.
+ *  \param [in] memCapacity the memory available for processes, in bytes
+ */
+void soMetricsReset(uint64_t memCapacity);
+
+/* *************************************** */
+
+/**
+ *  \brief Record the arrival of a process.
+ *  \param [in] time the current simulation time
+ */
+void soMetricsArrival(uint64_t time);
+
+/* *************************************** */
+
+/**
+ *  \brief Record that an arrived process was put in the swap queue.
+ *  \param [in] time the current simulation time
+ */
+void soMetricsSwap(uint64_t time);
+
+/* *************************************** */
+
+/**
+ *  \brief Record that a process was discarded.
+ *  \param [in] time the current simulation time
+ *  \param [in] fromSwap \c true if the process leaves the swap queue
+ */
+void soMetricsDiscard(uint64_t time, bool fromSwap);
+
+/* *************************************** */
+
+/**
+ *  \brief Record the activation of a process.
+ *  \param [in] time the time the process becomes active,
+ *         later than the current one if the memory had to be compacted first
+ *  \param [in] arrivalTime the arrival time of the process
+ *  \param [in] memSize the memory assigned to the process, in bytes
+ *  \param [in] fromSwap \c true if the process leaves the swap queue
+ */
+void soMetricsActivate(uint64_t time, uint64_t arrivalTime, uint64_t memSize, bool fromSwap);
+
+/* *************************************** */
+
+/**
+ *  \brief Record the end of a process.
+ *  \param [in] time the current simulation time
+ *  \param [in] arrivalTime the arrival time of the process
+ *  \param [in] memSize the memory released by the process, in bytes
+ */
+void soMetricsFinish(uint64_t time, uint64_t arrivalTime, uint64_t memSize);
+
+/* *************************************** */
+
+/**
+ *  \brief Record a memory compaction.
+ *  \param [in] time the current simulation time
+ *  \param [in] bytes the memory moved, in bytes
+ *  \param [in] cost the time charged for the compaction
+ */
+void soMetricsCompact(uint64_t time, uint64_t bytes, uint64_t cost);
+
+/* *************************************** */
+
+/**
+ *  \brief Get the current metrics.
+ *  \param [out] metrics where to put a copy of the metrics
+ */
+void soMetricsGet(SoMetrics *metrics);
+
+/* *************************************** */
+
+/**
+ *  \brief Replace the current metrics.
+ *  \details Used to bring back the metrics of a snapshot of the simulation.
+ *  \param [in] metrics the metrics to take
+ */
+void soMetricsSet(const SoMetrics *metrics);
+
+/* *************************************** */
+
+/**
+ *  \brief Estimate a percentile from a histogram.
+ *  \details The value returned is the middle of the bucket where the percentile falls in,
+ *    clipped to the range of values recorded.
+ *  \param [in] hist the histogram
+ *  \param [in] p the percentile, in the range [0, 1]
+ *  \return the estimated percentile, 0 if the histogram is empty
+ */
+uint64_t soMetricsPercentile(const SoMetricsHistogram &hist, double p);
+
+/* *************************************** */
+
+/**
+ *  \brief Print the summary of the current metrics.
+ *  \param [in] fout the stream where to send output
+ */
+void soMetricsPrint(FILE *fout);
+
+/* *************************************** */
+
+/**
+ *  \brief Print the summary to the report stream.
+ *  \details Nothing is done if no report stream was given.
+ */
+void soMetricsReport(void);
+
+/* *************************************** */
+
+/** @} */
+
+#endif /* __SOMM23_METRICS__ */
@@ -28,6 +28,14 @@
  *   Apart from a \c next pointer, every node contains a process control block (PCB), 
  *   that was already defined above.
  *   The list should be kept sorted in ascending order of the PID.
+ *
+ *   The group version stores the table as a structure of arrays instead (\c pctTable),
+ *   with one dense column per field, so scans over pids, states or times do not bring the
+ *   address space profiles and mappings into the cache.
+ *   Rows are appended in the order processes are inserted, a process is found through a hash index
+ *   of the PIDs, and the rows are only sorted by PID when printed.
+ *   As the binary version uses the list, the group and binary versions of the PCT functions
+ *   can not be mixed in a simulation.
  *   
  *   The following table presents a list of the functions in this module, including:
  *   - the function name;
@@ -45,8 +53,13 @@
  *   <tr><td>\c pctGetAddressSpaceMapping() <td align="center"> 307 <td> 1 (very low) <td> Return the list of memory blocks where the process was allocated 
  *   <tr><td>\c pctGetStateAsString() <td align="center"> 308 <td> 1 (very low) <td> Return the state as a string. given the state
  *   <tr><td>\c pctUpdateState() <td align="center"> 309 <td> 3 (low medium) <td> Sets the state of a process
+ *   <tr><td>\c pctRelocate() <td align="center"> 310 <td> 4 (medium) <td> Updates the address space mappings of the processes whose blocks were moved
+ *   <tr><td>\c pctCountInState() <td align="center"> 311 <td> 1 (very low) <td> Return the number of processes in a given state
+ *   <tr><td>\c pctGetPidsInState() <td align="center"> 312 <td> 2 (low) <td> Return the PIDs of the processes in a given state
  *   </table>
  *
+ *  Functions \c pctRelocate, \c pctCountInState and \c pctGetPidsInState have no binary version.
+ *
  *  \author Artur Pereira - 2023
  */
 
@@ -68,10 +81,10 @@
 struct PctBlock {
     uint32_t pid;                       ///< PID of a process
     ProcessState state;                 ///< The state it is at a given moment
-    uint32_t arrivalTime;               ///< The time of its arrival to the system
-    uint32_t lifetime;                  ///< The amount of time it needs to be in memory for execution
-    uint32_t activationTime;             ///< The time its address space was stored in main memory
-    uint32_t finishTime;                ///< The time of its termination
+    SimTime arrivalTime;                ///< The time of its arrival to the system
+    SimTime lifetime;                   ///< The amount of time it needs to be in memory for execution
+    SimTime activationTime;             ///< The time its address space was stored in main memory
+    SimTime finishTime;                 ///< The time of its termination
     AddressSpaceProfile memProfile;     ///< Its address space profile
     AddressSpaceMapping memMapping;     ///< Its address space mapping
 };
@@ -92,6 +105,48 @@ extern PctNode *pctHead;    ///< Pointer to head of list
 
 // ================================================================================== //
 
+/**
+ * \brief Number of possible process states
+ */
+#define PCT_STATES (DISCARDED + 1)
+
+/**
+ * \brief Indication of no row, used to terminate the per-state lists
+ */
+#define PCT_NO_ROW UINT32_MAX
+
+/**
+ * \brief The Process Control Table, as a structure of arrays
+ * \details
+ *   Row \c i of every column belongs to the same process; rows are appended in the order processes are inserted,
+ *   and never move.
+ *   The columns are allocated with room for \c capacity rows, which is doubled when full,
+ *   so pointers into them are only valid until the next insertion.
+ *   Every row is also linked, through \c stateNext and \c statePrev, in the doubly linked list of the processes
+ *   in its state, so processes in a state are counted in constant time and listed without visiting the others.
+ */
+struct PctTable {
+    uint32_t count;                     ///< Number of processes in the table
+    uint32_t capacity;                  ///< Number of rows allocated in every column
+    uint32_t *pid;                      ///< PIDs of the processes
+    ProcessState *state;                ///< Their states
+    SimTime *arrivalTime;               ///< Their arrival times
+    SimTime *lifetime;                  ///< Their lifetimes
+    SimTime *activationTime;            ///< Their activation times
+    SimTime *finishTime;                ///< Their termination times
+    AddressSpaceProfile *memProfile;    ///< Their address space profiles
+    AddressSpaceMapping *memMapping;    ///< Their address space mappings
+    uint32_t *stateNext;                ///< Next row in the same state, or \c PCT_NO_ROW
+    uint32_t *statePrev;                ///< Previous row in the same state, or \c PCT_NO_ROW
+    uint32_t stateHead[PCT_STATES];     ///< First row in every state, or \c PCT_NO_ROW
+    uint32_t stateTail[PCT_STATES];     ///< Last row in every state, or \c PCT_NO_ROW
+    uint32_t stateCount[PCT_STATES];    ///< Number of rows in every state
+};
+
+extern PctTable pctTable;   ///< The table used by the group version
+
+// ================================================================================== //
+
 /**
  * \brief Initializes the internal data structure of the PCT module
  * \details
@@ -152,7 +207,7 @@ void pctPrint(FILE *fout);
  * \param [in] lifetime Time the process takes to run, after it is in main memory
  * \param [in] memProfile Process' address space profile
  */
-void pctInsert(uint32_t pid, uint32_t time, uint32_t lifetime, AddressSpaceProfile *memProfile);
+void pctInsert(uint32_t pid, SimTime time, SimTime lifetime, AddressSpaceProfile *memProfile);
 
 // ================================================================================== //
 
@@ -166,7 +221,7 @@ void pctInsert(uint32_t pid, uint32_t time, uint32_t lifetime, AddressSpaceProfi
  * \param [in] pid PID of the process
  * \return the process' lifetime
  */
-uint32_t pctGetLifetime(uint32_t pid);
+SimTime pctGetLifetime(uint32_t pid);
 
 // ================================================================================== //
 
@@ -231,7 +286,60 @@ const char *pctGetStateAsString(uint32_t pid);
  * \param [in] time The time associated to the change of state
  * \param [in] mapping Pointer to the mappinf, if state is ACTIVE
  */
-void pctUpdateState(uint32_t pid, ProcessState state, uint32_t time = NO_TIME, AddressSpaceMapping *mapping = NULL);
+void pctUpdateState(uint32_t pid, ProcessState state, SimTime time = NO_TIME, AddressSpaceMapping *mapping = NULL);
+
+// ================================================================================== //
+
+/**
+ * \brief Update the address space mappings of the processes whose blocks were moved
+ * \details
+ *   Every entry of the given table replaces the \c from address by the \c to address
+ *   in the mapping of the process it refers to.
+ *   The entries of the given table are sorted by PID and address, so the list of the binary version
+ *   is walked only once, and the blocks of a process are replaced from the lowest address up.
+ *
+ *   The following must be considered:
+ *   - The \c EINVAL exception should be thrown, if an entry for a given pid does not exist,
+ *     or its mapping does not contain the given \c from address.
+ *   - All exceptions must be of the type defined in this project (Exception).
+ *  
+ * \param [in,out] table Pointer to the table of moved blocks, as returned by \c memCompact
+ */
+void pctRelocate(RelocationTable *table);
+
+// ================================================================================== //
+
+/**
+ * \brief Return the number of processes in the given state
+ * \details
+ *   The count is kept up to date by \c pctInsert and \c pctUpdateState, so no entry is visited.
+ *
+ *   The following must be considered:
+ *   - The \c EINVAL exception should be thrown, if the state is not valid.
+ *   - All exceptions must be of the type defined in this project (Exception).
+ *  
+ * \param [in] state The state of interest
+ * \return The number of processes in the given state
+ */
+uint32_t pctCountInState(ProcessState state);
+
+// ================================================================================== //
+
+/**
+ * \brief Return the PIDs of the processes in the given state
+ * \details
+ *   Only the processes in the given state are visited, in the order they entered it.
+ *
+ *   The following must be considered:
+ *   - The \c EINVAL exception should be thrown, if the state is not valid.
+ *   - All exceptions must be of the type defined in this project (Exception).
+ *  
+ * \param [in] state The state of interest
+ * \param [out] pids Array where the PIDs are stored
+ * \param [in] max Number of entries of \c pids
+ * \return The number of processes in the given state, which may be greater than \c max
+ */
+uint32_t pctGetPidsInState(ProcessState state, uint32_t *pids, uint32_t max);
 
 // ================================================================================== //
 
@@ -0,0 +1,197 @@
+/**
+ * \anchor profiling
+ *
+ * \defgroup profiling Profiling
+ * \details This toolkit keeps per-function call counters and latency histograms
+ *
+ * This toolkit provides a lightweight instrumentation system which allows:
+ * - to count the calls made to every function, using the same IDs as the probing system;
+ * - to accumulate the time spent in every function, in nanoseconds;
+ * - to keep a log-bucketed latency histogram per function,
+ *   where bucket \c b counts calls that took between 2<sup>b</sup> and 2<sup>b+1</sup> ns;
+ * - to print a summary table of all the functions called, on demand or at \c simTerm.
+ *
+ * Counters are kept in thread-local tables, so recording a call never takes a lock.
+ * The tables of all threads are merged when the summary is requested.
+ * The counters are relaxed atomics, so the summary can be requested while other threads record,
+ * each counter being exact but the counters of a function not being taken at the same instant;
+ * the summary is exact once the recording threads have finished.
+ * Timings are inclusive: the time of a function includes the time of the functions it calls.
+ *
+ *   The interface of this module is predefined, being composed of the following functions:
+ *   <table>
+ *   <tr> <th> \c function <th>role
+ *   <tr> <td> \c soProfileOpen <td> Turn profiling on and set the report stream
+ *   <tr> <td> \c soProfileClose <td> Turn profiling off and close the report stream
+ *   <tr> <td> \c soProfileReset <td> Clear all counters
+ *   <tr> <td> \c soProfileRecord <td> Record a call to a function
+ *   <tr> <td> \c soProfileGet <td> Get the merged counters of a function
+ *   <tr> <td> \c soProfilePercentile <td> Estimate a latency percentile of a function
+ *   <tr> <td> \c soProfilePrint <td> Print the summary table to the given stream
+ *   <tr> <td> \c soProfileReport <td> Print the summary table to the report stream, if profiling is on
+ *   </table>
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#ifndef __SOMM23_PROFILING__
+#define __SOMM23_PROFILING__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+/** @{ */
+
+/* *************************************** */
+
+/**
+ * \brief Number of buckets of the latency histograms
+ * \details The last bucket also counts all calls longer than its lower bound
+ */
+#define SOPROFILE_BUCKETS 32
+
+/* *************************************** */
+
+/**
+ * \brief Counters kept for a single function
+ */
+struct SoProfileStats {
+    const char *name;                   ///< Name of the function, NULL if never called
+    uint64_t calls;                     ///< Number of calls
+    uint64_t nanos;                     ///< Accumulated time, in nanoseconds
+    uint64_t maxNanos;                  ///< Longest call, in nanoseconds
+    uint32_t hist[SOPROFILE_BUCKETS];   ///< Log-bucketed latency histogram
+};
+
+/* *************************************** */
+
+extern bool soProfileActive;    ///< \c true if profiling is on
+
+/* *************************************** */
+
+/**
+ *  \brief Turn profiling on.
+ *  \details Counters are not cleared, so profiling can be suspended and resumed.
+ *  \param [in] fp the stream where \c soProfileReport sends the summary (may be NULL)
+ */
+void soProfileOpen(FILE *fp);
+
+/* *************************************** */
+
+/**
+ *  \brief Turn profiling off.
+ *  \details The report stream is closed, unless it is \c stdout or \c stderr.
+ */
+void soProfileClose(void);
+
+/* *************************************** */
+
+/**
+ *  \brief Clear the counters of all threads.
+ *  \details It should be called when no other thread is recording.
+ */
+void soProfileReset(void);
+
+/* *************************************** */
+
+/**
+ *  \brief Record a call to a function, in the table of the calling thread.
+ *  \param [in] id the probing ID of the function
+ *  \param [in] name the name of the function
+ *  \param [in] nanos the duration of the call, in nanoseconds
+ */
+void soProfileRecord(uint32_t id, const char *name, uint64_t nanos);
+
+/* *************************************** */
+
+/**
+ *  \brief Get the counters of a function, merged over all threads.
+ *  \details The counters of the threads still recording are read as they are at the time of the call.
+ *  \param [in] id the probing ID of the function
+ *  \param [out] stats where to put the merged counters
+ *  \return \c true if the function was called at least once; \c false otherwise
+ */
+bool soProfileGet(uint32_t id, SoProfileStats *stats);
+
+/* *************************************** */
+
+/**
+ *  \brief Estimate a latency percentile from the histogram of a function.
+ *  \details The value returned is the upper bound of the bucket where the percentile falls in,
+ *    clipped to the longest call.
+ *  \param [in] stats the counters of the function
+ *  \param [in] p the percentile, in the range [0, 1]
+ *  \return the estimated percentile, in nanoseconds
+ */
+uint64_t soProfilePercentile(const SoProfileStats &stats, double p);
+
+/* *************************************** */
+
+/**
+ *  \brief Print the summary table, merged over all threads.
+ *  \details Only the functions called at least once appear in the table, in ascending order of ID.
+ *    The percentiles are upper bounds, given by the histogram bucket where they fall in.
+ *  \param [in] fout the stream where to send output
+ */
+void soProfilePrint(FILE *fout);
+
+/* *************************************** */
+
+/**
+ *  \brief Print the summary table to the report stream.
+ *  \details Nothing is done if profiling is off or no report stream was given.
+ */
+void soProfileReport(void);
+
+/* *************************************** */
+
+/**
+ *  \brief Current time of the monotonic clock, in nanoseconds
+ */
+inline uint64_t soProfileNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* *************************************** */
+
+/**
+ *  \brief Scope guard that records the duration of the enclosing block.
+ *  \details If profiling is off when the block is entered, the block is not recorded.
+ */
+class SoProfileScope
+{
+  public:
+    /**
+     * \brief the constructor
+     * \param _id the probing ID of the function
+     * \param _name the name of the function
+     */
+    SoProfileScope(uint32_t _id, const char *_name)
+        : id(_id), name(_name), start(soProfileActive ? soProfileNow() : 0)
+    {
+    }
+
+    /**
+     * \brief the destructor, where the call is recorded
+     */
+    ~SoProfileScope()
+    {
+        if (start != 0)
+            soProfileRecord(id, name, soProfileNow() - start);
+    }
+
+  private:
+    uint32_t id;            ///< probing ID of the function
+    const char *name;       ///< name of the function
+    uint64_t start;         ///< start time, 0 if not recording
+};
+
+/* *************************************** */
+
+/** @} */
+
+#endif /* __SOMM23_PROFILING__ */
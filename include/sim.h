@@ -29,8 +29,17 @@
  *   <tr> <td> \c simGetProcess() <td align="center"> 106 <td> 2 (low) <td> Get the data of a forthcoming process
  *   <tr> <td> \c simStep() <td align="center"> 107 <td> 6 (high) <td> Run the simulation for one step, if possible
  *   <tr> <td> \c simRun() <td align="center"> 108 <td> 2 (low) <td> Run the simulation for a given number of steps
+ *   <tr> <td> \c simCheckpoint() <td align="center"> 109 <td> 4 (medium) <td> Saves the state of all modules to a snapshot file
+ *   <tr> <td> \c simRestore() <td align="center"> 110 <td> 4 (medium) <td> Restores the state of all modules from a snapshot file
+ *   <tr> <td> \c simFork() <td align="center"> 111 <td> 3 (medium low) <td> Clones the running simulation into an independent branch, with the given memory
+ *   <tr> <td> \c simJoin() <td align="center"> 112 <td> 2 (low) <td> Waits for a branch to finish, and gets its metrics
+ *   <tr> <td> \c simStepTime() <td align="center"> 113 <td> 6 (high) <td> Run the simulation for all the events of the next time stamp
+ *   <tr> <td> \c simSetCompaction() <td align="center"> 114 <td> 2 (low) <td> Turns on or off memory compaction, and sets its cost
  *   </table>
  *
+ *  Functions \c simCheckpoint, \c simRestore, \c simFork, \c simJoin, \c simStepTime and \c simSetCompaction
+ *  have no binary version.
+ *
  *  \author Artur Pereira - 2023
  */
 
@@ -40,6 +49,7 @@
 #include "tme.h"
 
 #include <stdint.h>
+#include <sys/types.h>
 
 /** @{ */
 
@@ -50,8 +60,8 @@
  */
 struct ForthcomingProcess {
     uint32_t pid;                       ///< PID of a process
-    uint32_t arrivalTime;               ///< The process' arrival time
-    uint32_t lifetime;                  ///< The process' lifetime
+    SimTime arrivalTime;                ///< The process' arrival time
+    SimTime lifetime;                   ///< The process' lifetime
     AddressSpaceProfile addressSpace;   ///< The process' address space profile
 };
 
@@ -71,7 +81,7 @@ struct ForthcomingTable {
  * \brief The set of supporting variables are NOT changeable
  */
 extern uint32_t stepCount;                  ///< The current number of simulation steps
-extern uint32_t simTime;                    ///< The current simulation time
+extern SimTime simTime;                     ///< The current simulation time
 extern ForthcomingTable forthcomingTable;   ///< The set of processes to be simulated
 
 // ================================================================================== //
@@ -88,7 +98,7 @@ extern ForthcomingTable forthcomingTable;   ///< The set of processes to be simu
  * \param [in] chunkSize The unit of allocation, in bytes
  * \param [in] policy The allocation policy to be used
  */
-void simInit(uint32_t memSize, uint32_t memSizeOS, uint32_t chunkSize, AllocationPolicy policy);
+void simInit(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy);
 
 // ================================================================================== //
 
@@ -121,6 +131,8 @@ void simTerm();
  *  - PIDs should be different 
  *  - Arrival times should appear in ascending order
  *  - Lifetimes must be greater then zero
+ *  - Times must fit into a SimTime, and so must the end of every lifetime,
+ *    and segment sizes must fit into a MemSize
  *  - For every process added to the forthcoming table, 
  *    a corresponding ARRIVAL event should added to the future event queue
  *  - In case of an error, an appropriate exception must be thrown
@@ -232,6 +244,145 @@ void simRun(uint32_t cnt);
 
 // ================================================================================== //
 
+/**
+ * \brief Process all the events of the next time stamp in a single batch
+ * \details
+ *  All the events with the time of the first one in the future event queue are processed,
+ *  leading to the same state \c simStep would reach, if called once for every one of them.
+ *  The step count is incremented by the number of events processed.
+ *
+ *  The difference lays in the TERMINATE events, that are processed as follows:
+ *  - Memory released by all of them is only merged once, using \c memDeferMerge,
+ *    except for TLSF and a lazy buddy system, whose final state depends on the order of the releases.
+ *  - The pass over the SWP queue, trying to activate swapped processes, is skipped whenever
+ *    the whole free memory is smaller than the memory needed by every swapped process,
+ *    as it can not activate any of them; only for first fit and a buddy system that is not lazy,
+ *    as, in the others, failed allocations change the memory.
+ *  - Then, the ARRIVAL events of the same time stamp are processed, as in \c simStep.
+ *
+ *  \return \c true if some events were processed; \c false otherwise
+ */
+bool simStepTime();
+
+// ================================================================================== //
+
+/**
+ * \brief Save the state of the whole simulation to a snapshot file
+ * \details
+ *  The forthcoming table, the step count, the simulation time and the supporting data structures
+ *  of modules \c pct, \c feq, \c swp and \c mem are written to the given file,
+ *  together with the settings that change how the simulation goes on
+ *  (lazy and deferred merging of the memory, compaction) and the metrics gathered so far.
+ *
+ *  The following must be considered:
+ *  - Linked lists and trees are stored as arrays, in traversal order,
+ *    with pointers encoded as indices, so a snapshot does not depend on node addresses.
+ *  - Every array is written with a single write operation.
+ *  - If it is a system error, the \c errno error number should be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ * \param [in] fname Path to the snapshot file
+ */
+void simCheckpoint(const char *fname);
+
+// ================================================================================== //
+
+/**
+ * \brief Replace the state of the whole simulation by the one saved in a snapshot file
+ * \details
+ *  The snapshot must have been produced by \c simCheckpoint, in a build with the same data types.
+ *  The current state is only released after the whole snapshot was successfully read,
+ *  calling the termination functions of the other modules.
+ *
+ *  The following must be considered:
+ *  - If it is a system error, the \c errno error number should be thrown.
+ *  - If the file is not a valid snapshot, an appropriate error message should be printed
+ *    to the <i>standard error</i> and the \c EINVAL error number should be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ * \param [in] fname Path to the snapshot file
+ */
+void simRestore(const char *fname);
+
+// ================================================================================== //
+
+/**
+ * \brief Clone the running simulation into an independent branch, with the given memory
+ * \details
+ *  The branch is a child process, created by \c fork, so the whole state of all modules is
+ *  shared copy-on-write: cloning costs nothing upfront, and only the pages a branch changes
+ *  are actually copied.
+ *  Both branches continue from the point of the call, independently and in parallel,
+ *  in the same way as with \c fork.
+ *  Buffered output is flushed before cloning, so it is not written twice.
+ *
+ *  In the new branch, unless the given memory is the one in use, the memory module is
+ *  initialized with the given parameters, as in \c simInit, and the active processes are
+ *  mapped into it again, in the order they became active, and their mappings updated in the PCT;
+ *  then, the swapped processes that fit are activated, as when a process terminates,
+ *  and those that can never fit into the new memory are discarded.
+ *  So, a branch answers what would have happened from this point on with other memory.
+ *
+ *  The metrics of the branch, at the time it exits, are passed to \c simJoin in the calling branch.
+ *
+ *  The following must be considered:
+ *  - A branch must end by calling \c exit, or returning from \c main, for its metrics to be sent.
+ *  - An active process that does not fit into the new memory is swapped, as on arrival,
+ *    or discarded, if it can never fit, and its pending termination is dropped.
+ *  - If it is a system error, the \c errno error number should be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ * \param [in] memSize Total amount of memory of the branch, in bytes
+ * \param [in] memSizeOS Amount of memory used by the operating system, in bytes
+ * \param [in] chunkSize The unit of allocation, in bytes
+ * \param [in] policy The allocation policy of the branch
+ *  \return 0 in the new branch; the PID of the new branch in the calling one
+ */
+pid_t simFork(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy);
+
+// ================================================================================== //
+
+/**
+ * \brief Wait for a branch created by \c simFork to finish, and get its metrics
+ *
+ *  The following must be considered:
+ *  - If the branch ended without sending its metrics, they are all zero.
+ *  - The \c EINVAL exception should be thrown, if \c pid is not a branch created by \c simFork
+ *    in the calling branch, or it was already joined.
+ *  - If it is a system error, the \c errno error number should be thrown.
+ *  - All exceptions must be of the type defined in this project (Exception).
+ *
+ * \param [in] pid The PID of the branch, as returned by \c simFork
+ * \param [out] metrics Where to put the metrics of the branch (may be NULL)
+ * \return the exit status of the branch, or 128 plus the signal number if it was killed
+ */
+int simJoin(pid_t pid, SoMetrics *metrics);
+
+// ================================================================================== //
+
+/**
+ * \brief Turn on or off memory compaction, and set its cost
+ * \details
+ *  With compaction on, a process whose address space can not be mapped,
+ *  although the whole free memory is enough for it, is not swapped:
+ *  the memory is compacted (see \c memCompact), the mappings of the processes
+ *  whose blocks were moved are updated (see \c pctRelocate) and the process is activated.
+ *  Moving memory takes time, which is charged to the activated process:
+ *  it becomes active, and thus terminates, that amount of time later.
+ *
+ *  The following must be considered:
+ *  - Compaction only applies to the \c FirstFit policy.
+ *  - The cost of a compaction is \c fixedCost plus \c chunkCost per chunk of memory moved.
+ *  - Settings are kept across \c simInit; compaction is off by default.
+ *
+ * \param [in] on \c true to turn compaction on; \c false to turn it off
+ * \param [in] fixedCost The time charged for every compaction
+ * \param [in] chunkCost The time charged for every chunk moved
+ */
+void simSetCompaction(bool on, SimTime fixedCost, SimTime chunkCost);
+
+// ================================================================================== //
+
 /** @} */
 
 #endif /* __SOMM23_SIM__ */
@@ -45,6 +45,8 @@
  *    There is also a number of auxiliary modules:
  *    - \c probing, which provides a probing mechanism
  *    - \c binselection, which allows to a binary version of a function
+ *    - \c profiling, which keeps per-function call counters and latency histograms
+ *    - \c metrics, which keeps aggregate results of a simulation
  *    - \c exception, which provides a way to throw exceptions
  * 
  * The simulation is driven by an input file which defines the arrival time of a list
@@ -120,6 +122,18 @@
  *   The <b>BinSelection toolkit</b> module provides a way to swith in run-time between
  *   the binary and group versions of the somm23 functions.
  *
+ * \defgroup profiling Profiling
+ * \ingroup aux
+ * \brief
+ *   The <b>Profiling toolkit</b> module keeps per-function call counters and latency histograms,
+ *   using the same IDs as the probing toolkit.
+ *
+ * \defgroup metrics Metrics
+ * \ingroup aux
+ * \brief
+ *   The <b>Metrics toolkit</b> module keeps aggregate results of a simulation,
+ *   such as waiting and turnaround times, memory utilization and throughput.
+ *
  * \defgroup dbc DbC 
  * \ingroup aux
  * \brief Design-by-Contract module.
@@ -130,6 +144,8 @@
 #include "exception.h"
 #include "probing.h"
 #include "binselection.h"
+#include "profiling.h"
+#include "metrics.h"
 
 #include "tme.h"
 #include "pct.h"
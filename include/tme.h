@@ -14,22 +14,70 @@
 #include "exception.h"
 #include "probing.h"
 #include "binselection.h"
+#include "profiling.h"
+#include "metrics.h"
 
 #include <stdint.h>
+#include <inttypes.h>
 
 /** @{ */
 
 // ================================================================================== //
 
+/*
+ * \brief Width of memory addresses, memory sizes and simulation times
+ * \details
+ *   By default, they are 32-bit values, as in the binary versions.
+ *   Building with \c SOMM23_WIDE defined (cmake option of the same name) makes them 64-bit,
+ *   allowing the simulation of memories beyond 4 GiB and of traces beyond 2^32 time units.
+ *   The binary versions are not available in such a build, so only the group versions are used.
+ *   The FMT_* macros are the printf conversions of these types; sizes shown in hexadecimal use FMT_ADDR.
+ */
+#ifdef SOMM23_WIDE
+typedef uint64_t Address;   ///< The representation of a memory address
+typedef uint64_t MemSize;   ///< The representation of an amount of memory, in bytes
+typedef uint64_t SimTime;   ///< The representation of a simulation time
+#define FMT_ADDR PRIx64
+#define FMT_SIZE PRIu64
+#define FMT_TIME PRIu64
+#else
+typedef uint32_t Address;   ///< The representation of a memory address
+typedef uint32_t MemSize;   ///< The representation of an amount of memory, in bytes
+typedef uint32_t SimTime;   ///< The representation of a simulation time
+#define FMT_ADDR "x"
+#define FMT_SIZE "u"
+#define FMT_TIME "u"
+#endif
+
+// ================================================================================== //
+
 /**
  * \brief Maximum number of simulated processes
+ * \details
+ *   It can be redefined at compile time (cmake option \c SOMM23_MAX_PROCESSES).
+ *   The binary versions are built with 100 processes, so with any other value only the group versions are used.
  */
+#ifndef MAX_PROCESSES
 #define MAX_PROCESSES 100
+#endif
+
+#if MAX_PROCESSES < 1
+#error "MAX_PROCESSES must be at least 1"
+#endif
 
 /**
  * \brief Maximum number of segments per process
+ * \details
+ *   It can be redefined at compile time (cmake option \c SOMM23_MAX_SEGMENTS).
+ *   The binary versions are built with 4 segments, so with any other value only the group versions are used.
  */
+#ifndef MAX_SEGMENTS
 #define MAX_SEGMENTS 4
+#endif
+
+#if MAX_SEGMENTS < 1
+#error "MAX_SEGMENTS must be at least 1"
+#endif
 
 /**
  * \brief Maximum number of memory blocks per process
@@ -41,7 +89,7 @@
 /**
  * \brief Indication that not time was already assigned
  */
-#define NO_TIME 0xFFFFFFFF
+#define NO_TIME ((SimTime)-1)
 
 /**
  * \brief Indication that profile allocation is not possible at the moment
@@ -51,7 +99,11 @@
 /**
  * \brief Indication that profile allocation is not possible at all
  */
+#ifdef SOMM23_WIDE
+#define IMPOSSIBLE_MAPPING ((AddressSpaceMapping*)UINTPTR_MAX)
+#else
 #define IMPOSSIBLE_MAPPING ((AddressSpaceMapping*)0xFFFFFFFF)
+#endif
 
 // ================================================================================== //
 
@@ -92,7 +144,7 @@ enum FutureEventType {
 struct FutureEvent {
     uint32_t pid;           ///< Identification of a process
     FutureEventType type;   ///< The type of event that will be produced by the process
-    uint32_t time;          ///< The time at which the event will occur
+    SimTime time;           ///< The time at which the event will occur
 };
 
 // ================================================================================== //
@@ -103,18 +155,14 @@ struct FutureEvent {
  */
 enum AllocationPolicy { 
     FirstFit,        ///< First fit policy is used in the allocation procedure
-    BuddySystem      ///< Buddy system policy is used in the allocation procedure
+    BuddySystem,     ///< Buddy system policy is used in the allocation procedure
+    Slab,            ///< Slabs per size class, on top of first fit, are used in the allocation procedure
+    Tlsf,            ///< Two-level segregated fit, with a list of free blocks per size class, is used in the allocation procedure
+    BuddyForest      ///< Buddy system over a forest of aligned power of two blocks covering the memory is used in the allocation procedure
 };
 
 // ================================================================================== //
 
-/*
- * \brief A memory address is represented by an integer value
- */
-typedef uint32_t Address; ///< The representation of a memory address
-
-// ================================================================================== //
-
 /**
  * \brief Number and sizes of the memory segments a process comprises
  * \details
@@ -124,7 +172,7 @@ typedef uint32_t Address; ///< The representation of a memory address
  */
 struct AddressSpaceProfile {
     uint32_t segmentCount;      ///< Number of segments in profile
-    uint32_t size[MAX_BLOCKS];  ///< Array with sizes of the segments
+    MemSize size[MAX_BLOCKS];   ///< Array with sizes of the segments
 };
 
 // ================================================================================== //
@@ -144,6 +192,32 @@ struct AddressSpaceMapping {
 
 // ================================================================================== //
 
+/**
+ * \brief Move of a memory block, assigned to a process, to a new address
+ */
+struct BlockRelocation {
+    uint32_t pid;       ///< Identification of the process the block is assigned to
+    Address from;       ///< The start address of the block before the move
+    Address to;         ///< The start address of the block after the move
+};
+
+// ================================================================================== //
+
+/**
+ * \brief Set of memory blocks moved by a memory compaction
+ * \details
+ *   Every block assigned to a process may be moved, so the array is grown to the number
+ *   of blocks in memory when the table is filled, and kept for the next compactions.
+ */
+struct RelocationTable {
+    uint32_t count;                 ///< Number of moved blocks
+    uint32_t capacity;              ///< Number of entries allocated in the array
+    MemSize bytes;                  ///< Total amount of memory moved, in bytes
+    BlockRelocation *block;         ///< array with the moved blocks
+};
+
+// ================================================================================== //
+
 /**
  * \brief Register of a swapped process
  */
@@ -0,0 +1,560 @@
+/*
+ *  Module-level microbenchmarks.
+ *
+ *  Every case exercises the functions of a single module, with a workload taken
+ *  from the workload generator, and reports, for every timed phase,
+ *  the time per operation, the heap allocations (through operator new) per operation,
+ *  and the peak resident set size of the case.
+ *
+ *  Every case runs in a child process, so the peak RSS is the one of the case alone,
+ *  and a crash or a failed assertion is reported instead of stopping the suite.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <new>
+
+#include "somm23.h"
+#include "workload.h"
+
+/* ******************************************** */
+
+/* maximum number of timed phases of a case */
+#define MAX_PHASES 4
+
+/* a timed phase of a case */
+struct PhaseResult {
+    char name[32];          ///< what was timed
+    uint64_t ops;           ///< number of operations
+    uint64_t nanos;         ///< wall time of all operations
+    uint64_t allocs;        ///< heap allocations made by all operations
+};
+
+/* result of a case, sent by the child process to the parent through a pipe */
+struct CaseResult {
+    bool completed;                     ///< false if an exception was thrown
+    uint32_t phaseCount;                ///< number of timed phases
+    PhaseResult phase[MAX_PHASES];      ///< the timed phases
+    long peakRss;                       ///< peak resident set size, in KiB
+    char msg[100];                      ///< exception message, if any
+};
+
+/* a benchmark case: the range of IDs it exercises and how to run it */
+struct BenchCase {
+    const char *name;
+    uint32_t lower;
+    uint32_t upper;
+    void (*run)(uint32_t n);
+};
+
+/* ******************************************** */
+
+static uint32_t opCount = 10000;
+static uint32_t fragmentation = 50;
+static MemSize memSize = 0x400000;
+static bool binaries = false;
+static WorkloadSpec spec;
+
+static CaseResult result;
+
+/* ******************************************** */
+/* heap allocations, counted for the whole program */
+
+static uint64_t allocCount = 0;
+
+void *operator new(size_t size)
+{
+    allocCount++;
+    void *p = malloc(size != 0 ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    allocCount++;
+    void *p = malloc(size != 0 ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+/* ******************************************** */
+/* timed phases: everything between phaseBegin and phaseEnd is accounted to the named phase */
+
+static uint64_t phaseStart;
+static uint64_t phaseAllocs;
+
+static void phaseBegin()
+{
+    phaseAllocs = allocCount;
+    phaseStart = soProfileNow();
+}
+
+static void phaseEnd(const char *name, uint64_t ops)
+{
+    uint64_t nanos = soProfileNow() - phaseStart;
+    if (result.phaseCount == MAX_PHASES)
+        return;
+    PhaseResult &p = result.phase[result.phaseCount++];
+    snprintf(p.name, sizeof(p.name), "%s", name);
+    p.ops = ops;
+    p.nanos = nanos;
+    p.allocs = allocCount - phaseAllocs;
+}
+
+/* ******************************************** */
+/* deterministic choices, apart from the generated workload */
+
+static uint64_t rngState;
+
+static void rngSeed(uint32_t s)
+{
+    rngState = 0x9E3779B97F4A7C15ull ^ s;
+}
+
+static uint32_t rng(uint32_t bound)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return (uint32_t)(rngState % bound);
+}
+
+/* the generated processes, with n processes at least */
+static WorkloadProcess *generate(uint32_t n)
+{
+    WorkloadSpec s = spec;
+    s.count = n;
+    WorkloadProcess *procs = new WorkloadProcess[n];
+    workloadGenerate(s, 0, n, procs);
+    return procs;
+}
+
+static void toProfile(const WorkloadProcess &p, AddressSpaceProfile *profile)
+{
+    profile->segmentCount = p.segmentCount;
+    for (uint32_t j = 0; j < MAX_SEGMENTS; j++)
+        profile->size[j] = p.size[j];
+}
+
+/* ******************************************** */
+
+static void runFeq(uint32_t n, bool monotone)
+{
+    WorkloadProcess *procs = generate(n);
+    rngSeed(spec.seed);
+
+    feqInit();
+    phaseBegin();
+    for (uint32_t i = 0; i < n; i++)
+        feqInsert(rng(2) ? ARRIVAL : TERMINATE, monotone ? procs[i].arrivalTime : rng(n * 4), procs[i].pid);
+    phaseEnd(monotone ? "feqInsert (monotone)" : "feqInsert (random)", n);
+
+    phaseBegin();
+    while (not feqIsEmpty())
+        feqPop();
+    phaseEnd("feqPop", n);
+    feqTerm();
+
+    delete[] procs;
+}
+
+static void runFeqRandom(uint32_t n)
+{
+    runFeq(n, false);
+}
+
+static void runFeqMonotone(uint32_t n)
+{
+    runFeq(n, true);
+}
+
+/* ******************************************** */
+
+static void runPct(uint32_t n)
+{
+    WorkloadProcess *procs = generate(n);
+    rngSeed(spec.seed);
+
+    pctInit();
+    phaseBegin();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        AddressSpaceProfile profile;
+        toProfile(procs[i], &profile);
+        pctInsert(procs[i].pid, procs[i].arrivalTime, procs[i].lifetime, &profile);
+    }
+    phaseEnd("pctInsert", n);
+
+    phaseBegin();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t pid = procs[rng(n)].pid;
+        pctGetLifetime(pid);
+        pctGetAddressSpaceProfile(pid);
+    }
+    phaseEnd("pctGet (lifetime, profile)", 2 * (uint64_t)n);
+
+    phaseBegin();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t pid = procs[rng(n)].pid;
+        AddressSpaceMapping mapping = { 1, { 0x10000 } };
+        switch (rng(3))
+        {
+            case 0: pctUpdateState(pid, ACTIVE, i, &mapping); break;
+            case 1: pctUpdateState(pid, SWAPPED); break;
+            default: pctUpdateState(pid, FINISHED, i + 1000); break;
+        }
+    }
+    phaseEnd("pctUpdateState", n);
+    pctTerm();
+
+    delete[] procs;
+}
+
+/* ******************************************** */
+
+static void runSwp(uint32_t n)
+{
+    WorkloadProcess *procs = generate(n);
+    rngSeed(spec.seed);
+
+    swpInit();
+    phaseBegin();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        AddressSpaceProfile profile;
+        toProfile(procs[i], &profile);
+        swpAdd(procs[i].pid, &profile);
+    }
+    phaseEnd("swpAdd", n);
+
+    phaseBegin();
+    for (uint32_t i = 0; i < n; i++)
+        swpPeek(rng(n));
+    phaseEnd("swpPeek", n);
+
+    phaseBegin();
+    for (uint32_t count = n; count > 0; count--)
+        swpRemove(rng(count));
+    phaseEnd("swpRemove", n);
+    swpTerm();
+
+    delete[] procs;
+}
+
+/* ******************************************** */
+
+/*
+ * The memory is first filled with the generated processes, and then the given percentage
+ * of them, taken at random, is freed, leaving holes all over the memory.
+ * Then, every operation frees a random process and allocates the next one,
+ * so the fragmentation stays around the initial one.
+ */
+static void runMem(uint32_t n, AllocationPolicy policy)
+{
+    rngSeed(spec.seed);
+    memInit(memSize, 0x10000, 0x100, policy);
+
+    /* fill the memory */
+    uint32_t max = (memSize - 0x10000) / 0x100;
+    WorkloadProcess *procs = generate(max + n);
+    AddressSpaceMapping *live = new AddressSpaceMapping[max];
+    uint32_t count = 0, next = 0;
+    while (count < max)
+    {
+        AddressSpaceProfile profile;
+        toProfile(procs[next], &profile);
+        AddressSpaceMapping *mapping = memAlloc(procs[next++].pid, &profile);
+        if (mapping == NO_MAPPING or mapping == IMPOSSIBLE_MAPPING)
+            break;
+        live[count++] = *mapping;
+    }
+
+    /* and free the given percentage of it */
+    for (uint32_t holes = count * fragmentation / 100; holes > 0; holes--)
+    {
+        uint32_t k = rng(count);
+        memFree(&live[k]);
+        live[k] = live[--count];
+    }
+
+    uint64_t allocs = 0, frees = 0, allocNanos = 0, freeNanos = 0, allocAllocs = 0, freeAllocs = 0;
+    for (uint32_t i = 0; i < n and count > 0; i++)
+    {
+        uint32_t k = rng(count);
+        phaseBegin();
+        memFree(&live[k]);
+        freeNanos += soProfileNow() - phaseStart;
+        freeAllocs += allocCount - phaseAllocs;
+        frees++;
+        live[k] = live[--count];
+
+        AddressSpaceProfile profile;
+        toProfile(procs[next], &profile);
+        phaseBegin();
+        AddressSpaceMapping *mapping = memAlloc(procs[next++].pid, &profile);
+        allocNanos += soProfileNow() - phaseStart;
+        allocAllocs += allocCount - phaseAllocs;
+        allocs++;
+        if (mapping != NO_MAPPING and mapping != IMPOSSIBLE_MAPPING)
+            live[count++] = *mapping;
+    }
+
+    PhaseResult &a = result.phase[result.phaseCount++];
+    snprintf(a.name, sizeof(a.name), "memAlloc (%u%% holes)", fragmentation);
+    a.ops = allocs;
+    a.nanos = allocNanos;
+    a.allocs = allocAllocs;
+    PhaseResult &f = result.phase[result.phaseCount++];
+    snprintf(f.name, sizeof(f.name), "memFree (%u%% holes)", fragmentation);
+    f.ops = frees;
+    f.nanos = freeNanos;
+    f.allocs = freeAllocs;
+
+    memTerm();
+    delete[] live;
+    delete[] procs;
+}
+
+static void runMemFirstFit(uint32_t n)
+{
+    runMem(n, FirstFit);
+}
+
+static void runMemBitmap(uint32_t n)
+{
+    memShadowBitmap(true);
+    runMem(n, FirstFit);
+}
+
+static void runMemFitArray(uint32_t n)
+{
+    memFirstFitArray(true);
+    runMem(n, FirstFit);
+}
+
+static void runMemBuddy(uint32_t n)
+{
+    runMem(n, BuddySystem);
+}
+
+static void runMemLazy(uint32_t n)
+{
+    memLazyMerge(4);
+    runMem(n, BuddySystem);
+}
+
+static void runMemForest(uint32_t n)
+{
+    runMem(n, BuddyForest);
+}
+
+static void runMemSlab(uint32_t n)
+{
+    runMem(n, Slab);
+}
+
+static void runMemTlsf(uint32_t n)
+{
+    runMem(n, Tlsf);
+}
+
+/* ******************************************** */
+
+static BenchCase cases[] = {
+    { "feq-random",   201, 206, runFeqRandom },
+    { "feq-monotone", 201, 206, runFeqMonotone },
+    { "pct",          301, 309, runPct },
+    { "swp",          401, 406, runSwp },
+    { "mem-ff",       501, 509, runMemFirstFit },
+    { "mem-bitmap",   501, 509, runMemBitmap },
+    { "mem-ffarray",  501, 509, runMemFitArray },
+    { "mem-buddy",    501, 509, runMemBuddy },
+    { "mem-lazy",     501, 509, runMemLazy },
+    { "mem-forest",   501, 509, runMemForest },
+    { "mem-slab",     513, 514, runMemSlab },
+    { "mem-tlsf",     515, 516, runMemTlsf },
+};
+
+/* ******************************************** */
+/*
+ * Run a case in a child process, with the IDs of the case taken from the binaries if asked for.
+ * Return false if the child crashed
+ */
+static bool runCase(const BenchCase &c, CaseResult &res, int &sig)
+{
+    int fd[2];
+    if (pipe(fd) == -1)
+        throw Exception(errno, __func__);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1)
+        throw Exception(errno, __func__);
+
+    if (pid == 0)
+    {
+        close(fd[0]);
+        memset(&result, 0, sizeof(result));
+        soBinSetIDs(0, 0);
+        if (binaries)
+            soBinAddIDs(c.lower, c.upper);
+        try
+        {
+            c.run(opCount);
+            result.completed = true;
+        }
+        catch (Exception &e)
+        {
+            snprintf(result.msg, sizeof(result.msg), "%s: error %d", e.func, e.en);
+        }
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        result.peakRss = usage.ru_maxrss;
+        if (write(fd[1], &result, sizeof(result)) != sizeof(result))
+            _exit(EXIT_FAILURE);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fd[1]);
+    ssize_t cnt = 0, n;
+    while (cnt < (ssize_t)sizeof(res) and (n = read(fd[0], (char *)&res + cnt, sizeof(res) - cnt)) > 0)
+        cnt += n;
+    close(fd[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    sig = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    return cnt == sizeof(res);
+}
+
+/* ******************************************** */
+
+static void printUsage(const char *cmd_name)
+{
+    printf("Sinopsis: %s [OPTIONS] [case ...]\n"
+           "  Runs every microbenchmark (or the given ones), reporting time and heap allocations\n"
+           "  per operation and the peak resident set size.\n"
+           "  Cases: feq-random, feq-monotone, pct, swp, mem-ff, mem-bitmap, mem-ffarray, mem-buddy, mem-lazy, mem-forest, mem-slab, mem-tlsf\n"
+           "  OPTIONS:\n"
+           "  -n num        --- number of operations per phase (default: %u)\n"
+           "  -s num        --- seed of the workload generator (default: %u)\n"
+           "  -z dist       --- segment sizes, as in somm23_workgen (default: uniform)\n"
+           "  -f percent    --- memory freed at random before timing the mem cases (default: %u)\n"
+           "  -m size       --- memory size of the mem cases (default: %#" FMT_ADDR ")\n"
+           "  -b            --- use the binary versions of the functions\n"
+           "  -h            --- print this help\n",
+           cmd_name, opCount, spec.seed, fragmentation, memSize);
+}
+
+/* ******************************************** */
+
+int main(int argc, char *argv[])
+{
+    const char *progName = basename(argv[0]);
+    workloadDefaults(&spec);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:z:f:m:bh")) != -1)
+    {
+        bool ok = true;
+        switch (opt)
+        {
+            case 'n': opCount = atoi(optarg); ok = opCount > 0; break;
+            case 's': spec.seed = atoi(optarg); break;
+            case 'z': ok = workloadParseSizes(&spec, optarg); break;
+            case 'f': fragmentation = atoi(optarg); ok = fragmentation < 100; break;
+            case 'm': memSize = strtoull(optarg, NULL, 0); ok = memSize > 0x10000; break;
+            case 'b': binaries = true; ok = SOMM23_BINARY_LAYOUT; break;
+            case 'h': printUsage(progName); return EXIT_SUCCESS;
+            default: ok = false; break;
+        }
+        if (not ok)
+        {
+            fprintf(stderr, "%s: Wrong option.\n", progName);
+            printUsage(progName);
+            return EXIT_FAILURE;
+        }
+    }
+
+    uint32_t failures = 0;
+    char title[100];
+    snprintf(title, sizeof(title), "%s versions, %u operations per phase, seed %u",
+             binaries ? "binary" : "group", opCount, spec.seed);
+    fprintf(stdout, "+==============================================================================================+\n");
+    fprintf(stdout, "| %-92s |\n", title);
+    fprintf(stdout, "+--------------+----------------------------+-----------+------------+------------+------------+\n");
+    fprintf(stdout, "|     case     |           phase            |    ops    |   ns/op    | allocs/op  |  peak KiB  |\n");
+    fprintf(stdout, "+--------------+----------------------------+-----------+------------+------------+------------+\n");
+
+    for (const BenchCase &c : cases)
+    {
+        /* skip cases not given in command line */
+        bool wanted = optind == argc;
+        for (int i = optind; i < argc; i++)
+            wanted = wanted or strcmp(argv[i], c.name) == 0;
+        if (not wanted)
+            continue;
+
+        CaseResult res;
+        int sig;
+        if (not runCase(c, res, sig))
+        {
+            char msg[40];
+            snprintf(msg, sizeof(msg), "crashed (signal %d)", sig);
+            fprintf(stdout, "| %-12s | %-77s |\n", c.name, msg);
+            failures++;
+            continue;
+        }
+
+        for (uint32_t i = 0; i < res.phaseCount; i++)
+        {
+            const PhaseResult &p = res.phase[i];
+            uint64_t ops = p.ops != 0 ? p.ops : 1;
+            fprintf(stdout, "| %-12s | %-26.26s | %9llu | %10.1f | %10.2f | %10ld |\n",
+                    c.name, p.name, (unsigned long long)p.ops, (double)p.nanos / ops, (double)p.allocs / ops, res.peakRss);
+        }
+        if (not res.completed)
+        {
+            fprintf(stdout, "| %-12s | failed: %-69.69s |\n", c.name, res.msg);
+            failures++;
+        }
+        fprintf(stdout, "+--------------+----------------------------+-----------+------------+------------+------------+\n");
+    }
+
+    fprintf(stdout, "\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
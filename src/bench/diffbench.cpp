@@ -0,0 +1,506 @@
+/*
+ *  Differential performance harness.
+ *
+ *  Runs the same generated workload twice per case: once with every function
+ *  taken from the binary (reference) libraries, and once with the IDs under test
+ *  switched to the group version, through the binselection toolkit.
+ *  For every function ID it reports throughput and latency, taken from the
+ *  profiling toolkit, and it checks that the observable results of both runs
+ *  (returned values and printed tables) are the same.
+ *
+ *  Every run takes place in a child process, so a crash or a failed assertion
+ *  in one version is reported instead of stopping the harness.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "somm23.h"
+
+/* ******************************************** */
+
+/* maximum number of function IDs a case may cover */
+#define MAX_CASE_IDS 10
+
+/* result of a run, sent by the child process to the parent through a pipe */
+struct RunResult {
+    bool completed;                         ///< false if an exception was thrown
+    uint64_t digest;                        ///< hash of everything observable
+    uint64_t nanos;                         ///< wall time of the workload
+    SoProfileStats stats[MAX_CASE_IDS];     ///< per-ID counters
+    char msg[100];                          ///< exception message, if any
+};
+
+/* a benchmark case: a workload and the range of IDs it exercises */
+struct BenchCase {
+    const char *name;
+    uint32_t lower;
+    uint32_t upper;
+    void (*run)(uint32_t n, uint32_t seed);
+};
+
+/* ******************************************** */
+
+static uint32_t opCount = 1000;
+static uint32_t seed = 1;
+static uint32_t timeout = 60;
+static const char *dumpDir = NULL;
+static const char *dumpSuffix = "bin";     // "group" in the run of the group versions
+
+static uint64_t digest;
+static uint64_t rngState;
+
+/* ******************************************** */
+/* deterministic generator, so both versions see exactly the same workload */
+
+static void rngSeed(uint32_t s)
+{
+    rngState = 0x9E3779B97F4A7C15ull ^ s;
+}
+
+static uint32_t rng(uint32_t bound)
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return (uint32_t)(rngState % bound);
+}
+
+/* ******************************************** */
+/* FNV-1a, over returned values and printed tables */
+
+static void digestBytes(const void *p, size_t n)
+{
+    const uint8_t *b = (const uint8_t *)p;
+    for (size_t i = 0; i < n; i++)
+    {
+        digest ^= b[i];
+        digest *= 0x100000001B3ull;
+    }
+}
+
+static void digestValue(uint64_t v)
+{
+    digestBytes(&v, sizeof(v));
+}
+
+/* print into a temporary file and fold its contents into the digest */
+static void digestPrint(void (*print)(FILE *), const char *tag)
+{
+    FILE *fs = tmpfile();
+    if (fs == NULL)
+        throw Exception(errno, __func__);
+    print(fs);
+    fflush(fs);
+    rewind(fs);
+
+    FILE *dump = NULL;
+    if (dumpDir != NULL)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s-%s.txt", dumpDir, tag, dumpSuffix);
+        dump = fopen(path, "a");
+    }
+
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fs)) > 0)
+    {
+        digestBytes(buf, n);
+        if (dump != NULL)
+            fwrite(buf, 1, n, dump);
+    }
+    if (dump != NULL)
+        fclose(dump);
+    fclose(fs);
+}
+
+/* ******************************************** */
+/* generated address space profile, with segment sizes in [0x100, 0x800] */
+
+static void randomProfile(AddressSpaceProfile *profile)
+{
+    profile->segmentCount = 1 + rng(MAX_SEGMENTS);
+    for (uint32_t i = 0; i < MAX_SEGMENTS; i++)
+        profile->size[i] = i < profile->segmentCount ? 0x100 + rng(0x701) : 0;
+}
+
+/* distinct PIDs in [1, 65535], taken from a shuffled range */
+static void randomPids(uint32_t *pids, uint32_t n)
+{
+    static uint32_t all[65535];
+    for (uint32_t i = 0; i < 65535; i++)
+        all[i] = i + 1;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t j = i + rng(65535 - i);
+        uint32_t t = all[i]; all[i] = all[j]; all[j] = t;
+        pids[i] = all[i];
+    }
+}
+
+/* ******************************************** */
+
+static void runFeq(uint32_t n, uint32_t s)
+{
+    rngSeed(s);
+    feqInit();
+    for (uint32_t i = 0; i < n; i++)
+        feqInsert(rng(2) ? ARRIVAL : TERMINATE, rng(n * 4), 1 + rng(65535));
+    digestPrint(feqPrint, "feq");
+    while (not feqIsEmpty())
+    {
+        FutureEvent e = feqPop();
+        digestValue(e.pid);
+        digestValue(e.type);
+        digestValue(e.time);
+    }
+    feqTerm();
+}
+
+/* ******************************************** */
+
+static void runPct(uint32_t n, uint32_t s)
+{
+    rngSeed(s);
+    if (n > 65535)
+        n = 65535;
+    uint32_t *pids = new uint32_t[n];
+    randomPids(pids, n);
+
+    pctInit();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        AddressSpaceProfile profile;
+        randomProfile(&profile);
+        pctInsert(pids[i], i, 10 + rng(991), &profile);
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t pid = pids[rng(n)];
+        digestValue(pctGetLifetime(pid));
+        digestValue(pctGetAddressSpaceProfile(pid)->segmentCount);
+        AddressSpaceMapping mapping = { 1, { 0x10000 + 0x100 * i } };
+        switch (rng(3))
+        {
+            case 0: pctUpdateState(pid, ACTIVE, i, &mapping); break;
+            case 1: pctUpdateState(pid, SWAPPED); break;
+            default: pctUpdateState(pid, FINISHED, i + 1000); break;
+        }
+        digestValue(pctGetAddressSpaceMapping(pid)->blockCount);
+        digestBytes(pctGetStateAsString(pid), strlen(pctGetStateAsString(pid)));
+    }
+    digestPrint(pctPrint, "pct");
+    pctTerm();
+    delete[] pids;
+}
+
+/* ******************************************** */
+
+static void runSwp(uint32_t n, uint32_t s)
+{
+    rngSeed(s);
+    swpInit();
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        AddressSpaceProfile profile;
+        randomProfile(&profile);
+        swpAdd(1 + rng(65535), &profile);
+        count++;
+        if (rng(3) == 0)
+        {
+            SwappedProcess *p = swpPeek(rng(count));
+            digestValue(p != NULL ? p->pid : 0);
+        }
+        if (rng(4) == 0)
+        {
+            swpRemove(rng(count));
+            count--;
+        }
+    }
+    digestPrint(swpPrint, "swp");
+    while (count > 0)
+    {
+        SwappedProcess *p = swpPeek(0);
+        digestValue(p != NULL ? p->pid : 0);
+        swpRemove(0);
+        count--;
+    }
+    swpTerm();
+}
+
+/* ******************************************** */
+
+static void runMem(uint32_t n, uint32_t s, AllocationPolicy policy, const char *tag)
+{
+    rngSeed(s);
+    memInit(0x100000, 0x10000, 0x100, policy);
+
+    /* live mappings, freed in random order */
+    AddressSpaceMapping *live = new AddressSpaceMapping[n];
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (count > 0 and rng(2) == 0)
+        {
+            uint32_t k = rng(count);
+            memFree(&live[k]);
+            live[k] = live[--count];
+            continue;
+        }
+        AddressSpaceProfile profile;
+        randomProfile(&profile);
+        AddressSpaceMapping *mapping = memAlloc(1 + i % 65535, &profile);
+        if (mapping == NO_MAPPING or mapping == IMPOSSIBLE_MAPPING)
+        {
+            digestValue((uintptr_t)mapping);
+            continue;
+        }
+        digestBytes(mapping->address, mapping->blockCount * sizeof(Address));
+        live[count++] = *mapping;
+    }
+    digestPrint(memPrint, tag);
+    while (count > 0)
+        memFree(&live[--count]);
+    digestPrint(memPrint, tag);
+    memTerm();
+    delete[] live;
+}
+
+static void runMemFirstFit(uint32_t n, uint32_t s)
+{
+    runMem(n, s, FirstFit, "mem-ff");
+}
+
+static void runMemBuddy(uint32_t n, uint32_t s)
+{
+    runMem(n, s, BuddySystem, "mem-buddy");
+}
+
+/* ******************************************** */
+
+static void runSim(uint32_t n, uint32_t s)
+{
+    rngSeed(s);
+    if (n > MAX_PROCESSES)
+        n = MAX_PROCESSES;
+    uint32_t pids[MAX_PROCESSES];
+    randomPids(pids, n);
+
+    /* generated trace, in the input file format */
+    char fname[] = "/tmp/somm23-diffbench-XXXXXX";
+    int fd = mkstemp(fname);
+    if (fd == -1)
+        throw Exception(errno, __func__);
+    FILE *fs = fdopen(fd, "w");
+    uint32_t arrival = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        AddressSpaceProfile profile;
+        randomProfile(&profile);
+        arrival += rng(101);
+        fprintf(fs, "%u ; %u ; %u ; ", pids[i], arrival, 10 + rng(991));
+        for (uint32_t j = 0; j < profile.segmentCount; j++)
+            fprintf(fs, j == 0 ? "%u" : ", %u", profile.size[j]);
+        fprintf(fs, "\n");
+    }
+    fclose(fs);
+
+    simInit(0x100000, 0x10000, 0x100, FirstFit);
+    simLoad(fname);
+    unlink(fname);
+    simRun(0);
+    digestValue(stepCount);
+    digestValue(simTime);
+    digestPrint(pctPrint, "sim");
+    simTerm();
+}
+
+/* ******************************************** */
+
+static BenchCase cases[] = {
+    { "feq",       201, 206, runFeq },
+    { "pct",       301, 309, runPct },
+    { "swp",       401, 406, runSwp },
+    { "mem-ff",    501, 509, runMemFirstFit },
+    { "mem-buddy", 501, 509, runMemBuddy },
+    { "sim",       101, 108, runSim },
+};
+
+/* ******************************************** */
+/*
+ * Run a case in a child process.
+ * With bin selection map set to all binaries, but the IDs under test if group is true.
+ * Return false if the child crashed or timed out
+ */
+static bool runCase(const BenchCase &c, bool group, RunResult &res, int &sig)
+{
+    int fd[2];
+    if (pipe(fd) == -1)
+        throw Exception(errno, __func__);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1)
+        throw Exception(errno, __func__);
+
+    if (pid == 0)
+    {
+        close(fd[0]);
+        alarm(timeout);
+        memset(&res, 0, sizeof(res));
+        soBinSetIDs(100, 599);
+        if (group)
+            soBinRemoveIDs(c.lower, c.upper);
+        dumpSuffix = group ? "group" : "bin";
+        digest = 0xCBF29CE484222325ull;
+        soProfileReset();
+        soProfileOpen(NULL);
+        uint64_t start = soProfileNow();
+        try
+        {
+            c.run(opCount, seed);
+            res.completed = true;
+        }
+        catch (Exception &e)
+        {
+            snprintf(res.msg, sizeof(res.msg), "%s: error %d", e.func, e.en);
+        }
+        res.nanos = soProfileNow() - start;
+        res.digest = digest;
+        for (uint32_t id = c.lower; id <= c.upper and id - c.lower < MAX_CASE_IDS; id++)
+            soProfileGet(id, &res.stats[id - c.lower]);
+        if (write(fd[1], &res, sizeof(res)) != sizeof(res))
+            _exit(EXIT_FAILURE);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fd[1]);
+    ssize_t cnt = 0, n;
+    while (cnt < (ssize_t)sizeof(res) and (n = read(fd[0], (char *)&res + cnt, sizeof(res) - cnt)) > 0)
+        cnt += n;
+    close(fd[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    sig = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    return cnt == sizeof(res);
+}
+
+/* ******************************************** */
+
+static void printUsage(const char *cmd_name)
+{
+    printf("Sinopsis: %s [OPTIONS] [case ...]\n"
+           "  Runs every case (or the given ones) with the binary and the group versions,\n"
+           "  reporting per-function performance and checking the results are equivalent.\n"
+           "  Cases: feq, pct, swp, mem-ff, mem-buddy, sim\n"
+           "  OPTIONS:\n"
+           "  -n num        --- number of operations per case (default: %u)\n"
+           "  -s num        --- seed of the workload generator (default: %u)\n"
+           "  -t secs       --- time limit per run (default: %u)\n"
+           "  -d dir        --- dump the tables printed by every run into given directory\n"
+           "  -h            --- print this help\n",
+           cmd_name, opCount, seed, timeout);
+}
+
+/* ******************************************** */
+
+static void printRow(const char *name, const char *version, const RunResult &res, uint32_t idx, uint32_t id)
+{
+    const SoProfileStats &s = res.stats[idx];
+    if (s.calls == 0)
+        return;
+    fprintf(stdout, "| %-9s | %3u %-26.26s | %-8s | %9llu | %12.0f | %9llu | %9llu | %10llu |\n",
+            name, id, s.name != NULL ? s.name : "---", version,
+            (unsigned long long)s.calls, s.calls * 1e9 / (s.nanos != 0 ? s.nanos : 1),
+            (unsigned long long)(s.nanos / s.calls),
+            (unsigned long long)soProfilePercentile(s, 0.50),
+            (unsigned long long)soProfilePercentile(s, 0.99));
+}
+
+/* ******************************************** */
+
+int main(int argc, char *argv[])
+{
+    const char *progName = basename(argv[0]);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:t:d:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': opCount = atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            case 't': timeout = atoi(optarg); break;
+            case 'd': dumpDir = optarg; break;
+            case 'h': printUsage(progName); return EXIT_SUCCESS;
+            default:
+                fprintf(stderr, "%s: Wrong option.\n", progName);
+                printUsage(progName);
+                return EXIT_FAILURE;
+        }
+    }
+
+    uint32_t failures = 0;
+    fprintf(stdout, "+=========================================================================================================================+\n");
+    fprintf(stdout, "|                                  binaries vs group (%8u ops per case, seed %10u)                            |\n", opCount, seed);
+    fprintf(stdout, "+-----------+--------------------------------+----------+-----------+--------------+-----------+-----------+------------+\n");
+    fprintf(stdout, "|   case    |           function             | version  |   calls   |    ops/s     | mean (ns) | p50 (ns)  |  p99 (ns)  |\n");
+    fprintf(stdout, "+-----------+--------------------------------+----------+-----------+--------------+-----------+-----------+------------+\n");
+
+    for (const BenchCase &c : cases)
+    {
+        /* skip cases not given in command line */
+        bool wanted = optind == argc;
+        for (int i = optind; i < argc; i++)
+            wanted = wanted or strcmp(argv[i], c.name) == 0;
+        if (not wanted)
+            continue;
+
+        RunResult ref, test;
+        int refSig, testSig;
+        bool refOk = runCase(c, false, ref, refSig);
+        bool testOk = runCase(c, true, test, testSig);
+
+        if (refOk and testOk)
+        {
+            for (uint32_t i = 0; i <= c.upper - c.lower and i < MAX_CASE_IDS; i++)
+            {
+                printRow(c.name, "binaries", ref, i, c.lower + i);
+                printRow(c.name, "group", test, i, c.lower + i);
+            }
+        }
+
+        char verdict[128];
+        if (not refOk)
+            snprintf(verdict, sizeof(verdict), "reference run crashed (signal %d)", refSig);
+        else if (not testOk)
+            snprintf(verdict, sizeof(verdict), "group run crashed (signal %d)", testSig);
+        else if (not ref.completed)
+            snprintf(verdict, sizeof(verdict), "reference run failed (%s)", ref.msg);
+        else if (not test.completed)
+            snprintf(verdict, sizeof(verdict), "group run failed (%s)", test.msg);
+        else if (ref.digest != test.digest)
+            snprintf(verdict, sizeof(verdict), "DIFFERENT results (%.2fx time)", (double)test.nanos / ref.nanos);
+        else
+            snprintf(verdict, sizeof(verdict), "equivalent results (%.2fx time)", (double)test.nanos / ref.nanos);
+
+        bool ok = refOk and testOk and ref.completed and test.completed and ref.digest == test.digest;
+        failures += ok ? 0 : 1;
+        fprintf(stdout, "| %-9s | IDs %3u-%3u: %-90s |\n", c.name, c.lower, c.upper, verdict);
+        fprintf(stdout, "+-----------+--------------------------------+----------+-----------+--------------+-----------+-----------+------------+\n");
+    }
+
+    fprintf(stdout, "\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,339 @@
+/*
+ *  Asymptotic scaling benchmark.
+ *
+ *  Runs the simulator on generated workloads of increasing number of processes, N,
+ *  with profiling on, and fits, for every function ID, the growth exponent of its
+ *  accumulated time (and of its number of calls) against N, by least squares on a log-log scale.
+ *  A function whose time grows faster than N, beyond a tolerance, is flagged as superlinear:
+ *  with a steady load, every process costs the same, so the whole run should be linear.
+ *
+ *  Every size runs in a child process, so a size that takes longer than the timeout
+ *  stops the sweep, instead of the benchmark.
+ *  N is limited to MAX_PROCESSES, the size of the forthcoming table,
+ *  which can be redefined at compile time (cmake option SOMM23_MAX_PROCESSES).
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <thread>
+#include <vector>
+
+#include "somm23.h"
+#include "workload.h"
+
+/* ******************************************** */
+
+/* range of function IDs looked at */
+#define FIRST_ID 101
+#define LAST_ID 599
+#define ID_COUNT (LAST_ID - FIRST_ID + 1)
+
+/* maximum number of sizes of a sweep */
+#define MAX_SIZES 32
+
+/* counters of a function at a given size */
+struct FunctionResult {
+    char name[32];          ///< name of the function, empty if never called
+    uint64_t calls;         ///< number of calls
+    uint64_t nanos;         ///< accumulated time
+};
+
+/* result of a size, sent by the child process to the parent through a pipe */
+struct SizeResult {
+    bool completed;                     ///< false if an exception was thrown
+    uint64_t nanos;                     ///< wall time of the whole run
+    long peakRssKiB;                    ///< peak resident set size, in KiB
+    FunctionResult fn[ID_COUNT];        ///< per-ID counters
+    char msg[100];                      ///< exception message, if any
+};
+
+/* ******************************************** */
+
+static MemSize chunkSize = 0x100;
+static MemSize memSize = 0x1000 * 0x100;
+static MemSize osSize = 0x100 * 0x100;
+static AllocationPolicy policy = FirstFit;
+static uint32_t timeout = 300;
+static double tolerance = 0.25;
+static uint64_t floorNanos = 1000000;
+
+static SizeResult result;
+
+/* ******************************************** */
+/*
+ * Run the simulator on the given trace, in a child process.
+ * Return false if the child crashed or timed out
+ */
+static bool runSize(const char *fname, SizeResult &res, int &sig)
+{
+    int fd[2];
+    if (pipe(fd) == -1)
+        throw Exception(errno, __func__);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1)
+        throw Exception(errno, __func__);
+
+    if (pid == 0)
+    {
+        close(fd[0]);
+        alarm(timeout);
+        memset(&result, 0, sizeof(result));
+        soBinSetIDs(0, 0);
+        soProfileReset();
+        soProfileOpen(NULL);
+        uint64_t start = soProfileNow();
+        try
+        {
+            simInit(memSize, osSize, chunkSize, policy);
+            simLoad(fname);
+            simRun(0);
+            simTerm();
+            result.completed = true;
+        }
+        catch (Exception &e)
+        {
+            snprintf(result.msg, sizeof(result.msg), "%s: error %d", e.func, e.en);
+        }
+        result.nanos = soProfileNow() - start;
+        for (uint32_t id = FIRST_ID; id <= LAST_ID; id++)
+        {
+            SoProfileStats stats;
+            FunctionResult &f = result.fn[id - FIRST_ID];
+            if (not soProfileGet(id, &stats) or stats.calls == 0)
+                continue;
+            snprintf(f.name, sizeof(f.name), "%s", stats.name != NULL ? stats.name : "---");
+            f.calls = stats.calls;
+            f.nanos = stats.nanos;
+        }
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        result.peakRssKiB = usage.ru_maxrss;
+        if (write(fd[1], &result, sizeof(result)) != sizeof(result))
+            _exit(EXIT_FAILURE);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fd[1]);
+    ssize_t cnt = 0, n;
+    while (cnt < (ssize_t)sizeof(res) and (n = read(fd[0], (char *)&res + cnt, sizeof(res) - cnt)) > 0)
+        cnt += n;
+    close(fd[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    sig = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    return cnt == sizeof(res);
+}
+
+/* ******************************************** */
+/*
+ * Least squares slope of log(y) against log(x), over the points with y > 0.
+ * Return false if there are less than two such points
+ */
+static bool fitExponent(const uint64_t *x, const uint64_t *y, uint32_t n, double &slope)
+{
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    uint32_t cnt = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (y[i] == 0)
+            continue;
+        double lx = log((double)x[i]), ly = log((double)y[i]);
+        sx += lx; sy += ly; sxx += lx * lx; sxy += lx * ly;
+        cnt++;
+    }
+    double den = cnt * sxx - sx * sx;
+    if (cnt < 2 or den == 0)
+        return false;
+    slope = (cnt * sxy - sx * sy) / den;
+    return true;
+}
+
+/* ******************************************** */
+
+static void printUsage(const char *cmd_name, uint32_t minExp, uint32_t maxExp, uint32_t steps)
+{
+    printf("Sinopsis: %s [OPTIONS]\n"
+           "  Runs the simulator on generated workloads of 10^min to 10^max processes,\n"
+           "  and fits the growth exponent of the time of every function, flagging the superlinear ones.\n"
+           "  N is limited to MAX_PROCESSES (%u in this build, see cmake option SOMM23_MAX_PROCESSES).\n"
+           "  OPTIONS:\n"
+           "  -n exp        --- smallest size, as a power of 10 (default: %u)\n"
+           "  -N exp        --- largest size, as a power of 10 (default: %u)\n"
+           "  -p num        --- number of sizes per power of 10 (default: %u)\n"
+           "  -s num        --- seed of the workloads (default: 1)\n"
+           "  -a dist       --- time between arrivals, as in somm23_workgen\n"
+           "  -l dist       --- lifetimes, as in somm23_workgen\n"
+           "  -z dist       --- segment sizes, as in somm23_workgen\n"
+           "  -f policy     --- allocation policy: first, buddy, forest, slab or tlsf (default: first)\n"
+           "  -c size       --- chunk size (default: %#" FMT_ADDR ")\n"
+           "  -m size       --- total memory size (default: %#" FMT_ADDR ")\n"
+           "  -k size       --- memory size used by (kernel) OS (default: %#" FMT_ADDR ")\n"
+           "  -e excess     --- exponents above 1 + excess are superlinear (default: %g)\n"
+           "  -F nanos      --- functions taking less than this, at the largest size, are not flagged (default: %" PRIu64 ")\n"
+           "  -t secs       --- timeout of every size; a size timing out ends the sweep (default: %u)\n"
+           "  -h            --- print this help\n",
+           cmd_name, MAX_PROCESSES, minExp, maxExp, steps, chunkSize, memSize, osSize, tolerance, floorNanos, timeout);
+}
+
+/* ******************************************** */
+
+int main(int argc, char *argv[])
+{
+    const char *progName = basename(argv[0]);
+
+    WorkloadSpec spec;
+    workloadDefaults(&spec);
+    uint32_t minExp = 2, maxExp = 7, steps = 2;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:N:p:s:a:l:z:f:c:m:k:e:F:t:h")) != -1)
+    {
+        bool ok = true;
+        switch (opt)
+        {
+            case 'n': minExp = atoi(optarg); ok = minExp >= 1 and minExp <= 9; break;
+            case 'N': maxExp = atoi(optarg); ok = maxExp >= 1 and maxExp <= 9; break;
+            case 'p': steps = atoi(optarg); ok = steps >= 1 and steps <= 4; break;
+            case 's': spec.seed = strtoul(optarg, NULL, 0); break;
+            case 'a': ok = workloadParseArrivals(&spec, optarg); break;
+            case 'l': ok = workloadParseLifetimes(&spec, optarg); break;
+            case 'z': ok = workloadParseSizes(&spec, optarg); break;
+            case 'f': policy = strcmp(optarg, "forest") == 0 ? BuddyForest : optarg[0] == 'b' ? BuddySystem : optarg[0] == 's' ? Slab : optarg[0] == 't' ? Tlsf : FirstFit; break;
+            case 'c': chunkSize = strtoull(optarg, NULL, 0); ok = chunkSize > 0; break;
+            case 'm': memSize = strtoull(optarg, NULL, 0); ok = memSize > 0; break;
+            case 'k': osSize = strtoull(optarg, NULL, 0); ok = osSize > 0; break;
+            case 'e': tolerance = atof(optarg); ok = tolerance >= 0; break;
+            case 'F': floorNanos = strtoull(optarg, NULL, 0); break;
+            case 't': timeout = atoi(optarg); break;
+            case 'h': printUsage(progName, minExp, maxExp, steps); return EXIT_SUCCESS;
+            default: ok = false; break;
+        }
+        if (not ok or minExp > maxExp)
+        {
+            fprintf(stderr, "%s: Wrong option.\n", progName);
+            printUsage(progName, minExp, maxExp, steps);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* the sizes, evenly spaced on a log scale, up to MAX_PROCESSES */
+    std::vector<uint64_t> sizes;
+    for (uint32_t i = 0; i <= (maxExp - minExp) * steps and sizes.size() < MAX_SIZES; i++)
+    {
+        uint64_t n = llround(pow(10.0, minExp + (double)i / steps));
+        if (n > MAX_PROCESSES)
+        {
+            fprintf(stdout, "Sizes above MAX_PROCESSES (%u) skipped\n", MAX_PROCESSES);
+            if (sizes.empty() or sizes.back() < MAX_PROCESSES)
+                sizes.push_back(MAX_PROCESSES);
+            break;
+        }
+        sizes.push_back(n);
+    }
+
+    uint32_t threads = std::thread::hardware_concurrency();
+    std::vector<SizeResult> results;
+    std::vector<uint64_t> done;
+    try
+    {
+        for (uint64_t n : sizes)
+        {
+            /* the workload goes through simLoad, as it is one of the functions looked at */
+            char fname[] = "/tmp/somm23_scaleXXXXXX";
+            int fd = mkstemp(fname);
+            FILE *fout = fd != -1 ? fdopen(fd, "w") : NULL;
+            if (fout == NULL)
+                throw Exception(errno, __func__);
+            WorkloadSpec s = spec;
+            s.count = n;
+            workloadWrite(s, fout, threads != 0 ? threads : 1);
+            fclose(fout);
+
+            int sig;
+            results.emplace_back();
+            bool ok = runSize(fname, results.back(), sig);
+            unlink(fname);
+
+            SizeResult &res = results.back();
+            if (not ok)
+            {
+                fprintf(stdout, "N = %10" PRIu64 ": %s (signal %d), sweep ended\n", n, sig == SIGALRM ? "timed out" : "crashed", sig);
+                results.pop_back();
+                break;
+            }
+            if (not res.completed)
+            {
+                fprintf(stdout, "N = %10" PRIu64 ": failed (%s), sweep ended\n", n, res.msg);
+                results.pop_back();
+                break;
+            }
+            fprintf(stdout, "N = %10" PRIu64 ": %10.3f s, peak RSS %8ld KiB\n", n, res.nanos / 1e9, res.peakRssKiB);
+            fflush(stdout);
+            done.push_back(n);
+        }
+    }
+    catch (Exception &e)
+    {
+        fprintf(stderr, "%s: %s\n", progName, e.what());
+        return EXIT_FAILURE;
+    }
+
+    if (done.size() < 2)
+    {
+        fprintf(stdout, "At least two sizes are required to fit the exponents\n");
+        return EXIT_FAILURE;
+    }
+
+    /* the exponents, per function */
+    uint32_t flagged = 0;
+    uint32_t cnt = done.size();
+    fprintf(stdout, "\n");
+    char first[32], last[32];
+    snprintf(first, sizeof(first), "ms, N = %" PRIu64, done[0]);
+    snprintf(last, sizeof(last), "ms, N = %" PRIu64, done[cnt - 1]);
+    fprintf(stdout, "+===============================================================================================================+\n");
+    fprintf(stdout, "| %-30s | %18s | %18s | %8s | %9s | %-10s |\n", "function", first, last, "time exp", "calls exp", "");
+    fprintf(stdout, "+--------------------------------+--------------------+--------------------+----------+-----------+------------+\n");
+    for (uint32_t k = 0; k < ID_COUNT; k++)
+    {
+        uint64_t nanos[MAX_SIZES], calls[MAX_SIZES];
+        const char *name = NULL;
+        for (uint32_t i = 0; i < cnt; i++)
+        {
+            const FunctionResult &f = results[i].fn[k];
+            nanos[i] = f.nanos;
+            calls[i] = f.calls;
+            if (f.calls != 0)
+                name = f.name;
+        }
+        double timeExp, callsExp;
+        if (name == NULL or not fitExponent(done.data(), nanos, cnt, timeExp))
+            continue;
+        if (not fitExponent(done.data(), calls, cnt, callsExp))
+            callsExp = 0;
+
+        bool superlinear = timeExp > 1 + tolerance and nanos[cnt - 1] >= floorNanos;
+        flagged += superlinear ? 1 : 0;
+        fprintf(stdout, "| %3u %-26.26s | %18.3f | %18.3f | %8.2f | %9.2f | %-10s |\n",
+                FIRST_ID + k, name, nanos[0] / 1e6, nanos[cnt - 1] / 1e6, timeExp, callsExp,
+                superlinear ? "SUPERLIN" : "");
+    }
+    fprintf(stdout, "+===============================================================================================================+\n");
+    fprintf(stdout, "%u superlinear function(s)\n\n", flagged);
+
+    return flagged == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,383 @@
+/*
+ *  Consistency checks of the simulator.
+ *
+ *  Runs a generated workload, once per allocation policy and setting,
+ *  in two ways that must end in the same state, and compares the final states:
+ *  the PCT, the swap queue, the memory and the metrics, as printed by their print functions.
+ *  - checkpoint: a run is checkpointed halfway and finished;
+ *    then, with the settings changed, it is restored from the checkpoint and finished again.
+ *  - fork: a run is forked halfway into a branch with the same memory, whose metrics must be
+ *    the ones the run ends with, and into a first fit branch with twice the memory,
+ *    which can always map the active processes again, and must take all the processes to the end.
+ *  - steptime: a run is made an event at a time, with simStep, and a time stamp at a time, with simStepTime.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include "somm23.h"
+#include "workload.h"
+
+/* ******************************************** */
+
+/* an allocation policy under test */
+struct CheckPolicy {
+    const char *name;
+    AllocationPolicy policy;
+};
+
+/* settings a run is made with, besides the policy */
+struct CheckSetting {
+    const char *name;
+    uint32_t lazyWatermark;
+    bool compaction;
+    SimTime fixedCost;
+    SimTime chunkCost;
+};
+
+/* a check: two ways of running a workload, that must end in the same state */
+struct CheckCase {
+    const char *name;
+    bool (*run)(const CheckPolicy &p, const CheckSetting &s, std::string &a, std::string &b);
+};
+
+/* ******************************************** */
+
+static CheckPolicy policies[] = {
+    { "FirstFit",    FirstFit },
+    { "BuddySystem", BuddySystem },
+    { "BuddyForest", BuddyForest },
+    { "Slab",        Slab },
+    { "Tlsf",        Tlsf },
+};
+
+static CheckSetting settings[] = {
+    { "plain",      0, false, 0, 0 },
+    { "lazy:2",     2, false, 0, 0 },
+    { "compact:5,1", 0, true, 5, 1 },
+};
+
+static WorkloadSpec spec;
+static MemSize chunkSize = 0x100;
+static MemSize memSize = 0x40 * 0x100;
+static MemSize osSize = 0x10 * 0x100;
+static uint32_t checkpointStep = 0;
+static char traceName[] = "/tmp/somm23_traceXXXXXX";
+
+/* ******************************************** */
+
+/* apply the given settings, to be kept by the next simInit */
+static void checkSettings(const CheckSetting &s)
+{
+    simSetCompaction(s.compaction, s.fixedCost, s.chunkCost);
+    memLazyMerge(s.lazyWatermark);
+}
+
+/* start a run of the workload */
+static void checkStart(const CheckPolicy &p, const CheckSetting &s)
+{
+    checkSettings(s);
+    simInit(memSize, osSize, chunkSize, p.policy);
+    simLoad(traceName);
+}
+
+/* start a run of the workload, and take it halfway, or to the given step */
+static void checkHalfway(const CheckPolicy &p, const CheckSetting &s)
+{
+    checkStart(p, s);
+    uint32_t step = checkpointStep;
+    if (step == 0)
+    {
+        /* halfway, counted in a run of its own */
+        simRun(0);
+        step = stepCount > 1 ? stepCount / 2 : 1;
+        simTerm();
+        checkStart(p, s);
+    }
+    simRun(step);
+}
+
+/* a temporary file, to print into, as the print functions check for a file descriptor */
+static FILE *checkOpen()
+{
+    FILE *fs = tmpfile();
+    if (fs == NULL)
+        throw Exception(errno, __func__);
+    return fs;
+}
+
+/* what was printed into the given temporary file, which is closed */
+static std::string checkRead(FILE *fs)
+{
+    std::string text;
+    char buf[4096];
+    size_t n;
+    rewind(fs);
+    while ((n = fread(buf, 1, sizeof(buf), fs)) != 0)
+        text.append(buf, n);
+    fclose(fs);
+    return text;
+}
+
+/* the given metrics, as printed */
+static std::string checkMetrics(const SoMetrics &m)
+{
+    FILE *fs = checkOpen();
+    soMetricsSet(&m);
+    soMetricsPrint(fs);
+    return checkRead(fs);
+}
+
+/* the final state of a run, which is ended */
+static std::string checkFinish()
+{
+    FILE *fs = checkOpen();
+    fprintf(fs, "step %u, time %" FMT_TIME "\n", stepCount, simTime);
+    pctPrint(fs);
+    swpPrint(fs);
+    memPrint(fs);
+    soMetricsPrint(fs);
+    std::string state = checkRead(fs);
+
+    simTerm();
+    return state;
+}
+
+/* ******************************************** */
+
+static bool checkCheckpoint(const CheckPolicy &p, const CheckSetting &s, std::string &a, std::string &b)
+{
+    char fname[] = "/tmp/somm23_checkXXXXXX";
+    int fd = mkstemp(fname);
+    if (fd == -1)
+        throw Exception(errno, __func__);
+    close(fd);
+
+    checkHalfway(p, s);
+    simCheckpoint(fname);
+    simRun(0);
+    a = checkFinish();
+
+    /* the settings must come back with the checkpoint */
+    checkSettings(settings[0]);
+    simInit(memSize, osSize, chunkSize, p.policy);
+    simRestore(fname);
+    simRun(0);
+    b = checkFinish();
+
+    unlink(fname);
+    return a == b;
+}
+
+/* a branch runs to the end, and exits, sending its metrics */
+static void checkBranch()
+{
+    try
+    {
+        simRun(0);
+    }
+    catch (Exception &e)
+    {
+        exit(EXIT_FAILURE);
+    }
+    exit(EXIT_SUCCESS);
+}
+
+static bool checkFork(const CheckPolicy &p, const CheckSetting &s, std::string &a, std::string &b)
+{
+    checkHalfway(p, s);
+    pid_t same = simFork(memSize, osSize, chunkSize, p.policy);
+    if (same == 0)
+        checkBranch();
+    pid_t other = simFork(2 * memSize, osSize, chunkSize, FirstFit);
+    if (other == 0)
+        checkBranch();
+    /* with half the memory, the active processes that no longer fit are swapped or discarded */
+    pid_t smaller = simFork(osSize + (memSize - osSize) / 2 / chunkSize * chunkSize, osSize, chunkSize, FirstFit);
+    if (smaller == 0)
+        checkBranch();
+
+    simRun(0);
+    SoMetrics metrics, sameMetrics, otherMetrics, smallerMetrics;
+    soMetricsGet(&metrics);
+    int sameStatus = simJoin(same, &sameMetrics);
+    int otherStatus = simJoin(other, &otherMetrics);
+    int smallerStatus = simJoin(smaller, &smallerMetrics);
+    simTerm();
+
+    a = "status 0\n" + checkMetrics(metrics);
+    b = "status " + std::to_string(sameStatus) + "\n" + checkMetrics(sameMetrics);
+    bool remapped = otherStatus == 0 and otherMetrics.arrived == metrics.arrived
+            and otherMetrics.finished + otherMetrics.discarded == otherMetrics.arrived;
+    if (not remapped)
+        b += "first fit branch with twice the memory: status " + std::to_string(otherStatus) + "\n"
+                + checkMetrics(otherMetrics);
+    bool shrunk = smallerStatus == 0 and smallerMetrics.arrived == metrics.arrived
+            and smallerMetrics.finished + smallerMetrics.discarded == smallerMetrics.arrived;
+    if (not shrunk)
+        b += "first fit branch with half the memory: status " + std::to_string(smallerStatus) + "\n"
+                + checkMetrics(smallerMetrics);
+    return a == b and remapped and shrunk;
+}
+
+static bool checkStepTime(const CheckPolicy &p, const CheckSetting &s, std::string &a, std::string &b)
+{
+    checkStart(p, s);
+    simRun(0);
+    a = checkFinish();
+
+    checkStart(p, s);
+    while (simStepTime())
+        ;
+    b = checkFinish();
+
+    return a == b;
+}
+
+/* ******************************************** */
+
+static CheckCase cases[] = {
+    { "checkpoint", checkCheckpoint },
+    { "fork", checkFork },
+    { "steptime", checkStepTime },
+};
+
+/* ******************************************** */
+
+static void printUsage(const char *cmd_name)
+{
+    printf("Sinopsis: %s [OPTIONS] [case ...]\n"
+           "  Runs a generated workload, once per allocation policy and setting, in two ways\n"
+           "  that must end in the same state, and compares the final states.\n"
+           "  Cases (default: all): checkpoint, fork, steptime\n"
+           "  OPTIONS:\n"
+           "  -n num        --- number of processes of the workload (default: %" PRIu64 ", at most %u)\n"
+           "  -s num        --- seed of the workload (default: %u)\n"
+           "  -a dist       --- time between arrivals (default: poisson:%g)\n"
+           "                    uniform:mean | poisson:mean | bursty:mean,length,gap\n"
+           "  -l dist       --- lifetimes (default: lognormal:%g,%g)\n"
+           "                    lognormal:mu,sigma\n"
+           "  -z dist       --- segment sizes (default: uniform:%" PRIu64 ",%" PRIu64 ")\n"
+           "                    uniform:min,max | zipf:exponent[,min,max,step] | bimodal:split,largeFraction\n"
+           "  -f policy     --- check the given policy only (first, buddy, forest, slab or tlsf)\n"
+           "  -c size       --- chunk size (default: %#" FMT_ADDR ")\n"
+           "  -m size       --- total memory size (default: %#" FMT_ADDR ")\n"
+           "  -k size       --- memory size used by (kernel) OS (default: %#" FMT_ADDR ")\n"
+           "  -S num        --- step of the checkpoint, or fork (default: halfway)\n"
+           "  -v            --- print the final states of the failed checks\n"
+           "  -h            --- print this help\n",
+           cmd_name, spec.count, MAX_PROCESSES, spec.seed, spec.meanGap, spec.lifetimeMu, spec.lifetimeSigma,
+           spec.minSize, spec.maxSize, chunkSize, memSize, osSize);
+}
+
+/* ******************************************** */
+
+int main(int argc, char *argv[])
+{
+    const char *progName = basename(argv[0]);
+
+    workloadDefaults(&spec);
+    const char *policyName = NULL;
+    bool verbose = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:a:l:z:f:c:m:k:S:vh")) != -1)
+    {
+        bool ok = true;
+        switch (opt)
+        {
+            case 'n': spec.count = strtoull(optarg, NULL, 0); ok = spec.count >= 1 and spec.count <= MAX_PROCESSES; break;
+            case 's': spec.seed = strtoul(optarg, NULL, 0); break;
+            case 'a': ok = workloadParseArrivals(&spec, optarg); break;
+            case 'l': ok = workloadParseLifetimes(&spec, optarg); break;
+            case 'z': ok = workloadParseSizes(&spec, optarg); break;
+            case 'f': policyName = strcmp(optarg, "forest") == 0 ? "BuddyForest" : optarg[0] == 'b' ? "BuddySystem" : optarg[0] == 's' ? "Slab" : optarg[0] == 't' ? "Tlsf" : "FirstFit"; break;
+            case 'c': chunkSize = strtoull(optarg, NULL, 0); ok = chunkSize > 0; break;
+            case 'm': memSize = strtoull(optarg, NULL, 0); ok = memSize > 0; break;
+            case 'k': osSize = strtoull(optarg, NULL, 0); ok = osSize > 0; break;
+            case 'S': checkpointStep = strtoul(optarg, NULL, 0); break;
+            case 'v': verbose = true; break;
+            case 'h': printUsage(progName); return EXIT_SUCCESS;
+            default: ok = false; break;
+        }
+        if (not ok)
+        {
+            fprintf(stderr, "%s: Wrong option.\n", progName);
+            printUsage(progName);
+            return EXIT_FAILURE;
+        }
+    }
+    for (int i = optind; i < argc; i++)
+    {
+        bool known = false;
+        for (const CheckCase &c : cases)
+            known = known or strcmp(argv[i], c.name) == 0;
+        if (not known)
+        {
+            fprintf(stderr, "%s: Unknown case \"%s\".\n", progName, argv[i]);
+            printUsage(progName);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* the workload, written into a trace file, so every run loads it as the simulator does */
+    int fd = mkstemp(traceName);
+    FILE *ftrace = fd != -1 ? fdopen(fd, "w") : NULL;
+    if (ftrace == NULL)
+    {
+        fprintf(stderr, "%s: Fail creating the trace file\n", progName);
+        return EXIT_FAILURE;
+    }
+    workloadWrite(spec, ftrace, 1);
+    fclose(ftrace);
+
+    uint32_t failures = 0;
+    for (const CheckCase &c : cases)
+    {
+        bool selected = optind == argc;
+        for (int i = optind; i < argc; i++)
+            selected = selected or strcmp(argv[i], c.name) == 0;
+        if (not selected)
+            continue;
+
+        for (const CheckPolicy &p : policies)
+        {
+            if (policyName != NULL and strcmp(policyName, p.name) != 0)
+                continue;
+            for (const CheckSetting &s : settings)
+            {
+                std::string a, b;
+                bool same = false;
+                try
+                {
+                    same = c.run(p, s, a, b);
+                }
+                catch (Exception &e)
+                {
+                    fprintf(stdout, "%-12s %-12s %-12s FAILED: %s\n", c.name, p.name, s.name, e.what());
+                    failures++;
+                    continue;
+                }
+                fprintf(stdout, "%-12s %-12s %-12s %s\n", c.name, p.name, s.name, same ? "same" : "DIFFERENT");
+                if (not same)
+                {
+                    failures++;
+                    if (verbose)
+                        fprintf(stdout, "---- first run ----\n%s---- second run ----\n%s", a.c_str(), b.c_str());
+                }
+            }
+        }
+    }
+
+    unlink(traceName);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,474 @@
+/*
+ *  End-to-end trace benchmark.
+ *
+ *  Replays every given trace file, and every generated workload, through simRun(0),
+ *  once per allocation policy, with probing off.
+ *  For every run it records the wall time, the events per second, the peak resident set size
+ *  and the number of calls to the allocator, and writes them into a JSON file.
+ *  Given a baseline, in the same format, every run is compared against it,
+ *  and a run slower, or bigger, than the baseline beyond the given tolerances is a regression.
+ *
+ *  The wall time is the best of a number of repetitions; the calls are counted
+ *  in an extra repetition, with profiling on, so they do not add to the time.
+ *  Every run takes place in a child process, so the peak RSS is the one of the run alone.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <glob.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <string>
+#include <vector>
+
+#include "somm23.h"
+#include "workload.h"
+
+/* ******************************************** */
+
+/* an allocation policy under test */
+struct BenchPolicy {
+    const char *name;
+    AllocationPolicy policy;
+};
+
+/* a trace to be replayed: a file, or a generated workload written into a temporary file */
+struct BenchTrace {
+    std::string name;
+    std::string fname;
+    bool generated;
+};
+
+/* result of a run, sent by the child process to the parent through a pipe */
+struct TraceResult {
+    bool completed;             ///< false if an exception was thrown
+    uint32_t processes;         ///< number of processes in the trace
+    uint32_t events;            ///< number of simulation steps
+    uint64_t wallNanos;         ///< best wall time of simRun(0)
+    long peakRssKiB;            ///< peak resident set size, in KiB
+    uint64_t memAlloc;          ///< calls to memAlloc
+    uint64_t memFree;           ///< calls to memFree
+    uint64_t blockAlloc;        ///< calls to the block allocation functions of the policies
+    uint64_t blockFree;         ///< calls to the block release functions of the policies
+    char msg[100];              ///< exception message, if any
+};
+
+/* a result of the baseline */
+struct BaselineEntry {
+    std::string trace;
+    std::string policy;
+    TraceResult res;
+};
+
+/* ******************************************** */
+
+static BenchPolicy policies[] = {
+    { "FirstFit",    FirstFit },
+    { "BuddySystem", BuddySystem },
+    { "BuddyForest", BuddyForest },
+    { "Slab",        Slab },
+    { "Tlsf",        Tlsf },
+};
+
+/* IDs of the block allocation and release functions, summed into blockAlloc and blockFree */
+static const uint32_t blockAllocIDs[] = { 505, 506, 513, 515 };
+static const uint32_t blockFreeIDs[] = { 508, 509, 514, 516 };
+
+static MemSize chunkSize = 0x100;
+static MemSize memSize = 0x1000 * 0x100;
+static MemSize osSize = 0x100 * 0x100;
+static uint32_t repeats = 5;
+static uint32_t timeout = 600;
+static double timeTolerance = 10;
+static double rssTolerance = 10;
+static uint64_t timeFloor = 1000000;
+
+/* ******************************************** */
+/*
+ * Replay the given trace with the given policy, in a child process.
+ * Return false if the child crashed
+ */
+static bool runTrace(const BenchTrace &t, const BenchPolicy &p, TraceResult &res, int &sig)
+{
+    int fd[2];
+    if (pipe(fd) == -1)
+        throw Exception(errno, __func__);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1)
+        throw Exception(errno, __func__);
+
+    if (pid == 0)
+    {
+        close(fd[0]);
+        alarm(timeout);
+        memset(&res, 0, sizeof(res));
+        soBinSetIDs(0, 0);
+        try
+        {
+            res.wallNanos = UINT64_MAX;
+            for (uint32_t i = 0; i <= repeats; i++)
+            {
+                /* the last repetition, with profiling on, only counts the calls */
+                bool counting = i == repeats;
+                if (counting)
+                {
+                    soProfileReset();
+                    soProfileOpen(NULL);
+                }
+                simInit(memSize, osSize, chunkSize, p.policy);
+                simLoad(t.fname.c_str());
+                res.processes = forthcomingTable.count;
+                uint64_t start = soProfileNow();
+                simRun(0);
+                uint64_t nanos = soProfileNow() - start;
+                res.events = stepCount;
+                simTerm();
+                if (not counting and nanos < res.wallNanos)
+                    res.wallNanos = nanos;
+            }
+            soProfileClose();
+
+            SoProfileStats stats;
+            res.memAlloc = soProfileGet(504, &stats) ? stats.calls : 0;
+            res.memFree = soProfileGet(507, &stats) ? stats.calls : 0;
+            for (uint32_t id : blockAllocIDs)
+                res.blockAlloc += soProfileGet(id, &stats) ? stats.calls : 0;
+            for (uint32_t id : blockFreeIDs)
+                res.blockFree += soProfileGet(id, &stats) ? stats.calls : 0;
+            res.completed = true;
+        }
+        catch (Exception &e)
+        {
+            snprintf(res.msg, sizeof(res.msg), "%s: error %d", e.func, e.en);
+        }
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        res.peakRssKiB = usage.ru_maxrss;
+        if (write(fd[1], &res, sizeof(res)) != sizeof(res))
+            _exit(EXIT_FAILURE);
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fd[1]);
+    ssize_t cnt = 0, n;
+    while (cnt < (ssize_t)sizeof(res) and (n = read(fd[0], (char *)&res + cnt, sizeof(res) - cnt)) > 0)
+        cnt += n;
+    close(fd[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    sig = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    return cnt == sizeof(res);
+}
+
+/* ******************************************** */
+/* JSON, one result per line, which is what the baseline reader relies on */
+
+static void jsonString(FILE *fout, const char *s)
+{
+    fputc('"', fout);
+    for (; *s != '\0'; s++)
+    {
+        if (*s == '"' or *s == '\\')
+            fputc('\\', fout);
+        fputc(*s, fout);
+    }
+    fputc('"', fout);
+}
+
+/* value of the given string key in the given line, or false if not there */
+static bool jsonGetString(const char *line, const char *key, std::string &value)
+{
+    std::string pattern = std::string("\"") + key + "\": \"";
+    const char *p = strstr(line, pattern.c_str());
+    if (p == NULL)
+        return false;
+    value.clear();
+    for (p += pattern.size(); *p != '"'; p++)
+    {
+        if (*p == '\\')
+            p++;
+        if (*p == '\0')
+            return false;
+        value += *p;
+    }
+    return true;
+}
+
+/* value of the given numeric key in the given line, or 0 if not there */
+static uint64_t jsonGetNumber(const char *line, const char *key)
+{
+    std::string pattern = std::string("\"") + key + "\": ";
+    const char *p = strstr(line, pattern.c_str());
+    return p != NULL ? strtoull(p + pattern.size(), NULL, 10) : 0;
+}
+
+static void jsonWrite(FILE *fout, const char *trace, const char *policy, const TraceResult &res, bool first)
+{
+    fprintf(fout, "%s    {\"trace\": ", first ? "" : ",\n");
+    jsonString(fout, trace);
+    fprintf(fout, ", \"policy\": ");
+    jsonString(fout, policy);
+    fprintf(fout, ", \"completed\": %s, \"processes\": %u, \"events\": %u, \"wallNanos\": %" PRIu64
+            ", \"eventsPerSec\": %.0f, \"peakRssKiB\": %ld, \"memAlloc\": %" PRIu64 ", \"memFree\": %" PRIu64
+            ", \"blockAlloc\": %" PRIu64 ", \"blockFree\": %" PRIu64 "}",
+            res.completed ? "true" : "false", res.processes, res.events, res.wallNanos,
+            res.events * 1e9 / (res.wallNanos != 0 ? res.wallNanos : 1), res.peakRssKiB,
+            res.memAlloc, res.memFree, res.blockAlloc, res.blockFree);
+}
+
+static void jsonRead(const char *fname, std::vector<BaselineEntry> &baseline)
+{
+    FILE *fin = fopen(fname, "r");
+    if (fin == NULL)
+        throw Exception(errno, __func__);
+
+    char line[1024];
+    while (fgets(line, sizeof(line), fin) != NULL)
+    {
+        BaselineEntry e;
+        if (not jsonGetString(line, "trace", e.trace) or not jsonGetString(line, "policy", e.policy))
+            continue;
+        memset(&e.res, 0, sizeof(e.res));
+        e.res.completed = strstr(line, "\"completed\": true") != NULL;
+        e.res.processes = jsonGetNumber(line, "processes");
+        e.res.events = jsonGetNumber(line, "events");
+        e.res.wallNanos = jsonGetNumber(line, "wallNanos");
+        e.res.peakRssKiB = jsonGetNumber(line, "peakRssKiB");
+        e.res.memAlloc = jsonGetNumber(line, "memAlloc");
+        e.res.memFree = jsonGetNumber(line, "memFree");
+        e.res.blockAlloc = jsonGetNumber(line, "blockAlloc");
+        e.res.blockFree = jsonGetNumber(line, "blockFree");
+        baseline.push_back(e);
+    }
+    fclose(fin);
+}
+
+/* ******************************************** */
+/*
+ * Compare a result against its baseline, writing the verdict into the given buffer.
+ * Return false on a regression
+ */
+static bool compare(const TraceResult &res, const TraceResult *base, char *verdict, size_t size)
+{
+    if (base == NULL)
+    {
+        snprintf(verdict, size, "no baseline");
+        return true;
+    }
+    if (not base->completed)
+    {
+        snprintf(verdict, size, "baseline failed");
+        return true;
+    }
+
+    double dt = 100.0 * ((double)res.wallNanos - base->wallNanos) / (base->wallNanos != 0 ? base->wallNanos : 1);
+    double dm = 100.0 * ((double)res.peakRssKiB - base->peakRssKiB) / (base->peakRssKiB != 0 ? base->peakRssKiB : 1);
+
+    /* runs shorter than the floor are too noisy to be judged by their time */
+    bool slower = dt > timeTolerance and base->wallNanos >= timeFloor;
+    bool bigger = dm > rssTolerance;
+    bool changed = res.events != base->events or res.memAlloc != base->memAlloc or res.memFree != base->memFree;
+
+    snprintf(verdict, size, "%+6.1f%% time %+6.1f%% RSS%s%s%s", dt, dm,
+             slower ? " SLOWER" : "", bigger ? " BIGGER" : "", changed ? " (calls changed)" : "");
+    return not slower and not bigger;
+}
+
+/* ******************************************** */
+
+static void printUsage(const char *cmd_name)
+{
+    printf("Sinopsis: %s [OPTIONS] [trace ...]\n"
+           "  Replays the given traces (default: examples/*.txt) through simRun(0), once per allocation policy,\n"
+           "  recording wall time, events/s, peak RSS and allocator calls, optionally against a baseline.\n"
+           "  OPTIONS:\n"
+           "  -g num        --- add a generated workload of num processes (at most %u)\n"
+           "  -s num        --- seed of the generated workloads (default: 1)\n"
+           "  -f policy     --- replay with the given policy only (first, buddy, forest, slab or tlsf)\n"
+           "  -c size       --- chunk size (default: %#" FMT_ADDR ")\n"
+           "  -m size       --- total memory size (default: %#" FMT_ADDR ")\n"
+           "  -k size       --- memory size used by (kernel) OS (default: %#" FMT_ADDR ")\n"
+           "  -r num        --- number of timed repetitions, the best one being kept (default: %u)\n"
+           "  -o outfile    --- write the results, in JSON, into the given file\n"
+           "  -B infile     --- compare the results against the given baseline, written by -o\n"
+           "  -T percent    --- time tolerance, before a run is a regression (default: %g)\n"
+           "  -M percent    --- peak RSS tolerance, before a run is a regression (default: %g)\n"
+           "  -F nanos      --- baseline runs shorter than this are not judged by time (default: %" PRIu64 ")\n"
+           "  -t secs       --- timeout of every run (default: %u)\n"
+           "  -h            --- print this help\n",
+           cmd_name, MAX_PROCESSES, chunkSize, memSize, osSize, repeats, timeTolerance, rssTolerance, timeFloor, timeout);
+}
+
+/* ******************************************** */
+
+int main(int argc, char *argv[])
+{
+    const char *progName = basename(argv[0]);
+
+    WorkloadSpec spec;
+    workloadDefaults(&spec);
+    std::vector<uint32_t> generated;
+    const char *policyName = NULL;
+    const char *outfile = NULL;
+    const char *basefile = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "g:s:f:c:m:k:r:o:B:T:M:F:t:h")) != -1)
+    {
+        bool ok = true;
+        switch (opt)
+        {
+            case 'g':
+            {
+                uint32_t n = atoi(optarg);
+                ok = n >= 1 and n <= MAX_PROCESSES;
+                generated.push_back(n);
+                break;
+            }
+            case 's': spec.seed = strtoul(optarg, NULL, 0); break;
+            case 'f': policyName = strcmp(optarg, "forest") == 0 ? "BuddyForest" : optarg[0] == 'b' ? "BuddySystem" : optarg[0] == 's' ? "Slab" : optarg[0] == 't' ? "Tlsf" : "FirstFit"; break;
+            case 'c': chunkSize = strtoull(optarg, NULL, 0); ok = chunkSize > 0; break;
+            case 'm': memSize = strtoull(optarg, NULL, 0); ok = memSize > 0; break;
+            case 'k': osSize = strtoull(optarg, NULL, 0); ok = osSize > 0; break;
+            case 'r': repeats = atoi(optarg); ok = repeats >= 1; break;
+            case 'o': outfile = optarg; break;
+            case 'B': basefile = optarg; break;
+            case 'T': timeTolerance = atof(optarg); ok = timeTolerance >= 0; break;
+            case 'M': rssTolerance = atof(optarg); ok = rssTolerance >= 0; break;
+            case 'F': timeFloor = strtoull(optarg, NULL, 0); break;
+            case 't': timeout = atoi(optarg); break;
+            case 'h': printUsage(progName); return EXIT_SUCCESS;
+            default: ok = false; break;
+        }
+        if (not ok)
+        {
+            fprintf(stderr, "%s: Wrong option.\n", progName);
+            printUsage(progName);
+            return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        /* the traces */
+        std::vector<BenchTrace> traces;
+        if (optind == argc and generated.empty())
+        {
+            glob_t g;
+            if (glob("examples/*.txt", 0, NULL, &g) == 0)
+            {
+                for (size_t i = 0; i < g.gl_pathc; i++)
+                    traces.push_back({ g.gl_pathv[i], g.gl_pathv[i], false });
+                globfree(&g);
+            }
+        }
+        for (int i = optind; i < argc; i++)
+            traces.push_back({ argv[i], argv[i], false });
+        for (uint32_t n : generated)
+        {
+            char fname[] = "/tmp/somm23_traceXXXXXX";
+            int fd = mkstemp(fname);
+            FILE *fout = fd != -1 ? fdopen(fd, "w") : NULL;
+            if (fout == NULL)
+                throw Exception(errno, __func__);
+            WorkloadSpec s = spec;
+            s.count = n;
+            workloadWrite(s, fout, 1);
+            fclose(fout);
+            char name[64];
+            snprintf(name, sizeof(name), "generated:%u:seed%u", n, spec.seed);
+            traces.push_back({ name, fname, true });
+        }
+        if (traces.empty())
+        {
+            fprintf(stderr, "%s: No traces to replay.\n", progName);
+            return EXIT_FAILURE;
+        }
+
+        std::vector<BaselineEntry> baseline;
+        if (basefile != NULL)
+            jsonRead(basefile, baseline);
+
+        FILE *fout = NULL;
+        if (outfile != NULL and (fout = fopen(outfile, "w")) == NULL)
+        {
+            fprintf(stderr, "%s: Fail opening output file \"%s\"\n", progName, outfile);
+            return EXIT_FAILURE;
+        }
+        if (fout != NULL)
+            fprintf(fout, "{\n  \"results\": [\n");
+
+        uint32_t failures = 0;
+        fprintf(stdout, "+=======================================================================================================================================+\n");
+        fprintf(stdout, "| %-24s %-12s %10s  %12s  %10s  %10s  %-45s |\n", "trace", "policy", "events", "events/s", "wall (us)", "RSS (KiB)", "vs baseline");
+        fprintf(stdout, "+=======================================================================================================================================+\n");
+
+        bool first = true;
+        for (const BenchTrace &t : traces)
+        {
+            for (const BenchPolicy &p : policies)
+            {
+                if (policyName != NULL and strcmp(policyName, p.name) != 0)
+                    continue;
+
+                TraceResult res;
+                int sig;
+                char verdict[128];
+                bool ok = runTrace(t, p, res, sig);
+                if (not ok)
+                {
+                    snprintf(verdict, sizeof(verdict), "crashed (signal %d)", sig);
+                    memset(&res, 0, sizeof(res));
+                }
+                else if (not res.completed)
+                {
+                    snprintf(verdict, sizeof(verdict), "failed (%s)", res.msg);
+                    ok = false;
+                }
+                else
+                {
+                    const TraceResult *base = NULL;
+                    for (const BaselineEntry &e : baseline)
+                        if (e.trace == t.name and e.policy == p.name)
+                            base = &e.res;
+                    ok = compare(res, base, verdict, sizeof(verdict));
+                }
+                failures += ok ? 0 : 1;
+
+                fprintf(stdout, "| %-24.24s %-12s %10u  %12.0f  %10.1f  %10ld  %-45.45s |\n",
+                        t.name.c_str(), p.name, res.events, res.events * 1e9 / (res.wallNanos != 0 ? res.wallNanos : 1),
+                        res.wallNanos / 1e3, res.peakRssKiB, verdict);
+                if (fout != NULL)
+                    jsonWrite(fout, t.name.c_str(), p.name, res, first);
+                first = false;
+            }
+        }
+        fprintf(stdout, "+=======================================================================================================================================+\n");
+
+        if (fout != NULL)
+        {
+            fprintf(fout, "\n  ]\n}\n");
+            fclose(fout);
+        }
+        for (const BenchTrace &t : traces)
+            if (t.generated)
+                unlink(t.fname.c_str());
+
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (Exception &e)
+    {
+        fprintf(stderr, "%s: %s\n", progName, e.what());
+        return EXIT_FAILURE;
+    }
+}
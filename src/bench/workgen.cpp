@@ -0,0 +1,97 @@
+/*
+ *  Synthetic workload generator, writing trace files in the format read by simLoad.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+
+#include <thread>
+
+#include "workload.h"
+
+/* ******************************************** */
+
+static void printUsage(const char *cmd_name, const WorkloadSpec &spec, uint32_t threads)
+{
+    printf("Sinopsis: %s [OPTIONS]\n"
+           "  Generates a synthetic workload, with distinct PIDs, in the trace file format.\n"
+           "  OPTIONS:\n"
+           "  -n num        --- number of processes (default: %llu)\n"
+           "  -s num        --- seed of the generator (default: %u)\n"
+           "  -a dist       --- time between arrivals (default: poisson:%g)\n"
+           "                    uniform:mean | poisson:mean | bursty:mean,length,gap\n"
+           "  -l dist       --- lifetimes (default: lognormal:%g,%g)\n"
+           "                    lognormal:mu,sigma\n"
+           "  -z dist       --- segment sizes (default: uniform:%llu,%llu)\n"
+           "                    uniform:min,max | zipf:exponent[,min,max,step] | bimodal:split,largeFraction\n"
+           "  -g num        --- maximum number of segments per process (default: %u)\n"
+           "  -j num        --- number of threads (default: %u)\n"
+           "  -o outfile    --- set output file (default: stdout)\n"
+           "  -h            --- print this help\n",
+           cmd_name, (unsigned long long)spec.count, spec.seed, spec.meanGap, spec.lifetimeMu, spec.lifetimeSigma,
+           (unsigned long long)spec.minSize, (unsigned long long)spec.maxSize, spec.maxSegments, threads);
+}
+
+/* ******************************************** */
+
+int main(int argc, char *argv[])
+{
+    const char *progName = basename(argv[0]);
+
+    WorkloadSpec spec;
+    workloadDefaults(&spec);
+    uint32_t threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    FILE *fout = stdout;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:a:l:z:g:j:o:h")) != -1)
+    {
+        bool ok = true;
+        switch (opt)
+        {
+            case 'n': spec.count = strtoull(optarg, NULL, 0); break;
+            case 's': spec.seed = strtoul(optarg, NULL, 0); break;
+            case 'a': ok = workloadParseArrivals(&spec, optarg); break;
+            case 'l': ok = workloadParseLifetimes(&spec, optarg); break;
+            case 'z': ok = workloadParseSizes(&spec, optarg); break;
+            case 'g': spec.maxSegments = atoi(optarg); ok = spec.maxSegments >= 1 and spec.maxSegments <= MAX_SEGMENTS; break;
+            case 'j': threads = atoi(optarg); ok = threads >= 1; break;
+            case 'o':
+                if ((fout = fopen(optarg, "w")) == NULL)
+                {
+                    fprintf(stderr, "%s: Fail opening output file \"%s\"\n", progName, optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'h': printUsage(progName, spec, threads); return EXIT_SUCCESS;
+            default: ok = false; break;
+        }
+        if (not ok)
+        {
+            fprintf(stderr, "%s: Wrong option.\n", progName);
+            printUsage(progName, spec, threads);
+            return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        workloadWrite(spec, fout, threads);
+    }
+    catch (Exception &e)
+    {
+        fprintf(stderr, "%s: %s\n", progName, e.what());
+        return EXIT_FAILURE;
+    }
+
+    if (fout != stdout)
+        fclose(fout);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,385 @@
+/*
+ *  Synthetic workload generator.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "workload.h"
+
+/* ******************************************** */
+
+/* number of processes generated by a thread at a time */
+#define WORKLOAD_CHUNK (1u << 16)
+
+/* largest number of distinct Zipf sizes */
+#define WORKLOAD_ZIPF_SIZES (1u << 16)
+
+/* ******************************************** */
+/* counter based generator: every process has its own stream, taken from the seed and its index */
+
+static inline uint64_t mix(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+struct Stream {
+    uint64_t state;
+
+    Stream(uint32_t seed, uint64_t index, uint32_t purpose)
+    {
+        state = mix(mix(((uint64_t)seed << 32) | purpose) ^ index);
+    }
+
+    uint64_t next()
+    {
+        state += 0x9E3779B97F4A7C15ull;
+        return mix(state);
+    }
+
+    /* uniform in [0, 1) */
+    double uniform()
+    {
+        return (next() >> 11) * 0x1.0p-53;
+    }
+
+    /* uniform in [lo, hi] */
+    uint64_t range(uint64_t lo, uint64_t hi)
+    {
+        return lo + next() % (hi - lo + 1);
+    }
+
+    double exponential(double mean)
+    {
+        return -mean * log(1.0 - uniform());
+    }
+
+    double normal()
+    {
+        double u1 = 1.0 - uniform();
+        double u2 = uniform();
+        return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    }
+};
+
+/* purposes of the streams of a process */
+enum { ArrivalStream = 1, LifetimeStream, SizeStream };
+
+/* ******************************************** */
+/* distinct PIDs: a keyed Feistel permutation of [0, 2^bits), cycle-walked into [0, domain) */
+
+static uint32_t permute(uint32_t seed, uint64_t index, uint64_t domain)
+{
+    uint32_t bits = 2;
+    while ((1ull << bits) < domain)
+        bits += 2;
+    uint32_t half = bits / 2;
+    uint64_t mask = (1ull << half) - 1;
+
+    uint64_t x = index;
+    do
+    {
+        uint64_t left = x >> half, right = x & mask;
+        for (uint32_t round = 0; round < 4; round++)
+        {
+            uint64_t f = mix(right ^ ((uint64_t)seed << 8) ^ round) & mask;
+            uint64_t t = left ^ f;
+            left = right;
+            right = t;
+        }
+        x = (left << half) | right;
+    } while (x >= domain);
+
+    return (uint32_t)x;
+}
+
+/* ******************************************** */
+/* cumulative distribution of the Zipf sizes, built once per generated chunk (it is small for other distributions) */
+
+struct ZipfTable {
+    uint64_t step;
+    std::vector<double> cdf;
+
+    ZipfTable(const WorkloadSpec &spec)
+    {
+        step = spec.sizeStep != 0 ? spec.sizeStep : 1;
+        uint64_t k = (spec.maxSize - spec.minSize) / step + 1;
+        if (k > WORKLOAD_ZIPF_SIZES)
+        {
+            step = (spec.maxSize - spec.minSize + WORKLOAD_ZIPF_SIZES - 2) / (WORKLOAD_ZIPF_SIZES - 1);
+            k = (spec.maxSize - spec.minSize) / step + 1;
+        }
+        cdf.resize(k);
+        double sum = 0;
+        for (uint64_t r = 0; r < k; r++)
+        {
+            sum += 1.0 / pow(r + 1, spec.zipfExponent);
+            cdf[r] = sum;
+        }
+        for (uint64_t r = 0; r < k; r++)
+            cdf[r] /= sum;
+    }
+
+    uint64_t sample(const WorkloadSpec &spec, Stream &s) const
+    {
+        uint64_t r = std::lower_bound(cdf.begin(), cdf.end(), s.uniform()) - cdf.begin();
+        if (r == cdf.size())
+            r--;
+        return spec.minSize + r * step;
+    }
+};
+
+/* ******************************************** */
+
+void workloadDefaults(WorkloadSpec *spec)
+{
+    memset(spec, 0, sizeof(*spec));
+    spec->count = 100;
+    spec->seed = 1;
+    spec->arrivals = PoissonArrivals;
+    spec->meanGap = 50;
+    spec->burstLength = 10;
+    spec->burstGap = 1;
+    spec->lifetimeMu = 5.8;
+    spec->lifetimeSigma = 0.8;
+    spec->maxSegments = MAX_SEGMENTS;
+    spec->sizes = UniformSizes;
+    spec->minSize = 0x100;
+    spec->maxSize = 0x800;
+    spec->sizeStep = 0x100;
+    spec->zipfExponent = 1.0;
+    spec->splitSize = 0x400;
+    spec->largeFraction = 0.2;
+}
+
+/* ******************************************** */
+
+/* true if the whole argument was consumed by a sscanf whose %n went into n */
+static inline bool consumed(const char *arg, int n)
+{
+    return n > 0 and arg[n] == '\0';
+}
+
+bool workloadParseArrivals(WorkloadSpec *spec, const char *arg)
+{
+    int n = 0;
+    if (sscanf(arg, "uniform:%lf%n", &spec->meanGap, &n) == 1 and consumed(arg, n))
+        spec->arrivals = UniformArrivals;
+    else if (sscanf(arg, "poisson:%lf%n", &spec->meanGap, &n) == 1 and consumed(arg, n))
+        spec->arrivals = PoissonArrivals;
+    else if (sscanf(arg, "bursty:%lf,%u,%lf%n", &spec->meanGap, &spec->burstLength, &spec->burstGap, &n) == 3
+            and consumed(arg, n) and spec->burstLength > 0)
+        spec->arrivals = BurstyArrivals;
+    else
+        return false;
+    return spec->meanGap >= 0 and spec->burstGap >= 0;
+}
+
+bool workloadParseLifetimes(WorkloadSpec *spec, const char *arg)
+{
+    int n = 0;
+    return sscanf(arg, "lognormal:%lf,%lf%n", &spec->lifetimeMu, &spec->lifetimeSigma, &n) == 2
+        and consumed(arg, n) and spec->lifetimeSigma >= 0;
+}
+
+bool workloadParseSizes(WorkloadSpec *spec, const char *arg)
+{
+    unsigned long long a, b, c;
+    int n = 0;
+    if (sscanf(arg, "uniform:%llu,%llu%n", &a, &b, &n) == 2 and consumed(arg, n))
+    {
+        spec->sizes = UniformSizes;
+        spec->minSize = a;
+        spec->maxSize = b;
+    }
+    else if (sscanf(arg, "zipf:%lf,%llu,%llu,%llu%n", &spec->zipfExponent, &a, &b, &c, &n) == 4 and consumed(arg, n))
+    {
+        spec->sizes = ZipfSizes;
+        spec->minSize = a;
+        spec->maxSize = b;
+        spec->sizeStep = c;
+    }
+    else if ((n = 0, sscanf(arg, "zipf:%lf%n", &spec->zipfExponent, &n) == 1) and consumed(arg, n))
+        spec->sizes = ZipfSizes;
+    else if (sscanf(arg, "bimodal:%llu,%lf%n", &a, &spec->largeFraction, &n) == 2 and consumed(arg, n))
+    {
+        spec->sizes = BimodalSizes;
+        spec->splitSize = a;
+    }
+    else
+        return false;
+    return spec->minSize > 0 and spec->minSize <= spec->maxSize and spec->sizeStep > 0
+        and (spec->sizes != BimodalSizes or (spec->splitSize > spec->minSize and spec->splitSize <= spec->maxSize));
+}
+
+/* ******************************************** */
+
+void workloadGenerate(const WorkloadSpec &spec, uint64_t first, uint64_t n, WorkloadProcess *out)
+{
+    ZipfTable zipf(spec);
+    uint64_t domain = spec.count <= 65535 ? 65535 : UINT32_MAX;
+    uint32_t maxSegments = std::min(std::max(spec.maxSegments, 1u), (uint32_t)MAX_SEGMENTS);
+
+    uint64_t arrival = 0;
+    for (uint64_t k = 0; k < n; k++)
+    {
+        uint64_t i = first + k;
+        WorkloadProcess &p = out[k];
+
+        p.pid = permute(spec.seed, i, domain) + 1;
+
+        Stream a(spec.seed, i, ArrivalStream);
+        double gap;
+        switch (spec.arrivals)
+        {
+            case UniformArrivals: gap = a.uniform() * (2 * spec.meanGap + 1); break;
+            case PoissonArrivals: gap = a.exponential(spec.meanGap); break;
+            default: gap = a.exponential(i % spec.burstLength == 0 ? spec.meanGap : spec.burstGap); break;
+        }
+        arrival += (uint64_t)gap;
+        p.arrivalTime = arrival;
+
+        Stream l(spec.seed, i, LifetimeStream);
+        double lifetime = exp(spec.lifetimeMu + spec.lifetimeSigma * l.normal());
+        p.lifetime = lifetime < 1 ? 1 : (uint64_t)lifetime;
+
+        Stream s(spec.seed, i, SizeStream);
+        p.segmentCount = s.range(1, maxSegments);
+        for (uint32_t j = 0; j < MAX_SEGMENTS; j++)
+        {
+            if (j >= p.segmentCount)
+                p.size[j] = 0;
+            else if (spec.sizes == ZipfSizes)
+                p.size[j] = zipf.sample(spec, s);
+            else if (spec.sizes == BimodalSizes and s.uniform() < spec.largeFraction)
+                p.size[j] = s.range(spec.splitSize, spec.maxSize);
+            else if (spec.sizes == BimodalSizes)
+                p.size[j] = s.range(spec.minSize, spec.splitSize - 1);
+            else
+                p.size[j] = s.range(spec.minSize, spec.maxSize);
+        }
+    }
+}
+
+/* ******************************************** */
+
+static void workloadFormat(const WorkloadProcess *procs, uint64_t n, uint64_t base, std::string &text)
+{
+    char line[64 + 24 * MAX_SEGMENTS];
+    text.clear();
+    for (uint64_t k = 0; k < n; k++)
+    {
+        const WorkloadProcess &p = procs[k];
+        int len = snprintf(line, sizeof(line), "%u;%llu;%llu;", p.pid,
+                (unsigned long long)(base + p.arrivalTime), (unsigned long long)p.lifetime);
+        for (uint32_t j = 0; j < p.segmentCount; j++)
+            len += snprintf(line + len, sizeof(line) - len, j == 0 ? "%llu" : ",%llu", (unsigned long long)p.size[j]);
+        line[len++] = '\n';
+        text.append(line, len);
+    }
+}
+
+/* run work(t), for every t in [0, used), each in its own thread */
+template <typename Work>
+static void workloadParallel(uint32_t used, Work work)
+{
+    std::vector<std::thread> workers;
+    for (uint32_t t = 1; t < used; t++)
+        workers.emplace_back(work, t);
+    work(0);
+    for (std::thread &w : workers)
+        w.join();
+}
+
+uint64_t workloadWrite(const WorkloadSpec &spec, FILE *fout, uint32_t threads)
+{
+    if (threads == 0)
+        threads = 1;
+
+    std::vector<std::vector<WorkloadProcess>> procs(threads, std::vector<WorkloadProcess>(WORKLOAD_CHUNK));
+    std::vector<std::string> text(threads);
+    std::vector<uint64_t> first(threads), count(threads), base(threads);
+
+    fprintf(fout, "%% %llu processes, seed %u\n", (unsigned long long)spec.count, spec.seed);
+
+    /* every batch is a chunk per thread: generate in parallel, chain the arrival times, format in parallel */
+    uint64_t arrival = 0;
+    for (uint64_t next = 0; next < spec.count; )
+    {
+        uint32_t used = 0;
+        for (; used < threads and next < spec.count; used++)
+        {
+            first[used] = next;
+            count[used] = std::min<uint64_t>(WORKLOAD_CHUNK, spec.count - next);
+            next += count[used];
+        }
+
+        workloadParallel(used, [&](uint32_t t) {
+            workloadGenerate(spec, first[t], count[t], procs[t].data());
+        });
+
+        for (uint32_t t = 0; t < used; t++)
+        {
+            base[t] = arrival;
+            arrival += procs[t][count[t] - 1].arrivalTime;
+        }
+
+        workloadParallel(used, [&](uint32_t t) {
+            workloadFormat(procs[t].data(), count[t], base[t], text[t]);
+        });
+
+        for (uint32_t t = 0; t < used; t++)
+        {
+            if (fwrite(text[t].data(), 1, text[t].size(), fout) != text[t].size())
+                throw Exception(errno, __func__);
+        }
+    }
+
+    return arrival;
+}
+
+/* ******************************************** */
+
+uint32_t workloadFill(const WorkloadSpec &spec)
+{
+    require(forthcomingTable.count == 0, "Forthcoming table should be empty");
+
+    uint32_t n = std::min<uint64_t>(spec.count, MAX_PROCESSES);
+
+    /* in chunks, as MAX_PROCESSES may be redefined far beyond what fits in the stack */
+    std::vector<WorkloadProcess> procs(WORKLOAD_CHUNK);
+    uint64_t base = 0;
+    for (uint32_t first = 0; first < n; first += WORKLOAD_CHUNK)
+    {
+        uint32_t cnt = std::min<uint32_t>(n - first, WORKLOAD_CHUNK);
+        workloadGenerate(spec, first, cnt, procs.data());
+        for (uint32_t i = 0; i < cnt; i++)
+        {
+            ForthcomingProcess &p = forthcomingTable.process[first + i];
+            p.pid = procs[i].pid;
+            p.arrivalTime = base + procs[i].arrivalTime;
+            p.lifetime = procs[i].lifetime;
+            p.addressSpace.segmentCount = procs[i].segmentCount;
+            for (uint32_t j = 0; j < MAX_SEGMENTS; j++)
+                p.addressSpace.size[j] = procs[i].size[j];
+        }
+        base += procs[cnt - 1].arrivalTime;
+    }
+    forthcomingTable.count = n;
+
+    return n;
+}
+
+/* ******************************************** */
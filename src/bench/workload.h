@@ -0,0 +1,123 @@
+/*
+ *  Synthetic workload generator.
+ *
+ *  Generates processes with configurable distributions of arrivals, lifetimes
+ *  and segment sizes, either into a trace file, in the format read by simLoad,
+ *  or into the forthcoming table.
+ *
+ *  Every process is generated from its own index and the seed only,
+ *  so a workload is the same whatever the number of threads or chunks it is generated in.
+ *  PIDs are a keyed permutation of the indices, so they are distinct by construction.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#ifndef __SOMM23_BENCH_WORKLOAD__
+#define __SOMM23_BENCH_WORKLOAD__
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "somm23.h"
+
+/* ******************************************** */
+
+/**
+ * \brief Distributions of the time between arrivals
+ */
+enum WorkloadArrivals {
+    UniformArrivals,    ///< uniform in [0, 2 * meanGap]
+    PoissonArrivals,    ///< exponential gaps, with mean meanGap
+    BurstyArrivals      ///< bursts of burstLength processes, burstGap apart, separated by idle periods of mean meanGap
+};
+
+/**
+ * \brief Distributions of the segment sizes
+ */
+enum WorkloadSizes {
+    UniformSizes,       ///< uniform in [minSize, maxSize]
+    ZipfSizes,          ///< Zipf over the multiples of sizeStep in [minSize, maxSize], smaller sizes more likely
+    BimodalSizes        ///< uniform in [minSize, splitSize) or, with probability largeFraction, in [splitSize, maxSize]
+};
+
+/**
+ * \brief Description of a workload
+ */
+struct WorkloadSpec {
+    uint64_t count;             ///< number of processes
+    uint32_t seed;              ///< seed of the generator
+
+    WorkloadArrivals arrivals;  ///< distribution of the time between arrivals
+    double meanGap;             ///< mean time between arrivals, or between bursts
+    uint32_t burstLength;       ///< number of processes per burst
+    double burstGap;            ///< mean time between arrivals within a burst
+
+    double lifetimeMu;          ///< lifetimes are lognormal, exp(mu + sigma * N(0, 1)), at least 1
+    double lifetimeSigma;       ///< see lifetimeMu
+
+    uint32_t maxSegments;       ///< segments per process are uniform in [1, maxSegments]
+    WorkloadSizes sizes;        ///< distribution of the segment sizes
+    uint64_t minSize;           ///< smallest segment size
+    uint64_t maxSize;           ///< largest segment size
+    uint64_t sizeStep;          ///< granularity of the Zipf sizes
+    double zipfExponent;        ///< exponent of the Zipf distribution
+    uint64_t splitSize;         ///< boundary between the small and large bimodal sizes
+    double largeFraction;       ///< probability of a large bimodal size
+};
+
+/**
+ * \brief A generated process
+ * \details Times are 64-bit, as a large workload may go beyond a 32-bit simulation time.
+ */
+struct WorkloadProcess {
+    uint32_t pid;               ///< distinct PID, in [1, 65535] for up to 65535 processes
+    uint64_t arrivalTime;       ///< arrival time
+    uint64_t lifetime;          ///< lifetime
+    uint32_t segmentCount;      ///< number of segments
+    uint64_t size[MAX_SEGMENTS];///< segment sizes
+};
+
+/* ******************************************** */
+
+/**
+ * \brief Set the given spec to the defaults,
+ *   which approach the ones of simRandomFill with Poisson arrivals and lognormal lifetimes
+ */
+void workloadDefaults(WorkloadSpec *spec);
+
+/**
+ * \brief Parse a distribution option, like "poisson:50" or "zipf:1.2", into the given spec
+ * \return \c false if the option is not valid
+ */
+bool workloadParseArrivals(WorkloadSpec *spec, const char *arg);
+bool workloadParseLifetimes(WorkloadSpec *spec, const char *arg);
+bool workloadParseSizes(WorkloadSpec *spec, const char *arg);
+
+/**
+ * \brief Generate processes [first, first + n) of the workload
+ * \details Arrival times are relative to the arrival of process \c first,
+ *   which is the gap before it.
+ * \param [in] spec the workload
+ * \param [in] first index of the first process
+ * \param [in] n number of processes
+ * \param [out] out array of n processes
+ */
+void workloadGenerate(const WorkloadSpec &spec, uint64_t first, uint64_t n, WorkloadProcess *out);
+
+/**
+ * \brief Write the whole workload into the given stream, in the trace file format,
+ *   generating it in chunks, in parallel, with the given number of threads
+ * \return the arrival time of the last process
+ */
+uint64_t workloadWrite(const WorkloadSpec &spec, FILE *fout, uint32_t threads);
+
+/**
+ * \brief Fill the forthcoming table with the first processes of the workload
+ * \details At most \c MAX_PROCESSES processes fit into the table.
+ * \return the number of processes put into the table
+ */
+uint32_t workloadFill(const WorkloadSpec &spec);
+
+/* ******************************************** */
+
+#endif /* __SOMM23_BENCH_WORKLOAD__ */
@@ -13,11 +13,17 @@
 #include "binselection.h"
 
 #include <inttypes.h>
+#include <stddef.h>
 
 /* module data structure */
 static bool selected_bin_ids[1000] = { false };
 static bool flag = false;
 
+/* dispatch table: slot to be resolved and candidate functions, per ID */
+static SoBinFn *dispatch_slot[1000] = { NULL };
+static SoBinFn dispatch_bin[1000] = { NULL };
+static SoBinFn dispatch_group[1000] = { NULL };
+
 /* *************************************** */
 
 static void soAdjustRange(uint32_t & lower, uint32_t & upper)
@@ -33,6 +39,18 @@ static void soAdjustRange(uint32_t & lower, uint32_t & upper)
 
 /* *************************************** */
 
+/* point the registered slots in the given range to the selected version */
+static void soBinResolve(uint32_t lower, uint32_t upper)
+{
+    for (uint32_t i = lower; i <= upper; i++)
+    {
+        if (dispatch_slot[i] != NULL)
+            *dispatch_slot[i] = selected_bin_ids[i] ? dispatch_bin[i] : dispatch_group[i];
+    }
+}
+
+/* *************************************** */
+
 /*
  *  \brief Set bin IDs.
  *  \details reset current configuration and set given range
@@ -53,6 +71,9 @@ void soBinSetIDs(uint32_t lower, uint32_t upper)
     /* activate given range */
     for (uint32_t i = lower; i <= upper; i++)
         selected_bin_ids[i] = true;
+
+    /* every registered slot may have changed */
+    soBinResolve(0, 999);
 }
 
 /* *************************************** */
@@ -74,6 +95,8 @@ void soBinAddIDs(uint32_t lower, uint32_t upper)
     /* activate given range */
     for (uint32_t i = lower; i <= upper; i++)
         selected_bin_ids[i] = true;
+
+    soBinResolve(lower, upper);
 }
 
 /* *************************************** */
@@ -95,6 +118,8 @@ void soBinRemoveIDs(uint32_t lower, uint32_t upper)
     /* deactivate given range */
     for (uint32_t i = lower; i <= upper; i++)
         selected_bin_ids[i] = false;
+
+    soBinResolve(lower, upper);
 }
 
 /* *************************************** */
@@ -123,3 +148,27 @@ bool soBinSelected(uint32_t id)
 
 /* *************************************** */
 
+/*
+ *  \brief Register a dispatch slot.
+ *  \details The slot is immediately resolved according to the current configuration
+ *    and again whenever the configuration changes.
+ *  \param id ID of the function
+ *  \param slot pointer to the function pointer used by the front end
+ *  \param bin the binary version of the function
+ *  \param grp the group version of the function
+ */
+void soBinRegister(uint32_t id, SoBinFn *slot, SoBinFn bin, SoBinFn grp)
+{
+    /* ignore if id not valid */
+    if (id >= 1000 or slot == NULL)
+        return;
+
+    dispatch_slot[id] = slot;
+    dispatch_bin[id] = bin != NULL ? bin : grp;
+    dispatch_group[id] = grp;
+
+    *slot = soBinSelected(id) ? dispatch_bin[id] : dispatch_group[id];
+}
+
+/* *************************************** */
+
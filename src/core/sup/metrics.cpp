@@ -0,0 +1,262 @@
+/*
+ *  This toolkit keeps aggregate results of a simulation,
+ *  updated in constant time every time a process changes state.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "metrics.h"
+
+// ================================================================================== //
+
+static FILE *fp = NULL;
+static SoMetrics metrics;
+
+// ================================================================================== //
+
+static inline uint32_t soMetricsBucket(uint64_t v)
+{
+    if (v < 32)
+        return v;
+    uint32_t shift = 63 - __builtin_clzll(v) - 4;
+    return shift * 16 + (v >> shift);
+}
+
+static void soMetricsRecord(SoMetricsHistogram &h, uint64_t value)
+{
+    if (h.count == 0 or value < h.min)
+        h.min = value;
+    if (value > h.max)
+        h.max = value;
+    h.count++;
+    h.sum += value;
+    h.bucket[soMetricsBucket(value)]++;
+}
+
+/* accumulate the time-weighted integrals up to the given time */
+static void soMetricsAdvance(uint64_t time)
+{
+    if (time > metrics.lastTime)
+    {
+        metrics.memIntegral += (uint64_t)metrics.memUsed * (time - metrics.lastTime);
+        metrics.swapIntegral += (uint64_t)metrics.swapLength * (time - metrics.lastTime);
+        metrics.lastTime = time;
+    }
+}
+
+// ================================================================================== //
+
+uint64_t soMetricsPercentile(const SoMetricsHistogram &h, double p)
+{
+    if (h.count == 0)
+        return 0;
+
+    uint64_t target = (uint64_t)(p * h.count + 0.5);
+    if (target == 0)
+        target = 1;
+    uint64_t cnt = 0;
+    for (uint32_t b = 0; b < SOMETRICS_BUCKETS; b++)
+    {
+        cnt += h.bucket[b];
+        if (cnt < target)
+            continue;
+
+        uint64_t value = b;
+        if (b >= 32)
+        {
+            uint32_t shift = b / 16 - 1;
+            value = ((uint64_t)(b % 16 + 16) << shift) + ((1ull << shift) >> 1);
+        }
+        if (value < h.min)
+            return h.min;
+        return value < h.max ? value : h.max;
+    }
+    return h.max;
+}
+
+// ================================================================================== //
+
+void soMetricsOpen(FILE *fs)
+{
+    /* close previous stream, if one is opened */
+    if (fp != NULL and fp != fs and fp != stdout and fp != stderr)
+    {
+        fflush(fp);
+        fclose(fp);
+    }
+
+    fp = fs;
+}
+
+// ================================================================================== //
+
+void soMetricsClose(void)
+{
+    /* close previous stream, if one is opened */
+    if (fp != NULL and fp != stdout and fp != stderr)
+    {
+        fflush(fp);
+        fclose(fp);
+    }
+    fp = NULL;
+}
+
+// ================================================================================== //
+
+void soMetricsReset(uint64_t memCapacity)
+{
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.memCapacity = memCapacity;
+}
+
+// ================================================================================== //
+
+void soMetricsArrival(uint64_t time)
+{
+    if (metrics.arrived == 0)
+        metrics.startTime = metrics.lastTime = time;
+    soMetricsAdvance(time);
+    metrics.arrived++;
+}
+
+// ================================================================================== //
+
+void soMetricsSwap(uint64_t time)
+{
+    soMetricsAdvance(time);
+    metrics.swapped++;
+    metrics.swapLength++;
+    if (metrics.swapLength > metrics.swapPeak)
+        metrics.swapPeak = metrics.swapLength;
+}
+
+// ================================================================================== //
+
+void soMetricsDiscard(uint64_t time, bool fromSwap)
+{
+    soMetricsAdvance(time);
+    metrics.discarded++;
+    if (fromSwap and metrics.swapLength > 0)
+        metrics.swapLength--;
+}
+
+// ================================================================================== //
+
+void soMetricsActivate(uint64_t time, uint64_t arrivalTime, uint64_t memSize, bool fromSwap)
+{
+    soMetricsAdvance(time);
+    metrics.activated++;
+    if (fromSwap and metrics.swapLength > 0)
+        metrics.swapLength--;
+    metrics.memUsed += memSize;
+    if (metrics.memUsed > metrics.memPeak)
+        metrics.memPeak = metrics.memUsed;
+    soMetricsRecord(metrics.waiting, time - arrivalTime);
+}
+
+// ================================================================================== //
+
+void soMetricsFinish(uint64_t time, uint64_t arrivalTime, uint64_t memSize)
+{
+    soMetricsAdvance(time);
+    metrics.finished++;
+    metrics.memUsed = memSize < metrics.memUsed ? metrics.memUsed - memSize : 0;
+    soMetricsRecord(metrics.turnaround, time - arrivalTime);
+}
+
+// ================================================================================== //
+
+void soMetricsCompact(uint64_t time, uint64_t bytes, uint64_t cost)
+{
+    soMetricsAdvance(time);
+    metrics.compactions++;
+    metrics.relocatedBytes += bytes;
+    metrics.compactionTime += cost;
+}
+
+// ================================================================================== //
+
+void soMetricsGet(SoMetrics *m)
+{
+    if (m != NULL)
+        *m = metrics;
+}
+
+// ================================================================================== //
+
+void soMetricsSet(const SoMetrics *m)
+{
+    if (m != NULL)
+        metrics = *m;
+}
+
+// ================================================================================== //
+
+static void soMetricsPrintTimes(FILE *fout, const char *name, const SoMetricsHistogram &h)
+{
+    fprintf(fout, "| %-16s | %8.1f | %8llu | %8llu | %8llu | %8llu | %8llu |\n", name,
+            h.count == 0 ? 0.0 : (double)h.sum / h.count, (unsigned long long)h.min,
+            (unsigned long long)soMetricsPercentile(h, 0.50), (unsigned long long)soMetricsPercentile(h, 0.90),
+            (unsigned long long)soMetricsPercentile(h, 0.99), (unsigned long long)h.max);
+}
+
+static void soMetricsPrintLine(FILE *fout, const char *fmt, ...)
+{
+    char line[100];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    fprintf(fout, "| %-82s |\n", line);
+}
+
+void soMetricsPrint(FILE *fout)
+{
+    if (fout == NULL)
+        return;
+
+    const SoMetrics &m = metrics;
+    uint64_t span = m.lastTime - m.startTime;
+    double capacity = m.memCapacity != 0 ? m.memCapacity : 1;
+
+    fprintf(fout, "+====================================================================================+\n");
+    fprintf(fout, "|                                 Simulation metrics                                 |\n");
+    fprintf(fout, "+------------------------------------------------------------------------------------+\n");
+    soMetricsPrintLine(fout, "processes: %u arrived, %u swapped, %u discarded, %u activated, %u finished",
+            m.arrived, m.swapped, m.discarded, m.activated, m.finished);
+    soMetricsPrintLine(fout, "simulated time: %llu, throughput: %.2f processes per 1000 time units",
+            (unsigned long long)span, span == 0 ? 0.0 : 1000.0 * m.finished / span);
+    soMetricsPrintLine(fout, "memory utilization: %.1f%% average, %.1f%% peak",
+            span == 0 ? 0.0 : 100.0 * m.memIntegral / span / capacity, 100.0 * m.memPeak / capacity);
+    soMetricsPrintLine(fout, "swap queue length: %.2f average, %u peak",
+            span == 0 ? 0.0 : (double)m.swapIntegral / span, m.swapPeak);
+    if (m.compactions > 0)
+        soMetricsPrintLine(fout, "compactions: %u, %llu bytes moved, %llu time units charged",
+                m.compactions, (unsigned long long)m.relocatedBytes, (unsigned long long)m.compactionTime);
+    fprintf(fout, "+------------------+----------+----------+----------+----------+----------+----------+\n");
+    fprintf(fout, "|       time       |   mean   |   min    |   p50    |   p90    |   p99    |   max    |\n");
+    fprintf(fout, "+------------------+----------+----------+----------+----------+----------+----------+\n");
+    soMetricsPrintTimes(fout, "waiting", m.waiting);
+    soMetricsPrintTimes(fout, "turnaround", m.turnaround);
+    fprintf(fout, "+====================================================================================+\n");
+    fprintf(fout, "\n");
+}
+
+// ================================================================================== //
+
+void soMetricsReport(void)
+{
+    if (fp == NULL)
+        return;
+
+    soMetricsPrint(fp);
+    fflush(fp);
+}
+
+// ================================================================================== //
+
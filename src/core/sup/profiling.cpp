@@ -0,0 +1,282 @@
+/*
+ *  This toolkit keeps per-function call counters and latency histograms,
+ *  using the same IDs as the probing system.
+ *  Every thread records into its own table; tables are merged on demand.
+ *  The counters are relaxed atomics, written only by their thread, so they can be
+ *  read while the thread is still recording.
+ *
+ *  \author Artur Pereira - 2023
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <mutex>
+
+#include "profiling.h"
+
+// ================================================================================== //
+
+bool soProfileActive = false;
+
+// ================================================================================== //
+
+/* counters of a single function, in the table of a single thread */
+struct SoProfileCounters {
+    std::atomic<const char *> name{NULL};
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> nanos{0};
+    std::atomic<uint64_t> maxNanos{0};
+    std::atomic<uint32_t> hist[SOPROFILE_BUCKETS] = {};
+};
+
+/* table of counters of a single thread */
+struct SoProfileTable {
+    SoProfileCounters stats[1000];
+    SoProfileTable *next = NULL;
+};
+
+/* the thread-local handle, that merges the table into the retired one when the thread ends */
+struct SoProfileLocal {
+    SoProfileTable *table = NULL;
+    ~SoProfileLocal();
+};
+
+static FILE *fp = NULL;
+static std::mutex tablesLock;
+static SoProfileTable *tables = NULL;       // tables of the live threads
+static SoProfileStats retired[1000];        // merged tables of the threads already gone
+static thread_local SoProfileLocal local;
+
+// ================================================================================== //
+
+static void soProfileMerge(SoProfileStats &to, const SoProfileStats &from)
+{
+    if (from.calls == 0)
+        return;
+    if (to.name == NULL)
+        to.name = from.name;
+    to.calls += from.calls;
+    to.nanos += from.nanos;
+    if (from.maxNanos > to.maxNanos)
+        to.maxNanos = from.maxNanos;
+    for (uint32_t b = 0; b < SOPROFILE_BUCKETS; b++)
+        to.hist[b] += from.hist[b];
+}
+
+/* a snapshot of the counters of a thread, which may still be recording */
+static void soProfileMerge(SoProfileStats &to, const SoProfileCounters &from)
+{
+    SoProfileStats s;
+    s.calls = from.calls.load(std::memory_order_relaxed);
+    if (s.calls == 0)
+        return;
+    s.name = from.name.load(std::memory_order_relaxed);
+    s.nanos = from.nanos.load(std::memory_order_relaxed);
+    s.maxNanos = from.maxNanos.load(std::memory_order_relaxed);
+    for (uint32_t b = 0; b < SOPROFILE_BUCKETS; b++)
+        s.hist[b] = from.hist[b].load(std::memory_order_relaxed);
+    soProfileMerge(to, s);
+}
+
+static void soProfileClear(SoProfileCounters &c)
+{
+    c.name.store(NULL, std::memory_order_relaxed);
+    c.calls.store(0, std::memory_order_relaxed);
+    c.nanos.store(0, std::memory_order_relaxed);
+    c.maxNanos.store(0, std::memory_order_relaxed);
+    for (uint32_t b = 0; b < SOPROFILE_BUCKETS; b++)
+        c.hist[b].store(0, std::memory_order_relaxed);
+}
+
+/* add to a counter that only the calling thread writes */
+template <typename T>
+static inline void soProfileAdd(std::atomic<T> &counter, T value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// ================================================================================== //
+
+SoProfileLocal::~SoProfileLocal()
+{
+    if (table == NULL)
+        return;
+
+    std::lock_guard<std::mutex> guard(tablesLock);
+    for (uint32_t i = 0; i < 1000; i++)
+        soProfileMerge(retired[i], table->stats[i]);
+    for (SoProfileTable **p = &tables; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == table)
+        {
+            *p = table->next;
+            break;
+        }
+    }
+    delete table;
+    table = NULL;
+}
+
+// ================================================================================== //
+
+static SoProfileTable *soProfileAttach(void)
+{
+    SoProfileTable *table = new SoProfileTable();
+    std::lock_guard<std::mutex> guard(tablesLock);
+    table->next = tables;
+    tables = table;
+    local.table = table;
+    return table;
+}
+
+// ================================================================================== //
+
+static inline uint32_t soProfileBucket(uint64_t nanos)
+{
+    if (nanos < 2)
+        return 0;
+    uint32_t b = 63 - __builtin_clzll(nanos);
+    return b < SOPROFILE_BUCKETS ? b : SOPROFILE_BUCKETS - 1;
+}
+
+// ================================================================================== //
+
+uint64_t soProfilePercentile(const SoProfileStats &s, double p)
+{
+    uint64_t target = (uint64_t)(p * s.calls + 0.5);
+    if (target == 0)
+        target = 1;
+    uint64_t cnt = 0;
+    for (uint32_t b = 0; b < SOPROFILE_BUCKETS - 1; b++)
+    {
+        cnt += s.hist[b];
+        if (cnt >= target)
+            return ((uint64_t)2 << b) < s.maxNanos ? ((uint64_t)2 << b) : s.maxNanos;
+    }
+    return s.maxNanos;
+}
+
+// ================================================================================== //
+
+void soProfileOpen(FILE *fs)
+{
+    /* close previous stream, if one is opened */
+    if (fp != NULL and fp != fs and fp != stdout and fp != stderr)
+    {
+        fflush(fp);
+        fclose(fp);
+    }
+
+    fp = fs;
+    soProfileActive = true;
+}
+
+// ================================================================================== //
+
+void soProfileClose(void)
+{
+    soProfileActive = false;
+
+    /* close previous stream, if one is opened */
+    if (fp != NULL and fp != stdout and fp != stderr)
+    {
+        fflush(fp);
+        fclose(fp);
+    }
+    fp = NULL;
+}
+
+// ================================================================================== //
+
+void soProfileReset(void)
+{
+    std::lock_guard<std::mutex> guard(tablesLock);
+    memset(retired, 0, sizeof(retired));
+    for (SoProfileTable *t = tables; t != NULL; t = t->next)
+    {
+        for (uint32_t i = 0; i < 1000; i++)
+            soProfileClear(t->stats[i]);
+    }
+}
+
+// ================================================================================== //
+
+void soProfileRecord(uint32_t id, const char *name, uint64_t nanos)
+{
+    /* do nothing, if out of valid range */
+    if (id > 999)
+        return;
+
+    SoProfileTable *table = local.table;
+    if (table == NULL)
+        table = soProfileAttach();
+
+    SoProfileCounters &s = table->stats[id];
+    s.name.store(name, std::memory_order_relaxed);
+    soProfileAdd(s.calls, (uint64_t)1);
+    soProfileAdd(s.nanos, nanos);
+    if (nanos > s.maxNanos.load(std::memory_order_relaxed))
+        s.maxNanos.store(nanos, std::memory_order_relaxed);
+    soProfileAdd(s.hist[soProfileBucket(nanos)], (uint32_t)1);
+}
+
+// ================================================================================== //
+
+bool soProfileGet(uint32_t id, SoProfileStats *stats)
+{
+    if (id > 999 or stats == NULL)
+        return false;
+
+    memset(stats, 0, sizeof(SoProfileStats));
+    std::lock_guard<std::mutex> guard(tablesLock);
+    soProfileMerge(*stats, retired[id]);
+    for (SoProfileTable *t = tables; t != NULL; t = t->next)
+        soProfileMerge(*stats, t->stats[id]);
+    return stats->calls != 0;
+}
+
+// ================================================================================== //
+
+void soProfilePrint(FILE *fout)
+{
+    if (fout == NULL)
+        return;
+
+    fprintf(fout, "+=======================================================================================================+\n");
+    fprintf(fout, "|                                          Per-function profile                                         |\n");
+    fprintf(fout, "+-----+-----------------------------+------------+--------------+-----------+-----------+-------------+\n");
+    fprintf(fout, "| ID  |          function           |   calls    |  total (us)  | mean (ns) | p50 (ns)  |  p99 (ns)   |\n");
+    fprintf(fout, "+-----+-----------------------------+------------+--------------+-----------+-----------+-------------+\n");
+
+    for (uint32_t id = 0; id < 1000; id++)
+    {
+        SoProfileStats s;
+        if (not soProfileGet(id, &s))
+            continue;
+        fprintf(fout, "| %3u | %-27.27s | %10llu | %12.1f | %9llu | %9llu | %11llu |\n",
+                id, s.name != NULL ? s.name : "---", (unsigned long long)s.calls, s.nanos / 1000.0,
+                (unsigned long long)(s.nanos / s.calls),
+                (unsigned long long)soProfilePercentile(s, 0.50),
+                (unsigned long long)soProfilePercentile(s, 0.99));
+    }
+
+    fprintf(fout, "+=======================================================================================================+\n");
+    fprintf(fout, "\n");
+}
+
+// ================================================================================== //
+
+void soProfileReport(void)
+{
+    if (not soProfileActive or fp == NULL)
+        return;
+
+    soProfilePrint(fp);
+    fflush(fp);
+}
+
+// ================================================================================== //
+
@@ -20,7 +20,7 @@ namespace binaries {
     void feqInit();
     void feqTerm();
     void feqPrint(FILE *fout);
-    void feqInsert(FutureEventType type, uint32_t time, uint32_t pid);
+    void feqInsert(FutureEventType type, SimTime time, uint32_t pid);
     FutureEvent feqPop();
     bool feqIsEmpty();
 }
@@ -29,69 +29,87 @@ namespace group {
     void feqInit();
     void feqTerm();
     void feqPrint(FILE *fout);
-    void feqInsert(FutureEventType type, uint32_t time, uint32_t pid);
+    void feqInsert(FutureEventType type, SimTime time, uint32_t pid);
     FutureEvent feqPop();
     bool feqIsEmpty();
 }
 
 // ================================================================================== //
 
+/*
+ * Dispatch table, pointed to the binary or group version by the binselection toolkit
+ */
+static void (*feqInitFn)() = group::feqInit;
+static void (*feqTermFn)() = group::feqTerm;
+static void (*feqPrintFn)(FILE *fout) = group::feqPrint;
+static void (*feqInsertFn)(FutureEventType type, SimTime time, uint32_t pid) = group::feqInsert;
+static FutureEvent (*feqPopFn)() = group::feqPop;
+static bool (*feqIsEmptyFn)() = group::feqIsEmpty;
+
+static struct FeqDispatch {
+    FeqDispatch()
+    {
+        soBinDispatch(201, &feqInitFn, SOBIN(feqInit), group::feqInit);
+        soBinDispatch(202, &feqTermFn, SOBIN(feqTerm), group::feqTerm);
+        soBinDispatch(203, &feqPrintFn, SOBIN(feqPrint), group::feqPrint);
+        soBinDispatch(204, &feqInsertFn, SOBIN(feqInsert), group::feqInsert);
+        soBinDispatch(205, &feqPopFn, SOBIN(feqPop), group::feqPop);
+        soBinDispatch(206, &feqIsEmptyFn, SOBIN(feqIsEmpty), group::feqIsEmpty);
+    }
+} feqDispatch;
+
+// ================================================================================== //
+
 void feqInit()
 {
-    if (soBinSelected(201))
-        binaries::feqInit();
-    else
-        group::feqInit();
+    SoProfileScope profileScope(201, __func__);
+
+    feqInitFn();
 }
 
 // ================================================================================== //
 
 void feqTerm()
 {
-    if (soBinSelected(202))
-        binaries::feqTerm();
-    else
-        group::feqTerm();
+    SoProfileScope profileScope(202, __func__);
+
+    feqTermFn();
 }
 
 // ================================================================================== //
 
 void feqPrint(FILE *fout)
 {
-    if (soBinSelected(203))
-        binaries::feqPrint(fout);
-    else
-        group::feqPrint(fout);
+    SoProfileScope profileScope(203, __func__);
+
+    feqPrintFn(fout);
 }
 
 // ================================================================================== //
 
-void feqInsert(FutureEventType type, uint32_t time, uint32_t pid)
+void feqInsert(FutureEventType type, SimTime time, uint32_t pid)
 {
-    if (soBinSelected(204))
-        binaries::feqInsert(type, time, pid);
-    else
-        group::feqInsert(type, time, pid);
+    SoProfileScope profileScope(204, __func__);
+
+    feqInsertFn(type, time, pid);
 }
 
 // ================================================================================== //
 
 FutureEvent feqPop()
 {
-    if (soBinSelected(205))
-        return binaries::feqPop();
-    else
-        return group::feqPop();
+    SoProfileScope profileScope(205, __func__);
+
+    return feqPopFn();
 }
 
 // ================================================================================== //
 
 bool feqIsEmpty()
 {
-    if (soBinSelected(206))
-        return binaries::feqIsEmpty();
-    else
-        return group::feqIsEmpty();
+    SoProfileScope profileScope(206, __func__);
+
+    return feqIsEmptyFn();
 }
 
 // ================================================================================== //
@@ -22,118 +22,258 @@ MemTreeNode *memTreeRoot;       ///< Root of the buddy system tree
 // ================================================================================== //
 
 namespace binaries {
-    void memInit(uint32_t memSize, uint32_t memSizeOS, uint32_t chunkSize, AllocationPolicy policy);
+    void memInit(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy);
     void memTerm();
     void memPrint(FILE *fout);
     AddressSpaceMapping *memAlloc(uint32_t pid, AddressSpaceProfile *profile);
-    Address memFirstFitAlloc(uint32_t pid, uint32_t size);
-    Address memBuddySystemAlloc(uint32_t pid, uint32_t size);
+    Address memFirstFitAlloc(uint32_t pid, MemSize size);
+    Address memBuddySystemAlloc(uint32_t pid, MemSize size);
     void memFree(AddressSpaceMapping *mapping);
     void memFirstFitFree(Address address);
     void memBuddySystemFree(Address address);
 }
 
 namespace group {
-    void memInit(uint32_t memSize, uint32_t memSizeOS, uint32_t chunkSize, AllocationPolicy policy);
+    void memInit(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy);
     void memTerm();
     void memPrint(FILE *fout);
     AddressSpaceMapping *memAlloc(uint32_t pid, AddressSpaceProfile *profile);
-    Address memFirstFitAlloc(uint32_t pid, uint32_t size);
-    Address memBuddySystemAlloc(uint32_t pid, uint32_t size);
+    Address memFirstFitAlloc(uint32_t pid, MemSize size);
+    Address memBuddySystemAlloc(uint32_t pid, MemSize size);
     void memFree(AddressSpaceMapping *mapping);
     void memFirstFitFree(Address address);
     void memBuddySystemFree(Address address);
+    void memDeferMerge(bool defer);
+    void memGetStats(MemStats *stats);
+    RelocationTable *memCompact();
+    Address memSlabAlloc(uint32_t pid, MemSize size);
+    void memSlabFree(Address address);
+    Address memTlsfAlloc(uint32_t pid, MemSize size);
+    void memTlsfFree(Address address);
+    void memLazyMerge(uint32_t watermark);
+    void memShadowBitmap(bool enable);
+    bool memBitmapCheck();
+    void memFirstFitArray(bool enable);
+    Address memBitmapFind(MemSize size);
 }
 
 // ================================================================================== //
 
-void memInit(uint32_t memSize, uint32_t memSizeOS, uint32_t chunkSize, AllocationPolicy policy)
+/*
+ * Dispatch table, pointed to the binary or group version by the binselection toolkit
+ */
+static void (*memInitFn)(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy) = group::memInit;
+static void (*memTermFn)() = group::memTerm;
+static void (*memPrintFn)(FILE *fout) = group::memPrint;
+static AddressSpaceMapping *(*memAllocFn)(uint32_t pid, AddressSpaceProfile *profile) = group::memAlloc;
+static Address (*memFirstFitAllocFn)(uint32_t pid, MemSize size) = group::memFirstFitAlloc;
+static Address (*memBuddySystemAllocFn)(uint32_t pid, MemSize size) = group::memBuddySystemAlloc;
+static void (*memFreeFn)(AddressSpaceMapping *mapping) = group::memFree;
+static void (*memFirstFitFreeFn)(Address address) = group::memFirstFitFree;
+static void (*memBuddySystemFreeFn)(Address address) = group::memBuddySystemFree;
+
+static struct MemDispatch {
+    MemDispatch()
+    {
+        soBinDispatch(501, &memInitFn, SOBIN(memInit), group::memInit);
+        soBinDispatch(502, &memTermFn, SOBIN(memTerm), group::memTerm);
+        soBinDispatch(503, &memPrintFn, SOBIN(memPrint), group::memPrint);
+        soBinDispatch(504, &memAllocFn, SOBIN(memAlloc), group::memAlloc);
+        soBinDispatch(505, &memFirstFitAllocFn, SOBIN(memFirstFitAlloc), group::memFirstFitAlloc);
+        soBinDispatch(506, &memBuddySystemAllocFn, SOBIN(memBuddySystemAlloc), group::memBuddySystemAlloc);
+        soBinDispatch(507, &memFreeFn, SOBIN(memFree), group::memFree);
+        soBinDispatch(508, &memFirstFitFreeFn, SOBIN(memFirstFitFree), group::memFirstFitFree);
+        soBinDispatch(509, &memBuddySystemFreeFn, SOBIN(memBuddySystemFree), group::memBuddySystemFree);
+    }
+} memDispatch;
+
+// ================================================================================== //
+
+void memInit(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy)
 {
-    if (soBinSelected(501))
-        binaries::memInit(memSize, memSizeOS, chunkSize, policy);
-    else
-        group::memInit(memSize, memSizeOS, chunkSize, policy);
+    SoProfileScope profileScope(501, __func__);
+
+    memInitFn(memSize, memSizeOS, chunkSize, policy);
 }
 
 // ================================================================================== //
 
 void memTerm()
 {
-    if (soBinSelected(502))
-        binaries::memTerm();
-    else
-        group::memTerm();
+    SoProfileScope profileScope(502, __func__);
+
+    memTermFn();
 }
 
 // ================================================================================== //
 
 void memPrint(FILE *fout)
 {
-    if (soBinSelected(503))
-        binaries::memPrint(fout);
-    else
-        group::memPrint(fout);
+    SoProfileScope profileScope(503, __func__);
+
+    memPrintFn(fout);
 }
 
 // ================================================================================== //
 
 AddressSpaceMapping *memAlloc(uint32_t pid, AddressSpaceProfile *profile)
 {
-    if (soBinSelected(504))
-        return binaries::memAlloc(pid, profile);
-    else
-        return group::memAlloc(pid, profile);
+    SoProfileScope profileScope(504, __func__);
+
+    return memAllocFn(pid, profile);
 }
 
 // ================================================================================== //
 
-Address memFirstFitAlloc(uint32_t pid, uint32_t size)
+Address memFirstFitAlloc(uint32_t pid, MemSize size)
 {
-    if (soBinSelected(505))
-        return binaries::memFirstFitAlloc(pid, size);
-    else
-        return group::memFirstFitAlloc(pid, size);
+    SoProfileScope profileScope(505, __func__);
+
+    return memFirstFitAllocFn(pid, size);
 }
 
 // ================================================================================== //
 
-Address memBuddySystemAlloc(uint32_t pid, uint32_t size)
+Address memBuddySystemAlloc(uint32_t pid, MemSize size)
 {
-    if (soBinSelected(506))
-        return binaries::memBuddySystemAlloc(pid, size);
-    else
-        return group::memBuddySystemAlloc(pid, size);
+    SoProfileScope profileScope(506, __func__);
+
+    return memBuddySystemAllocFn(pid, size);
 }
 
 // ================================================================================== //
 
 void memFree(AddressSpaceMapping *mapping)
 {
-    if (soBinSelected(507))
-        binaries::memFree(mapping);
-    else
-        group::memFree(mapping);
+    SoProfileScope profileScope(507, __func__);
+
+    memFreeFn(mapping);
 }
 
 // ================================================================================== //
 
 void memFirstFitFree(Address address)
 {
-    if (soBinSelected(508))
-        binaries::memFirstFitFree(address);
-    else
-        group::memFirstFitFree(address);
+    SoProfileScope profileScope(508, __func__);
+
+    memFirstFitFreeFn(address);
 }
 
 // ================================================================================== //
 
 void memBuddySystemFree(Address address)
 {
-    if (soBinSelected(509))
-        binaries::memBuddySystemFree(address);
-    else
-        group::memBuddySystemFree(address);
+    SoProfileScope profileScope(509, __func__);
+
+    memBuddySystemFreeFn(address);
+}
+
+// ================================================================================== //
+
+void memDeferMerge(bool defer)
+{
+    SoProfileScope profileScope(510, __func__);
+
+    group::memDeferMerge(defer);
+}
+
+// ================================================================================== //
+
+void memGetStats(MemStats *stats)
+{
+    SoProfileScope profileScope(511, __func__);
+
+    group::memGetStats(stats);
+}
+
+// ================================================================================== //
+
+RelocationTable *memCompact()
+{
+    SoProfileScope profileScope(512, __func__);
+
+    return group::memCompact();
+}
+
+// ================================================================================== //
+
+Address memSlabAlloc(uint32_t pid, MemSize size)
+{
+    SoProfileScope profileScope(513, __func__);
+
+    return group::memSlabAlloc(pid, size);
+}
+
+// ================================================================================== //
+
+void memSlabFree(Address address)
+{
+    SoProfileScope profileScope(514, __func__);
+
+    group::memSlabFree(address);
+}
+
+// ================================================================================== //
+
+Address memTlsfAlloc(uint32_t pid, MemSize size)
+{
+    SoProfileScope profileScope(515, __func__);
+
+    return group::memTlsfAlloc(pid, size);
+}
+
+// ================================================================================== //
+
+void memTlsfFree(Address address)
+{
+    SoProfileScope profileScope(516, __func__);
+
+    group::memTlsfFree(address);
 }
 
 // ================================================================================== //
 
+void memLazyMerge(uint32_t watermark)
+{
+    SoProfileScope profileScope(517, __func__);
+
+    group::memLazyMerge(watermark);
+}
+
+// ================================================================================== //
+
+void memShadowBitmap(bool enable)
+{
+    SoProfileScope profileScope(518, __func__);
+
+    group::memShadowBitmap(enable);
+}
+
+// ================================================================================== //
+
+bool memBitmapCheck()
+{
+    SoProfileScope profileScope(519, __func__);
+
+    return group::memBitmapCheck();
+}
+
+// ================================================================================== //
+
+void memFirstFitArray(bool enable)
+{
+    SoProfileScope profileScope(520, __func__);
+
+    group::memFirstFitArray(enable);
+}
+
+// ================================================================================== //
+
+Address memBitmapFind(MemSize size)
+{
+    SoProfileScope profileScope(521, __func__);
+
+    return group::memBitmapFind(size);
+}
+
+// ================================================================================== //
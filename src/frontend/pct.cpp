@@ -13,6 +13,7 @@
  * The set of supporting variables are NOT changeable
  */
 PctNode *pctHead;    ///< Pointer to head of list 
+PctTable pctTable;   ///< The table used by the group version
 
 // ================================================================================== //
 
@@ -20,114 +21,165 @@ namespace binaries {
     void pctInit();
     void pctTerm();
     void pctPrint(FILE *fout);
-    void pctInsert(uint32_t pid, uint32_t time, uint32_t lifetime, AddressSpaceProfile *memProfile);
-    uint32_t pctGetLifetime(uint32_t pid);
+    void pctInsert(uint32_t pid, SimTime time, SimTime lifetime, AddressSpaceProfile *memProfile);
+    SimTime pctGetLifetime(uint32_t pid);
     AddressSpaceProfile *pctGetAddressSpaceProfile(uint32_t pid);
     AddressSpaceMapping *pctGetAddressSpaceMapping(uint32_t pid);
     const char *pctGetStateAsString(uint32_t pid);
-    void pctUpdateState(uint32_t pid, ProcessState state, uint32_t time, AddressSpaceMapping *mapping);
+    void pctUpdateState(uint32_t pid, ProcessState state, SimTime time, AddressSpaceMapping *mapping);
 }
 
 namespace group {
     void pctInit();
     void pctTerm();
     void pctPrint(FILE *fout);
-    void pctInsert(uint32_t pid, uint32_t time, uint32_t lifetime, AddressSpaceProfile *memProfile);
-    uint32_t pctGetLifetime(uint32_t pid);
+    void pctInsert(uint32_t pid, SimTime time, SimTime lifetime, AddressSpaceProfile *memProfile);
+    SimTime pctGetLifetime(uint32_t pid);
     AddressSpaceProfile *pctGetAddressSpaceProfile(uint32_t pid);
     AddressSpaceMapping *pctGetAddressSpaceMapping(uint32_t pid);
     const char *pctGetStateAsString(uint32_t pid);
-    void pctUpdateState(uint32_t pid, ProcessState state, uint32_t time, AddressSpaceMapping *mapping);
+    void pctUpdateState(uint32_t pid, ProcessState state, SimTime time, AddressSpaceMapping *mapping);
+    void pctRelocate(RelocationTable *table);
+    uint32_t pctCountInState(ProcessState state);
+    uint32_t pctGetPidsInState(ProcessState state, uint32_t *pids, uint32_t max);
 }
 
 // ================================================================================== //
 
+/*
+ * Dispatch table, pointed to the binary or group version by the binselection toolkit
+ */
+static void (*pctInitFn)() = group::pctInit;
+static void (*pctTermFn)() = group::pctTerm;
+static void (*pctPrintFn)(FILE *fout) = group::pctPrint;
+static void (*pctInsertFn)(uint32_t pid, SimTime time, SimTime lifetime, AddressSpaceProfile *memProfile) = group::pctInsert;
+static SimTime (*pctGetLifetimeFn)(uint32_t pid) = group::pctGetLifetime;
+static AddressSpaceProfile *(*pctGetAddressSpaceProfileFn)(uint32_t pid) = group::pctGetAddressSpaceProfile;
+static AddressSpaceMapping *(*pctGetAddressSpaceMappingFn)(uint32_t pid) = group::pctGetAddressSpaceMapping;
+static const char *(*pctGetStateAsStringFn)(uint32_t pid) = group::pctGetStateAsString;
+static void (*pctUpdateStateFn)(uint32_t pid, ProcessState state, SimTime time, AddressSpaceMapping *mapping) = group::pctUpdateState;
+
+static struct PctDispatch {
+    PctDispatch()
+    {
+        soBinDispatch(301, &pctInitFn, SOBIN(pctInit), group::pctInit);
+        soBinDispatch(302, &pctTermFn, SOBIN(pctTerm), group::pctTerm);
+        soBinDispatch(303, &pctPrintFn, SOBIN(pctPrint), group::pctPrint);
+        soBinDispatch(304, &pctInsertFn, SOBIN(pctInsert), group::pctInsert);
+        soBinDispatch(305, &pctGetLifetimeFn, SOBIN(pctGetLifetime), group::pctGetLifetime);
+        soBinDispatch(306, &pctGetAddressSpaceProfileFn, SOBIN(pctGetAddressSpaceProfile), group::pctGetAddressSpaceProfile);
+        soBinDispatch(307, &pctGetAddressSpaceMappingFn, SOBIN(pctGetAddressSpaceMapping), group::pctGetAddressSpaceMapping);
+        soBinDispatch(308, &pctGetStateAsStringFn, SOBIN(pctGetStateAsString), group::pctGetStateAsString);
+        soBinDispatch(309, &pctUpdateStateFn, SOBIN(pctUpdateState), group::pctUpdateState);
+    }
+} pctDispatch;
+
+// ================================================================================== //
+
 void pctInit()
 {
-    if (soBinSelected(301))
-        binaries::pctInit();
-    else
-        group::pctInit();
+    SoProfileScope profileScope(301, __func__);
+
+    pctInitFn();
 }
 
 // ================================================================================== //
 
 void pctTerm()
 {
-    if (soBinSelected(302))
-        binaries::pctTerm();
-    else
-        group::pctTerm();
+    SoProfileScope profileScope(302, __func__);
+
+    pctTermFn();
 }
 
 // ================================================================================== //
 
 void pctPrint(FILE *fout)
 {
-    if (soBinSelected(303))
-        binaries::pctPrint(fout);
-    else
-        group::pctPrint(fout);
+    SoProfileScope profileScope(303, __func__);
+
+    pctPrintFn(fout);
 }
 
 // ================================================================================== //
 
-void pctInsert(uint32_t pid, uint32_t time, uint32_t lifetime, AddressSpaceProfile *profile)
+void pctInsert(uint32_t pid, SimTime time, SimTime lifetime, AddressSpaceProfile *profile)
 {
-    if (soBinSelected(304))
-        binaries::pctInsert(pid, time, lifetime, profile);
-    else
-        group::pctInsert(pid, time, lifetime, profile);
+    SoProfileScope profileScope(304, __func__);
+
+    pctInsertFn(pid, time, lifetime, profile);
 }
 
 // ================================================================================== //
 
-uint32_t pctGetLifetime(uint32_t pid)
+SimTime pctGetLifetime(uint32_t pid)
 {
-    if (soBinSelected(305))
-        return binaries::pctGetLifetime(pid);
-    else
-        return group::pctGetLifetime(pid);
+    SoProfileScope profileScope(305, __func__);
+
+    return pctGetLifetimeFn(pid);
 }
 
 // ================================================================================== //
 
 AddressSpaceProfile *pctGetAddressSpaceProfile(uint32_t pid)
 {
-    if (soBinSelected(306))
-        return binaries::pctGetAddressSpaceProfile(pid);
-    else
-        return group::pctGetAddressSpaceProfile(pid);
+    SoProfileScope profileScope(306, __func__);
+
+    return pctGetAddressSpaceProfileFn(pid);
 }
 
 // ================================================================================== //
 
 AddressSpaceMapping *pctGetAddressSpaceMapping(uint32_t pid)
 {
-    if (soBinSelected(307))
-        return binaries::pctGetAddressSpaceMapping(pid);
-    else
-        return group::pctGetAddressSpaceMapping(pid);
+    SoProfileScope profileScope(307, __func__);
+
+    return pctGetAddressSpaceMappingFn(pid);
 }
 
 // ================================================================================== //
 
 const char *pctGetStateAsString(uint32_t pid)
 {
-    if (soBinSelected(308))
-        return binaries::pctGetStateAsString(pid);
-    else
-        return group::pctGetStateAsString(pid);
+    SoProfileScope profileScope(308, __func__);
+
+    return pctGetStateAsStringFn(pid);
+}
+
+// ================================================================================== //
+
+void pctUpdateState(uint32_t pid, ProcessState state, SimTime time, AddressSpaceMapping *mapping)
+{
+    SoProfileScope profileScope(309, __func__);
+
+    pctUpdateStateFn(pid, state, time, mapping);
+}
+
+// ================================================================================== //
+
+void pctRelocate(RelocationTable *table)
+{
+    SoProfileScope profileScope(310, __func__);
+
+    group::pctRelocate(table);
+}
+
+// ================================================================================== //
+
+uint32_t pctCountInState(ProcessState state)
+{
+    SoProfileScope profileScope(311, __func__);
+
+    return group::pctCountInState(state);
 }
 
 // ================================================================================== //
 
-void pctUpdateState(uint32_t pid, ProcessState state, uint32_t time, AddressSpaceMapping *mapping)
+uint32_t pctGetPidsInState(ProcessState state, uint32_t *pids, uint32_t max)
 {
-    if (soBinSelected(309))
-        binaries::pctUpdateState(pid, state, time, mapping);
-    else
-        group::pctUpdateState(pid, state, time, mapping);
+    SoProfileScope profileScope(312, __func__);
+
+    return group::pctGetPidsInState(state, pids, max);
 }
 
 // ================================================================================== //
@@ -13,14 +13,14 @@
  * The set of supporting variables are NOT changeable
  */
 uint32_t stepCount;                  ///< The current number of simulation steps
-uint32_t simTime;                    ///< The current simulation time
+SimTime simTime;                     ///< The current simulation time
 ForthcomingTable forthcomingTable;   ///< The set of processes to be simulated
 
 // ================================================================================== //
 // ================================================================================== //
 
 namespace binaries {
-    void simInit(uint32_t memSize, uint32_t memSizeOS, uint32_t chunkSize, AllocationPolicy policy);
+    void simInit(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy);
     void simTerm();
     void simLoad(const char *fname);
     void simRandomFill(uint32_t n, uint32_t seed);
@@ -31,7 +31,7 @@ namespace binaries {
 }
 
 namespace group {
-    void simInit(uint32_t memSize, uint32_t memSizeOS, uint32_t chunkSize, AllocationPolicy policy);
+    void simInit(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy);
     void simTerm();
     void simLoad(const char *fname);
     void simRandomFill(uint32_t n, uint32_t seed);
@@ -39,86 +39,166 @@ namespace group {
     ForthcomingProcess *simGetProcess(uint32_t pid);
     bool simStep();
     void simRun(uint32_t cnt);
+    void simCheckpoint(const char *fname);
+    void simRestore(const char *fname);
+    pid_t simFork(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy);
+    int simJoin(pid_t pid, SoMetrics *metrics);
+    bool simStepTime();
+    void simSetCompaction(bool on, SimTime fixedCost, SimTime chunkCost);
 }
 
 // ================================================================================== //
 
-void simInit(uint32_t memSize, uint32_t memSizeOS, uint32_t chunkSize, AllocationPolicy policy)
+/*
+ * Dispatch table, pointed to the binary or group version by the binselection toolkit
+ */
+static void (*simInitFn)(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy) = group::simInit;
+static void (*simTermFn)() = group::simTerm;
+static void (*simLoadFn)(const char *fname) = group::simLoad;
+static void (*simRandomFillFn)(uint32_t n, uint32_t seed) = group::simRandomFill;
+static void (*simPrintFn)(FILE *fout) = group::simPrint;
+static ForthcomingProcess *(*simGetProcessFn)(uint32_t pid) = group::simGetProcess;
+static bool (*simStepFn)() = group::simStep;
+static void (*simRunFn)(uint32_t cnt) = group::simRun;
+
+static struct SimDispatch {
+    SimDispatch()
+    {
+        soBinDispatch(101, &simInitFn, SOBIN(simInit), group::simInit);
+        soBinDispatch(102, &simTermFn, SOBIN(simTerm), group::simTerm);
+        soBinDispatch(104, &simLoadFn, SOBIN(simLoad), group::simLoad);
+        soBinDispatch(105, &simRandomFillFn, SOBIN(simRandomFill), group::simRandomFill);
+        soBinDispatch(103, &simPrintFn, SOBIN(simPrint), group::simPrint);
+        soBinDispatch(106, &simGetProcessFn, SOBIN(simGetProcess), group::simGetProcess);
+        soBinDispatch(107, &simStepFn, SOBIN(simStep), group::simStep);
+        soBinDispatch(108, &simRunFn, SOBIN(simRun), group::simRun);
+    }
+} simDispatch;
+
+// ================================================================================== //
+
+void simInit(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy)
 {
-    if (soBinSelected(101))
-        binaries::simInit(memSize, memSizeOS, chunkSize, policy);
-    else
-        group::simInit(memSize, memSizeOS, chunkSize, policy);
+    SoProfileScope profileScope(101, __func__);
+
+    simInitFn(memSize, memSizeOS, chunkSize, policy);
 }
 
 // ================================================================================== //
 
 void simTerm()
 {
-    if (soBinSelected(102))
-        binaries::simTerm();
-    else
-        group::simTerm();
+    SoProfileScope profileScope(102, __func__);
+
+    simTermFn();
 }
 
 // ================================================================================== //
 
 void simPrint(FILE *fout)
 {
-    if (soBinSelected(103))
-        binaries::simPrint(fout);
-    else
-        group::simPrint(fout);
+    SoProfileScope profileScope(103, __func__);
+
+    simPrintFn(fout);
 }
 
 // ================================================================================== //
 
 void simLoad(const char *fname)
 {
-    if (soBinSelected(104))
-        binaries::simLoad(fname);
-    else
-        group::simLoad(fname);
+    SoProfileScope profileScope(104, __func__);
+
+    simLoadFn(fname);
 }
 
 // ================================================================================== //
 
 void simRandomFill(uint32_t n, uint32_t seed)
 {
-    if (soBinSelected(105))
-        binaries::simRandomFill(n, seed);
-    else
-        group::simRandomFill(n, seed);
+    SoProfileScope profileScope(105, __func__);
+
+    simRandomFillFn(n, seed);
 }
 
 // ================================================================================== //
 
 ForthcomingProcess *simGetProcess(uint32_t pid)
 {
-    if (soBinSelected(106))
-        return binaries::simGetProcess(pid);
-    else
-        return group::simGetProcess(pid);
+    SoProfileScope profileScope(106, __func__);
+
+    return simGetProcessFn(pid);
 }
 
 // ================================================================================== //
 
 bool simStep()
 {
-    if (soBinSelected(107))
-        return binaries::simStep();
-    else
-        return group::simStep();
+    SoProfileScope profileScope(107, __func__);
+
+    return simStepFn();
 }
 
 // ================================================================================== //
 
 void simRun(uint32_t cnt)
 {
-    if (soBinSelected(108))
-        binaries::simRun(cnt);
-    else
-        group::simRun(cnt);
+    SoProfileScope profileScope(108, __func__);
+
+    simRunFn(cnt);
+}
+
+// ================================================================================== //
+
+void simCheckpoint(const char *fname)
+{
+    SoProfileScope profileScope(109, __func__);
+
+    group::simCheckpoint(fname);
+}
+
+// ================================================================================== //
+
+void simRestore(const char *fname)
+{
+    SoProfileScope profileScope(110, __func__);
+
+    group::simRestore(fname);
+}
+
+// ================================================================================== //
+
+pid_t simFork(MemSize memSize, MemSize memSizeOS, MemSize chunkSize, AllocationPolicy policy)
+{
+    SoProfileScope profileScope(111, __func__);
+
+    return group::simFork(memSize, memSizeOS, chunkSize, policy);
+}
+
+// ================================================================================== //
+
+int simJoin(pid_t pid, SoMetrics *metrics)
+{
+    SoProfileScope profileScope(112, __func__);
+
+    return group::simJoin(pid, metrics);
+}
+
+// ================================================================================== //
+
+bool simStepTime()
+{
+    SoProfileScope profileScope(113, __func__);
+
+    return group::simStepTime();
+}
+
+// ================================================================================== //
+
+void simSetCompaction(bool on, SimTime fixedCost, SimTime chunkCost)
+{
+    SoProfileScope profileScope(114, __func__);
+
+    group::simSetCompaction(on, fixedCost, chunkCost);
 }
 
 // ================================================================================== //
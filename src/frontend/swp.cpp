@@ -37,62 +37,80 @@ namespace group {
 
 // ================================================================================== //
 
+/*
+ * Dispatch table, pointed to the binary or group version by the binselection toolkit
+ */
+static void (*swpInitFn)() = group::swpInit;
+static void (*swpTermFn)() = group::swpTerm;
+static void (*swpPrintFn)(FILE *fout) = group::swpPrint;
+static void (*swpAddFn)(uint32_t pid, AddressSpaceProfile *profile) = group::swpAdd;
+static SwappedProcess *(*swpPeekFn)(uint32_t idx) = group::swpPeek;
+static void (*swpRemoveFn)(uint32_t idx) = group::swpRemove;
+
+static struct SwpDispatch {
+    SwpDispatch()
+    {
+        soBinDispatch(401, &swpInitFn, SOBIN(swpInit), group::swpInit);
+        soBinDispatch(402, &swpTermFn, SOBIN(swpTerm), group::swpTerm);
+        soBinDispatch(403, &swpPrintFn, SOBIN(swpPrint), group::swpPrint);
+        soBinDispatch(404, &swpAddFn, SOBIN(swpAdd), group::swpAdd);
+        soBinDispatch(405, &swpPeekFn, SOBIN(swpPeek), group::swpPeek);
+        soBinDispatch(406, &swpRemoveFn, SOBIN(swpRemove), group::swpRemove);
+    }
+} swpDispatch;
+
+// ================================================================================== //
+
 void swpInit()
 {
-    if (soBinSelected(401))
-        binaries::swpInit();
-    else
-        group::swpInit();
+    SoProfileScope profileScope(401, __func__);
+
+    swpInitFn();
 }
 
 // ================================================================================== //
 
 void swpTerm()
 {
-    if (soBinSelected(402))
-        binaries::swpTerm();
-    else
-        group::swpTerm();
+    SoProfileScope profileScope(402, __func__);
+
+    swpTermFn();
 }
 
 // ================================================================================== //
 
 void swpPrint(FILE *fout)
 {
-    if (soBinSelected(403))
-        binaries::swpPrint(fout);
-    else
-        group::swpPrint(fout);
+    SoProfileScope profileScope(403, __func__);
+
+    swpPrintFn(fout);
 }
 
 // ================================================================================== //
 
 void swpAdd(uint32_t pid, AddressSpaceProfile *profile)
 {
-    if (soBinSelected(404))
-        binaries::swpAdd(pid, profile);
-    else
-        group::swpAdd(pid, profile);
+    SoProfileScope profileScope(404, __func__);
+
+    swpAddFn(pid, profile);
 }
 
 // ================================================================================== //
 
 SwappedProcess *swpPeek(uint32_t idx)
 {
-    if (soBinSelected(405))
-        return binaries::swpPeek(idx);
-    else
-        return group::swpPeek(idx);
+    SoProfileScope profileScope(405, __func__);
+
+    return swpPeekFn(idx);
 }
 
 // ================================================================================== //
 
 void swpRemove(uint32_t idx)
 {
-    if (soBinSelected(406))
-        return binaries::swpRemove(idx);
-    else
-        return group::swpRemove(idx);
+    SoProfileScope profileScope(406, __func__);
+
+    swpRemoveFn(idx);
 }
 
 // ================================================================================== //
@@ -9,10 +9,10 @@ namespace group
 
 // ================================================================================== //
 
-    void feqInsert(FutureEventType type, uint32_t time, uint32_t pid)
+    void feqInsert(FutureEventType type, SimTime time, uint32_t pid)
     {
         const char *tas = type == ARRIVAL ? "ARRIVAL" : type == TERMINATE ? "TERMINATE" : "UNKOWN";
-        soProbe(204, "%s(%s, %u, %u)\n", __func__, tas, time, pid);
+        soProbe(204, "%s(%s, %" FMT_TIME ", %u)\n", __func__, tas, time, pid);
 
         require(pid > 0, "process ID must be non-zero");
 
@@ -38,7 +38,7 @@ namespace group
         FeqEventNode *current = feqHead;
         while (current != NULL) {
             const char *tas = current->event.type == ARRIVAL ? "ARRIVAL" : "TERMINATE";
-            fprintf(fout, "| %8u | %-9s | %5u |\n", current->event.time, tas, current->event.pid);
+            fprintf(fout, "| %8" FMT_TIME " | %-9s | %5u |\n", current->event.time, tas, current->event.pid);
             current = current->next;
         }
 
@@ -1,5 +1,5 @@
 /*
- *  \author ...
+ *  \author Gonçalo Oliveira 108405
  */
 
 #include "somm23.h"
@@ -9,6 +9,10 @@
 namespace group 
 {
 
+    extern bool memMergeDeferred;
+
+    MemSize memBuddyForestLargest();
+
 // ================================================================================== //
 
     AddressSpaceMapping *memAlloc(uint32_t pid, AddressSpaceProfile *profile)
@@ -17,30 +21,64 @@ namespace group
 
         require(pid > 0, "process ID must be non-zero");
         require(profile != NULL, "profile must be a valid pointer to an AddressSpaceProfile variable");
+        require(not memMergeDeferred, "merging of free blocks can not be deferred while allocating");
 
         /* The mapping to be filled and whose pointer should be returned */
         static AddressSpaceMapping theMapping = {0, {0}};
 
         /* TODO POINT: Replace next instructions with your code */
-        uint32_t totalRequiredMemory = 0;
-        for (uint32_t i = 0; i < profile->segmentCount; ++i) {
-            uint32_t roundedSize = ((profile->size[i] + memParameters.chunkSize - 1) / memParameters.chunkSize) * memParameters.chunkSize;
-            totalRequiredMemory += roundedSize;
+        /* memory available for processes, and the one required by the given address space */
+        MemSize availableMemory = memParameters.totalSize - memParameters.kernelSize;
+        if (memParameters.policy == BuddySystem)
+            availableMemory = (MemSize)1 << (63 - __builtin_clzll(availableMemory));
 
-            if (totalRequiredMemory > (memParameters.totalSize - memParameters.kernelSize)) {
+        uint64_t totalRequiredMemory = 0;
+        for (uint32_t i = 0; i < profile->segmentCount; ++i) {
+            MemSize roundedSize = ((profile->size[i] + memParameters.chunkSize - 1) / memParameters.chunkSize) * memParameters.chunkSize;
+            uint64_t blockSize = roundedSize;
+            if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest) {
+                /* the buddy system assigns blocks whose size is a power of two */
+                blockSize = 1;
+                while (blockSize < roundedSize)
+                    blockSize <<= 1;
+            }
+            /* and, in a forest, every block must fit in one of the trees */
+            if (memParameters.policy == BuddyForest and blockSize > memBuddyForestLargest()) {
                 return IMPOSSIBLE_MAPPING;
             }
+            totalRequiredMemory += blockSize;
+        }
+
+        if (totalRequiredMemory > availableMemory) {
+            return IMPOSSIBLE_MAPPING;
         }
 
         theMapping.blockCount = 0;
         for (uint32_t i = 0; i < profile->segmentCount; ++i) {
-            uint32_t roundedSize = ((profile->size[i] + memParameters.chunkSize - 1) / memParameters.chunkSize) * memParameters.chunkSize;
-
-            Address alloc_address = (memParameters.policy == FirstFit) ? memFirstFitAlloc(pid, roundedSize) : memBuddySystemAlloc(pid, roundedSize);
+            MemSize roundedSize = ((profile->size[i] + memParameters.chunkSize - 1) / memParameters.chunkSize) * memParameters.chunkSize;
+
+            Address alloc_address;
+            if (memParameters.policy == FirstFit)
+                alloc_address = memFirstFitAlloc(pid, roundedSize);
+            else if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest)
+                alloc_address = memBuddySystemAlloc(pid, roundedSize);
+            else if (memParameters.policy == Slab)
+                alloc_address = memSlabAlloc(pid, roundedSize);
+            else
+                alloc_address = memTlsfAlloc(pid, roundedSize);
 
             if (alloc_address == NULL_ADDRESS) {
                 // Free previously allocated segments
-                memFree(&theMapping);
+                for (uint32_t j = 0; j < theMapping.blockCount; ++j) {
+                    if (memParameters.policy == FirstFit)
+                        memFirstFitFree(theMapping.address[j]);
+                    else if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest)
+                        memBuddySystemFree(theMapping.address[j]);
+                    else if (memParameters.policy == Slab)
+                        memSlabFree(theMapping.address[j]);
+                    else
+                        memTlsfFree(theMapping.address[j]);
+                }
                 return NO_MAPPING;
             }
 
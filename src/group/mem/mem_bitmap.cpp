@@ -0,0 +1,271 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace group
+{
+
+    void memTlsfChunkBlocks(std::vector<MemChunkBlock> &blocks);
+    void memFitRebuild();
+
+// ================================================================================== //
+
+    /*
+     * The shadow bitmap has a bit per chunk of the memory for processes, set if the chunk is
+     * in an occupied block, kept up to date by the allocation and free functions of every policy.
+     * The bits past the last chunk are set, so no run of free chunks goes beyond the memory.
+     * A run of free chunks is searched a word (64 chunks) at a time, with shifts and ands
+     * for the runs within a word, skipping fully occupied words 4 at a time if AVX2 is available.
+     * Slab objects are not tracked, a slab being an occupied block of the first fit lists.
+     */
+    bool memBitmapEnabled = false;
+
+    static std::vector<uint64_t> words;         // bit i of word w is chunk 64 * w + i
+    static uint32_t chunkCount;                 // number of chunks of the memory for processes
+
+// ================================================================================== //
+
+    static inline uint64_t memBitmapMask(uint32_t first, uint32_t count)
+    {
+        return (count == 64 ? ~0ull : ((1ull << count) - 1)) << first;
+    }
+
+    /* set or clear the given range of chunks */
+    static void memBitmapSet(uint32_t first, uint32_t count, bool occupied)
+    {
+        while (count != 0)
+        {
+            uint32_t w = first / 64, b = first % 64;
+            uint32_t n = count < 64 - b ? count : 64 - b;
+            if (occupied)
+                words[w] |= memBitmapMask(b, n);
+            else
+                words[w] &= ~memBitmapMask(b, n);
+            first += n;
+            count -= n;
+        }
+    }
+
+    /* true if all chunks of the given range are set (or all are clear) */
+    static bool memBitmapAll(uint32_t first, uint32_t count, bool occupied)
+    {
+        while (count != 0)
+        {
+            uint32_t w = first / 64, b = first % 64;
+            uint32_t n = count < 64 - b ? count : 64 - b;
+            uint64_t mask = memBitmapMask(b, n);
+            if ((words[w] & mask) != (occupied ? mask : 0))
+                return false;
+            first += n;
+            count -= n;
+        }
+        return true;
+    }
+
+    static inline Address memBitmapAddress(uint64_t chunk)
+    {
+        return memParameters.kernelSize + (Address)chunk * memParameters.chunkSize;
+    }
+
+    /* add a block, in chunk units, to blocks; return false if it does not start and end at a chunk */
+    static bool memBitmapPush(const MemBlock &block, std::vector<MemChunkBlock> &blocks)
+    {
+        blocks.push_back(memChunkBlock(block, memParameters.chunkSize));
+        return block.address % memParameters.chunkSize == 0 and block.size % memParameters.chunkSize == 0;
+    }
+
+    static bool memBitmapLeaves(const MemTreeNode *node, std::vector<MemChunkBlock> &blocks)
+    {
+        if (node == NULL)
+            return true;
+        if (node->state == SPLITTED)
+            return memBitmapLeaves(node->left, blocks) & memBitmapLeaves(node->right, blocks);
+        return memBitmapPush(node->block, blocks);
+    }
+
+    /* all blocks of the active policy, free and occupied, in chunk units; return false if any does not fit in chunks */
+    static bool memBitmapBlocks(std::vector<MemChunkBlock> &blocks)
+    {
+        if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest)
+            return memBitmapLeaves(memTreeRoot, blocks);
+        if (memParameters.policy == Tlsf)
+        {
+            memTlsfChunkBlocks(blocks);
+            return true;
+        }
+
+        bool aligned = true;
+        for (MemListNode *p = memFreeHead; p != NULL; p = p->next)
+            aligned = memBitmapPush(p->block, blocks) and aligned;
+        for (MemListNode *p = memOccupiedHead; p != NULL; p = p->next)
+            aligned = memBitmapPush(p->block, blocks) and aligned;
+        return aligned;
+    }
+
+// ================================================================================== //
+
+    /* a block was allocated (or freed) */
+    void memBitmapMark(Address address, MemSize size, bool occupied)
+    {
+        if (not memBitmapEnabled)
+            return;
+
+        memBitmapSet((address - memParameters.kernelSize) / memParameters.chunkSize, size / memParameters.chunkSize, occupied);
+    }
+
+    /* build the bitmap from the blocks of the active policy */
+    void memBitmapRebuild()
+    {
+        if (not memBitmapEnabled)
+            return;
+
+        require(memParameters.policy == FirstFit or memParameters.policy == Slab or memParameters.policy == Tlsf
+                or (memParameters.chunkSize & (memParameters.chunkSize - 1)) == 0,
+                "chunk size must be a power of two for the buddy system to be shadowed");
+
+        chunkCount = (memParameters.totalSize - memParameters.kernelSize) / memParameters.chunkSize;
+        words.assign((chunkCount + 63) / 64, 0);
+        if (chunkCount % 64 != 0)
+            words.back() = ~0ull << (chunkCount % 64);
+
+        std::vector<MemChunkBlock> blocks;
+        memBitmapBlocks(blocks);
+        uint32_t kernelChunks = memParameters.kernelSize / memParameters.chunkSize;
+        for (const MemChunkBlock &b : blocks)
+            if (b.occupied)
+                memBitmapSet(b.start - kernelChunks, b.count, true);
+    }
+
+    void memBitmapReset()
+    {
+        words.clear();
+        words.shrink_to_fit();
+        chunkCount = 0;
+    }
+
+    /* address of the first run of free chunks of at least the given size, or NULL_ADDRESS if there is none */
+    Address memBitmapFirstRun(MemSize size)
+    {
+        uint64_t chunks = (size + memParameters.chunkSize - 1) / memParameters.chunkSize;
+        uint64_t run = 0;           // free chunks at the top of the words seen so far
+        uint32_t w = 0;
+        while (w < words.size())
+        {
+#ifdef __AVX2__
+            /* fully occupied words, 4 at a time */
+            if (run == 0)
+            {
+                const __m256i ones = _mm256_set1_epi64x(-1);
+                while (w + 4 <= words.size()
+                        and _mm256_testc_si256(_mm256_loadu_si256((const __m256i *)&words[w]), ones))
+                    w += 4;
+                if (w == words.size())
+                    break;
+            }
+#endif
+            uint64_t x = words[w];
+            if (x == 0)
+            {
+                run += 64;
+                if (run >= chunks)
+                    return memBitmapAddress(64ull * (w + 1) - run);
+                w++;
+                continue;
+            }
+
+            /* a run coming from the words below, ending at the bottom of this one */
+            uint64_t low = __builtin_ctzll(x);
+            if (run + low >= chunks and run + low != 0)
+                return memBitmapAddress(64ull * w - run);
+
+            /* a run within the word: bit i of m is set if chunks i to i + chunks - 1 are all free */
+            if (chunks < 64)
+            {
+                uint64_t m = ~x;
+                uint32_t len = 1;
+                while (m != 0 and 2 * len <= chunks)
+                {
+                    m &= m >> len;
+                    len *= 2;
+                }
+                if (len < chunks)
+                    m &= m >> (chunks - len);
+                if (m != 0)
+                    return memBitmapAddress(64ull * w + __builtin_ctzll(m));
+            }
+
+            run = __builtin_clzll(x);
+            w++;
+        }
+        return NULL_ADDRESS;
+    }
+
+// ================================================================================== //
+
+    void memShadowBitmap(bool enable)
+    {
+        soProbe(518, "%s(%s)\n", __func__, enable ? "true" : "false");
+
+        memBitmapEnabled = enable;
+        if (not enable)
+            memBitmapReset();
+        else if (memParameters.totalSize != 0)
+            memBitmapRebuild();
+        memFitRebuild();
+    }
+
+// ================================================================================== //
+
+    Address memBitmapFind(MemSize size)
+    {
+        soProbe(521, "%s(%#" FMT_ADDR ")\n", __func__, size);
+
+        require(memBitmapEnabled, "the shadow bitmap must be enabled");
+        require(size, "the size must be greater than zero");
+
+        return memBitmapFirstRun(size);
+    }
+
+// ================================================================================== //
+
+    bool memBitmapCheck()
+    {
+        soProbe(519, "%s()\n", __func__);
+
+        require(memBitmapEnabled, "the shadow bitmap must be enabled");
+
+        /* every block agrees with its chunks, and no other chunk is set */
+        std::vector<MemChunkBlock> blocks;
+        if (not memBitmapBlocks(blocks))
+            return false;
+        uint32_t kernelChunks = memParameters.kernelSize / memParameters.chunkSize;
+        uint64_t expected = 64ull * words.size() - chunkCount;
+        for (const MemChunkBlock &b : blocks)
+        {
+            if (b.start < kernelChunks or (uint64_t)b.start - kernelChunks + b.count > chunkCount)
+                return false;
+            if (not memBitmapAll(b.start - kernelChunks, b.count, b.occupied))
+                return false;
+            if (b.occupied)
+                expected += b.count;
+        }
+
+        uint64_t set = 0;
+        for (uint64_t x : words)
+            set += __builtin_popcountll(x);
+        return set == expected;
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
@@ -1,5 +1,5 @@
 /*
- *  \author ...
+ *  \author Gonçalo Oliveira 108405
  */
 
 #include "somm23.h"
@@ -9,13 +9,22 @@
 namespace group 
 {
 
+    void memBuddyFreeInsert(const MemBlock &block);
+    void memBuddyFreeErase(const MemBlock &block);
+    MemTreeNode *memBuddyForestFind(MemSize size);
+    void memBuddySystemMergeAll(MemTreeNode *node);
+    void memBitmapMark(Address address, MemSize size, bool occupied);
+
+    extern uint32_t memLazyWatermark;
+
 // ================================================================================== //
 
     // Helper function to create a new MemTreeNode
-    MemTreeNode* createMemTreeNode(Address address, uint32_t size)
+    MemTreeNode* createMemTreeNode(Address address, MemSize size)
     {
         MemTreeNode* newNode = new MemTreeNode();
         newNode->state = FREE;  // Assuming the new node is initially free
+        newNode->block.pid = 0;
         newNode->block.address = address;
         newNode->block.size = size;
         newNode->left = nullptr;
@@ -24,103 +33,70 @@ namespace group
         return newNode;
     }
 
+    // Split a free leaf into two free buddies
     void splitBlock(MemTreeNode* node)
     {
-        require(node != nullptr, "Node should not be nullptr");
-
-        uint32_t subBlockSize = node->block.size / 2;
-
-        // Create the left child node
-        MemTreeNode* leftChild = createMemTreeNode(node->block.address, subBlockSize);
-
-        // Create the right child node
-        MemTreeNode* rightChild = createMemTreeNode(node->block.address + subBlockSize, subBlockSize);
-
-        // Update the left and right pointers of the parent node
-        node->left = leftChild;
-        node->right = rightChild;
-
-        // Recursively split the left and right children
-        if (leftChild->block.size > 1)
-        {
-            splitBlock(leftChild);
-        }
-        if (rightChild->block.size > 1)
-        {
-            splitBlock(rightChild);
-        }
-    }
-
-    MemTreeNode* findNode(MemTreeNode* root, Address address) {
-        if (root == nullptr || root->block.address == address) {
-            return root;
-        }
-
-        if (address < root->block.address) {
-            return findNode(root->left, address);
-        } else {
-            return findNode(root->right, address);
-        }
-    }
-
-    Address allocateBlock(MemTreeNode* node, uint32_t size)
-    {
-
-        require(node->block.size >= size, "Node size is not sufficient for allocation");
+        require(node != nullptr && node->state == FREE, "Node should be a free leaf");
 
-        require(node->left == nullptr && node->right == nullptr, "Invalid node type for allocation");
-
-        node->state = OCCUPIED;
+        MemSize subBlockSize = node->block.size / 2;
 
-        if (node->block.size > size)
-        {
-            splitBlock(node);
-        }
+        node->left = createMemTreeNode(node->block.address, subBlockSize);
+        node->right = createMemTreeNode(node->block.address + subBlockSize, subBlockSize);
+        node->state = SPLITTED;
 
-        return node->block.address;
+        memBuddyFreeErase(node->block);
+        memBuddyFreeInsert(node->left->block);
+        memBuddyFreeInsert(node->right->block);
     }
 
-    MemTreeNode* findBestFit(MemTreeNode* node, uint32_t size) {
-        if (node == nullptr || node->state == OCCUPIED) {
+    // First free leaf big enough for the given size, in a left-right, depth-first search
+    MemTreeNode* findFirstFit(MemTreeNode* node, MemSize size) {
+        if (node == nullptr || node->block.size < size || node->state == OCCUPIED) {
             return nullptr;
         }
 
-        if (node->block.size < size || (node->left != nullptr && node->right != nullptr)) {
-            MemTreeNode* leftFit = findBestFit(node->left, size);
-            MemTreeNode* rightFit = findBestFit(node->right, size);
-
-            if (leftFit != nullptr) {
-                return leftFit;
-            } else {
-                return rightFit;
-            }
-        } else {
+        if (node->state == FREE) {
             return node;
         }
+
+        MemTreeNode* leftFit = findFirstFit(node->left, size);
+        if (leftFit != nullptr) {
+            return leftFit;
+        }
+        return findFirstFit(node->right, size);
     }
 
-    Address memBuddySystemAlloc(uint32_t pid, uint32_t size) {
-        soProbe(506, "%s(%u, %#x)\n", __func__, pid, size);
+    Address memBuddySystemAlloc(uint32_t pid, MemSize size) {
+        soProbe(506, "%s(%u, %#" FMT_ADDR ")\n", __func__, pid, size);
 
         require(pid > 0, "a valid process ID must be greater than zero");
         require(size, "the size of a memory segment must be greater than zero");
 
-        MemTreeNode* freeNode = findBestFit(memTreeRoot, size);
+        /* in a forest, the first tree with a free block big enough is known beforehand */
+        MemTreeNode* node = memParameters.policy == BuddyForest ? memBuddyForestFind(size) : findFirstFit(memTreeRoot, size);
+
+        /* a lazy buddy system merges the blocks left unmerged only when they are needed */
+        if (node == nullptr && memLazyWatermark != 0) {
+            memBuddySystemMergeAll(memTreeRoot);
+            node = memParameters.policy == BuddyForest ? memBuddyForestFind(size) : findFirstFit(memTreeRoot, size);
+        }
 
-        if (freeNode == nullptr) {
-            throw Exception(ENOMEM, __func__);
+        if (node == nullptr) {
+            return NULL_ADDRESS;
         }
 
-        Address allocatedAddress = allocateBlock(freeNode, size);
+        // Split into halves, using the lower one, while half of it is still enough
+        while (node->block.size / 2 >= size && node->block.size / 2 >= memParameters.chunkSize) {
+            splitBlock(node);
+            node = node->left;
+        }
 
-        MemListNode* newOccupiedNode = new MemListNode();
-        newOccupiedNode->block.pid = pid;
-        newOccupiedNode->block.size = size;
-        newOccupiedNode->block.address = allocatedAddress;
-        newOccupiedNode->next = memOccupiedHead;
-        memOccupiedHead = newOccupiedNode;
+        memBuddyFreeErase(node->block);
+        memBitmapMark(node->block.address, node->block.size, true);
+        node->state = OCCUPIED;
+        node->block.pid = pid;
 
-        return allocatedAddress;
+        return node->block.address;
     }
 
 
@@ -0,0 +1,196 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace group
+{
+
+    void memStatsInsert(MemSize size);
+    void memStatsErase(MemSize size);
+    MemTreeNode* createMemTreeNode(Address address, MemSize size);
+    MemTreeNode* findFirstFit(MemTreeNode* node, MemSize size);
+
+// ================================================================================== //
+
+    /*
+     * With the BuddyForest policy, the memory for processes is covered by the biggest blocks
+     * whose size is a power of two and whose address is a multiple of that size,
+     * in ascending order of addresses, each one the root of a buddy tree.
+     * The roots are joined, as left sub-trees, by splitted nodes that are never merged,
+     * so the forest is still a single tree for printing, freeing and checkpointing.
+     * For every order (log2 of a size), a bitmap tells which roots have free blocks of that order,
+     * so the root to allocate from is found with a few bit operations, instead of searching every root.
+     */
+    static const uint32_t maxRoots = 64;
+    static const uint32_t orders = 64;
+
+    static MemTreeNode *roots[maxRoots];                // roots of the forest, in ascending order of addresses
+    static uint32_t rootCount;                          // number of roots
+    static uint32_t freeCount[maxRoots][orders];        // number of free blocks, per root and order
+    static uint64_t rootMask[orders];                   // bit r is set if root r has free blocks of the order
+
+// ================================================================================== //
+
+    /* the root of the tree holding the given address */
+    static uint32_t memBuddyForestIndex(Address address)
+    {
+        uint32_t lo = 0, hi = rootCount;
+        while (hi - lo > 1)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            if (roots[mid]->block.address <= address)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    static void memBuddyForestCount(const MemBlock &block, int32_t delta)
+    {
+        uint32_t r = memBuddyForestIndex(block.address);
+        uint32_t o = 63 - __builtin_clzll(block.size);
+        freeCount[r][o] += delta;
+        if (freeCount[r][o] == 0)
+            rootMask[o] &= ~(1ull << r);
+        else
+            rootMask[o] |= 1ull << r;
+    }
+
+    /* count the free leaves of the given sub-tree */
+    static void memBuddyForestCountTree(const MemTreeNode *node)
+    {
+        if (node->state == SPLITTED)
+        {
+            memBuddyForestCountTree(node->left);
+            memBuddyForestCountTree(node->right);
+        }
+        else if (node->state == FREE)
+        {
+            memBuddyForestCount(node->block, 1);
+        }
+    }
+
+    /* size of the root at the given address, for the given memory left to cover */
+    static MemSize memBuddyForestRootSize(Address address, MemSize size)
+    {
+        MemSize rootSize = (MemSize)1 << (63 - __builtin_clzll(size));
+        if (address != 0 and (address & -address) < rootSize)
+            rootSize = address & -address;
+        return rootSize;
+    }
+
+// ================================================================================== //
+
+    /* a free block appeared in the buddy system */
+    void memBuddyFreeInsert(const MemBlock &block)
+    {
+        memStatsInsert(block.size);
+        if (memParameters.policy == BuddyForest)
+            memBuddyForestCount(block, 1);
+    }
+
+    /* a free block disappeared from the buddy system */
+    void memBuddyFreeErase(const MemBlock &block)
+    {
+        memStatsErase(block.size);
+        if (memParameters.policy == BuddyForest)
+            memBuddyForestCount(block, -1);
+    }
+
+    void memBuddyForestReset()
+    {
+        rootCount = 0;
+        memset(freeCount, 0, sizeof(freeCount));
+        memset(rootMask, 0, sizeof(rootMask));
+    }
+
+    /* the forest covering the given memory, all free, as a single tree */
+    MemTreeNode *memBuddyForestInit(Address address, MemSize size)
+    {
+        memBuddyForestReset();
+        while (size != 0)
+        {
+            MemSize rootSize = memBuddyForestRootSize(address, size);
+            require(rootCount < maxRoots, "the forest can not have more than 64 roots");
+            roots[rootCount++] = createMemTreeNode(address, rootSize);
+            address += rootSize;
+            size -= rootSize;
+        }
+
+        MemTreeNode *top = roots[rootCount - 1];
+        memBuddyFreeInsert(top->block);
+        for (uint32_t r = rootCount - 1; r-- > 0; )
+        {
+            memBuddyFreeInsert(roots[r]->block);
+            MemTreeNode *join = createMemTreeNode(roots[r]->block.address, roots[r]->block.size + top->block.size);
+            join->state = SPLITTED;
+            join->left = roots[r];
+            join->right = top;
+            top = join;
+        }
+        return top;
+    }
+
+    /* find the roots and count the free blocks of a forest rebuilt by other means */
+    void memBuddyForestRestore(MemTreeNode *top)
+    {
+        memBuddyForestReset();
+        Address address = memParameters.kernelSize;
+        MemSize size = memParameters.totalSize - memParameters.kernelSize;
+        MemTreeNode *node = top;
+        while (size != 0)
+        {
+            MemSize rootSize = memBuddyForestRootSize(address, size);
+            address += rootSize;
+            size -= rootSize;
+            roots[rootCount++] = size != 0 ? node->left : node;
+            node = node->right;
+        }
+        for (uint32_t r = 0; r < rootCount; r++)
+            memBuddyForestCountTree(roots[r]);
+    }
+
+    /* true if the given splitted node joins two trees of the forest */
+    bool memBuddyForestJoins(const MemTreeNode *node)
+    {
+        return memParameters.policy == BuddyForest and rootCount != 0
+            and roots[memBuddyForestIndex(node->block.address)] == node->left;
+    }
+
+    /* the first free leaf big enough for the given size, in the first root having one */
+    MemTreeNode *memBuddyForestFind(MemSize size)
+    {
+        uint32_t order = 63 - __builtin_clzll(size) + ((size & (size - 1)) != 0);
+        uint64_t mask = 0;
+        for (uint32_t o = order; o < orders; o++)
+            mask |= rootMask[o];
+        if (mask == 0)
+            return NULL;
+        return findFirstFit(roots[__builtin_ctzll(mask)], size);
+    }
+
+    /* the root of the tree holding the given address */
+    MemTreeNode *memBuddyForestRoot(Address address)
+    {
+        return roots[memBuddyForestIndex(address)];
+    }
+
+    /* size of the biggest root */
+    MemSize memBuddyForestLargest()
+    {
+        MemSize largest = 0;
+        for (uint32_t r = 0; r < rootCount; r++)
+            if (roots[r]->block.size > largest)
+                largest = roots[r]->block.size;
+        return largest;
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
@@ -1,5 +1,5 @@
 /*
- *  \author ...
+ *  \author Gonçalo Oliveira 108405
  */
 
 #include "somm23.h"
@@ -11,63 +11,73 @@ namespace group
 
 // ================================================================================== //
 
-    MemTreeNode* findNode(MemTreeNode* root, unsigned int address);
+    extern bool memMergeDeferred;
+    extern uint32_t memLazyWatermark;
 
-    // Function to find the parent of a node in the binary tree
-    MemTreeNode* findParent(MemTreeNode* root, MemTreeNode* node) {
-        if (root == nullptr || root->left == node || root->right == node) {
-            return root;
-        }
-
-        MemTreeNode* leftParent = findParent(root->left, node);
-        if (leftParent != nullptr) {
-            return leftParent;
-        }
+    uint32_t memStatsCount(uint32_t cls);
 
-        return findParent(root->right, node);
-    }
+    void memBuddyFreeInsert(const MemBlock &block);
+    void memBuddyFreeErase(const MemBlock &block);
+    bool memBuddyForestJoins(const MemTreeNode *node);
+    MemTreeNode *memBuddyForestRoot(Address address);
+    void memBitmapMark(Address address, MemSize size, bool occupied);
 
-    // Function to merge adjacent free blocks in the binary tree
-    void memBuddySystemMerge(MemTreeNode* root, MemTreeNode* node) {
-        if (node == nullptr || node->state != FREE) {
+    // Collapse the given splitted node, if both its buddies are free (and it does not join two trees of a forest)
+    void memBuddySystemMerge(MemTreeNode* node) {
+        if (node->left->state != FREE || node->right->state != FREE || memBuddyForestJoins(node)) {
             return;
         }
 
-        if (node->left != nullptr && node->left->state == FREE &&
-            node->right != nullptr && node->right->state == FREE) {
+        memBuddyFreeErase(node->left->block);
+        memBuddyFreeErase(node->right->block);
+        memBuddyFreeInsert(node->block);
 
-            node->state = FREE;
-            node->left = nullptr;
-            node->right = nullptr;
+        delete node->left;
+        delete node->right;
+        node->left = nullptr;
+        node->right = nullptr;
+        node->state = FREE;
+        node->block.pid = 0;
+    }
+
+    // Whether the halves of the given node are to be merged now: always, unless the buddy system is lazy,
+    // in which case only once there are more free blocks of the order of the halves than the watermark
+    static bool memBuddySystemMergeDue(MemTreeNode* node) {
+        return memLazyWatermark == 0 || memStatsCount(63 - __builtin_clzll(node->left->block.size)) > memLazyWatermark;
+    }
 
-            MemTreeNode* parent = findParent(root, node);
+    // Free the leaf containing the given address, merging upward on the way back
+    static void memBuddySystemRelease(MemTreeNode* node, Address address) {
+        if (node->state == SPLITTED) {
+            MemTreeNode* child = address < node->right->block.address ? node->left : node->right;
+            memBuddySystemRelease(child, address);
+            if (not memMergeDeferred && memBuddySystemMergeDue(node)) {
+                memBuddySystemMerge(node);
+            }
+            return;
+        }
 
-            memBuddySystemMerge(root, parent);
+        if (node->state != OCCUPIED || node->block.address != address) {
+            throw Exception(EINVAL, "memBuddySystemFree");
         }
+
+        node->state = FREE;
+        node->block.pid = 0;
+        memBuddyFreeInsert(node->block);
+        memBitmapMark(node->block.address, node->block.size, false);
     }
 
     void memBuddySystemFree(Address address)
     {
-        soProbe(509, "%s(%u)\n", __func__, address);
+        soProbe(509, "%s(%#" FMT_ADDR ")\n", __func__, address);
 
-        /* TODO POINT: Replace next instruction with your code */
         require(memTreeRoot != nullptr, "Binary tree should be initialized");
 
-        if (address == 0)
-        {
-            throw Exception(EINVAL, __func__);
-        }
-
-        MemTreeNode* targetNode = findNode(memTreeRoot, address);
-
-        require(targetNode != nullptr, "Block to be freed not found in the binary tree");
-
-        targetNode->state = FREE;
-
-        memBuddySystemMerge(memTreeRoot, targetNode);
+        /* in a forest, the search starts at the tree holding the address */
+        MemTreeNode* root = memParameters.policy == BuddyForest ? memBuddyForestRoot(address) : memTreeRoot;
+        memBuddySystemRelease(root, address);
     }
 
 // ================================================================================== //
 
 } // end of namespace group
-
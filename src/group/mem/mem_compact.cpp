@@ -0,0 +1,101 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace group
+{
+
+    extern bool memMergeDeferred;
+
+    void memStatsReset();
+    void memStatsInsert(MemSize size);
+    void memBitmapRebuild();
+    void memFitRebuild();
+
+// ================================================================================== //
+
+    /* The table filled by memCompact, whose pointer is returned */
+    static RelocationTable theTable = { 0, 0, 0, NULL };
+
+    void memCompactReset()
+    {
+        free(theTable.block);
+        theTable = { 0, 0, 0, NULL };
+    }
+
+// ================================================================================== //
+
+    RelocationTable *memCompact()
+    {
+        soProbe(512, "%s()\n", __func__);
+
+        require(memParameters.policy == FirstFit, "compaction only applies to the first fit policy");
+        require(not memMergeDeferred, "merging of free blocks can not be deferred while compacting");
+
+        /* any block in memory may move, so the table takes as many as there are */
+        uint32_t blocks = 0;
+        for (MemListNode *p = memOccupiedHead; p != NULL; p = p->next)
+            blocks++;
+        if (blocks > theTable.capacity)
+        {
+            BlockRelocation *p = (BlockRelocation *)realloc(theTable.block, blocks * sizeof(BlockRelocation));
+            if (p == NULL)
+                throw Exception(ENOMEM, __func__);
+            theTable.block = p;
+            theTable.capacity = blocks;
+        }
+        theTable.count = 0;
+        theTable.bytes = 0;
+
+        /* the occupied list is sorted by address, so every block slides down to the end of the previous one */
+        Address next = memParameters.kernelSize;
+        for (MemListNode *p = memOccupiedHead; p != NULL; p = p->next)
+        {
+            if (p->block.address != next)
+            {
+                BlockRelocation &r = theTable.block[theTable.count++];
+                r.pid = p->block.pid;
+                r.from = p->block.address;
+                r.to = next;
+                theTable.bytes += p->block.size;
+                p->block.address = next;
+            }
+            next += p->block.size;
+        }
+
+        /* all the free memory becomes a single block above the occupied ones */
+        while (memFreeHead != NULL)
+        {
+            MemListNode *tmp = memFreeHead;
+            memFreeHead = memFreeHead->next;
+            delete tmp;
+        }
+
+        MemSize freeSize = memParameters.totalSize - next;
+        if (freeSize > 0)
+        {
+            MemListNode *node = new MemListNode;
+            node->block.pid = 0;
+            node->block.size = freeSize;
+            node->block.address = next;
+            node->prev = NULL;
+            node->next = NULL;
+            memFreeHead = node;
+        }
+
+        memStatsReset();
+        memStatsInsert(freeSize);
+        memBitmapRebuild();
+        memFitRebuild();
+
+        return &theTable;
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
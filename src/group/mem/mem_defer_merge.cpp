@@ -0,0 +1,55 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+namespace group
+{
+
+// ================================================================================== //
+
+    /* true while the free functions leave adjacent free blocks unmerged */
+    bool memMergeDeferred = false;
+
+    void mergeFreeBlocks();
+    void memBuddySystemMerge(MemTreeNode *node);
+    void memTlsfMergeAll();
+
+    /* collapse, bottom-up, every splitted node whose halves are both free */
+    void memBuddySystemMergeAll(MemTreeNode *node)
+    {
+        if (node == NULL or node->state != SPLITTED)
+            return;
+
+        memBuddySystemMergeAll(node->left);
+        memBuddySystemMergeAll(node->right);
+        memBuddySystemMerge(node);
+    }
+
+// ================================================================================== //
+
+    void memDeferMerge(bool defer)
+    {
+        soProbe(510, "%s(%s)\n", __func__, defer ? "true" : "false");
+
+        bool pending = memMergeDeferred and not defer;
+        memMergeDeferred = defer;
+
+        if (not pending)
+            return;
+
+        /* a single pass merges all the blocks released while deferred */
+        if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest)
+            memBuddySystemMergeAll(memTreeRoot);
+        else if (memParameters.policy == Tlsf)
+            memTlsfMergeAll();
+        else
+            mergeFreeBlocks();
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
@@ -1,5 +1,5 @@
 /*
- *  \author ...
+ *  \author Gonçalo Oliveira 108405
  */
 
 #include "somm23.h"
@@ -9,63 +9,122 @@
 namespace group
 {
 
+    extern bool memMergeDeferred;
+    extern bool memBitmapEnabled;
+    extern bool memFitArrayEnabled;
+    bool memFitIndexed();
+
+    void memStatsInsert(MemSize size);
+    void memStatsErase(MemSize size);
+    void memBitmapMark(Address address, MemSize size, bool occupied);
+    Address memBitmapFirstRun(MemSize size);
+    MemListNode *memFitFind(MemSize size);
+    void memFitInsert(MemListNode *node, bool occupied);
+    void memFitErase(const MemListNode *node, bool occupied);
+    void memFitUpdate(const MemListNode *node, Address address);
+    void memFitNeighbours(Address address, bool occupied, MemListNode **prev, MemListNode **next);
+
 // ================================================================================== //
 
-    Address memFirstFitAlloc(uint32_t pid, uint32_t size) {
-        soProbe(505, "%s(%u, %#x)\n", __func__, pid, size);
+    /* insert a node in the occupied list, keeping it sorted by address */
+    static void insertOccupiedBlock(MemListNode *node)
+    {
+        MemListNode *prevNode = nullptr;
+        MemListNode *currentNode = memOccupiedHead;
+        if (memFitIndexed()) {
+            memFitNeighbours(node->block.address, true, &prevNode, &currentNode);
+        } else {
+            while (currentNode != nullptr && currentNode->block.address < node->block.address) {
+                prevNode = currentNode;
+                currentNode = currentNode->next;
+            }
+        }
+
+        node->prev = prevNode;
+        node->next = currentNode;
+        if (prevNode == nullptr) {
+            memOccupiedHead = node;
+        } else {
+            prevNode->next = node;
+        }
+        if (currentNode != nullptr) {
+            currentNode->prev = node;
+        }
+        memFitInsert(node, true);
+    }
+
+// ================================================================================== //
+
+    Address memFirstFitAlloc(uint32_t pid, MemSize size) {
+        soProbe(505, "%s(%u, %#" FMT_ADDR ")\n", __func__, pid, size);
 
         require(pid > 0, "a valid process ID must be greater than zero");
         require(size, "the size of a memory segment must be greater than zero");
 
+        /* the free list is sorted by address, so the first one big enough is the first fit */
         MemListNode* currentNode = memFreeHead;
-        MemListNode* prevNode = nullptr;
-
-        while (currentNode != nullptr) {
-            if (currentNode->block.size >= size) {
-                Address allocatedAddress = currentNode->block.address;
-
-                // Create a new occupied block node
-                MemListNode* newOccupiedNode = new MemListNode();
-                newOccupiedNode->block.pid = pid;
-                newOccupiedNode->block.size = size;
-                newOccupiedNode->block.address = allocatedAddress;
-                newOccupiedNode->next = memOccupiedHead;
-                memOccupiedHead = newOccupiedNode;
-
-                // Split the block if it's larger than the requested size
-                if (currentNode->block.size > size) {
-                    MemListNode* newFreeNode = new MemListNode();
-                    newFreeNode->block.size = currentNode->block.size - size;
-                    newFreeNode->block.address = allocatedAddress + size;
-                    newFreeNode->next = currentNode->next;
-
-                    currentNode->block.size = size;
-
-                    if (prevNode == nullptr) {
-                        memFreeHead = newFreeNode;
-                    } else {
-                        prevNode->next = newFreeNode;
-                    }
-                } else {
-                    if (prevNode == nullptr) {
-                        memFreeHead = currentNode->next;
-                    } else {
-                        prevNode->next = currentNode->next;
-                    }
-                }
-
-                delete currentNode;
-                return allocatedAddress;
+        if (memFitArrayEnabled) {
+            /* or the first one of the first fit array, found without walking the list */
+            currentNode = memFitFind(size);
+        } else if (memBitmapEnabled && !memMergeDeferred) {
+            /*
+             * with all free blocks merged, a free block is a run of free chunks, so it is the one
+             * where the shadow bitmap has the first run big enough, its node taken from the first fit array
+             */
+            Address address = memBitmapFirstRun(size);
+            if (address == NULL_ADDRESS) {
+                return NULL_ADDRESS;
+            }
+            MemListNode *below;
+            memFitNeighbours(address, false, &below, &currentNode);
+            require(currentNode != nullptr && currentNode->block.address == address && currentNode->block.size >= size,
+                    "the shadow bitmap must agree with the free list");
+        } else {
+            while (currentNode != nullptr && currentNode->block.size < size) {
+                currentNode = currentNode->next;
+            }
+        }
+
+        if (currentNode == nullptr) {
+            return NULL_ADDRESS;
+        }
+
+        Address allocatedAddress = currentNode->block.address;
+        memStatsErase(currentNode->block.size);
+        memBitmapMark(allocatedAddress, size, true);
+
+        // Split the block if it's larger than the requested size, the upper part remaining free
+        if (currentNode->block.size > size) {
+            MemListNode* newOccupiedNode = new MemListNode();
+            newOccupiedNode->block.pid = pid;
+            newOccupiedNode->block.size = size;
+            newOccupiedNode->block.address = allocatedAddress;
+            insertOccupiedBlock(newOccupiedNode);
+
+            currentNode->block.address += size;
+            currentNode->block.size -= size;
+            memStatsInsert(currentNode->block.size);
+            memFitUpdate(currentNode, allocatedAddress);
+        } else {
+            // Exact fit: the free node moves to the occupied list
+            memFitErase(currentNode, false);
+            if (currentNode->prev == nullptr) {
+                memFreeHead = currentNode->next;
+            } else {
+                currentNode->prev->next = currentNode->next;
+            }
+            if (currentNode->next != nullptr) {
+                currentNode->next->prev = currentNode->prev;
             }
 
-            prevNode = currentNode;
-            currentNode = currentNode->next;
+            currentNode->block.pid = pid;
+            insertOccupiedBlock(currentNode);
         }
 
-        throw Exception(NULL_ADDRESS, __func__);
+        return allocatedAddress;
     }
 
 
 // ================================================================================== //
 
-} // end of namespace group
\ No newline at end of file
+} // end of namespace group
@@ -0,0 +1,372 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace group
+{
+
+// ================================================================================== //
+
+    /*
+     * The first fit arrays mirror the free and the occupied lists, in ascending order of addresses,
+     * as parallel arrays of start addresses and sizes, in chunk units, and of the list nodes,
+     * split in buckets of up to MEM_FIT_BUCKET blocks, so inserting or removing a block only
+     * moves the rest of its bucket, and the place of a block is found by binary search.
+     * The first address and the largest size of every bucket are kept in arrays of their own.
+     * The first fit is found scanning the largest sizes for the first bucket with a free block big enough,
+     * and then the sizes of that bucket, 8 (AVX2) or 4 (SSE2) sizes per compare,
+     * so no list node is touched until the one found.
+     * The start and size columns are the fields of a MemChunkBlock, kept apart for the compares,
+     * and, as in a MemChunkBlock, there is no PID, the array a block is in telling whether it is free.
+     */
+    struct MemFitBucket {
+        uint32_t count;                         // number of blocks
+        uint32_t start[MEM_FIT_BUCKET];         // start address of every block, in chunks
+        uint32_t size[MEM_FIT_BUCKET];          // size of every block, in chunks
+        MemListNode *node[MEM_FIT_BUCKET];      // node of every block, in its list
+    };
+
+    struct MemFitArray {
+        std::vector<MemFitBucket *> buckets;    // buckets, in ascending order of addresses, none empty
+        std::vector<uint32_t> first;            // start address of the first block of every bucket
+        std::vector<uint32_t> largest;          // largest size of every bucket
+    };
+
+    static_assert(sizeof(MemFitBucket::start[0]) + sizeof(MemFitBucket::size[0]) == sizeof(MemChunkBlock),
+            "a block of the arrays takes as much as a block in chunk units");
+
+    bool memFitArrayEnabled = false;
+    extern bool memBitmapEnabled;
+
+    static MemFitArray freeArray;               // mirror of the free list
+    static MemFitArray occupiedArray;           // mirror of the occupied list
+
+    /*
+     * the arrays are also kept while the shadow bitmap is enabled,
+     * as the first fit search of the bitmap maps the run it finds to its node through them
+     */
+    bool memFitIndexed()
+    {
+        return memFitArrayEnabled or memBitmapEnabled;
+    }
+
+// ================================================================================== //
+
+    static inline uint32_t memFitChunks(Address address)
+    {
+        return address / memParameters.chunkSize;
+    }
+
+    /* index of the first size not smaller than the given one, or count if there is none */
+    static uint32_t memFitScan(const uint32_t *sizes, uint32_t count, uint32_t size)
+    {
+        uint32_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+        /* sizes are unsigned, so both sides are biased for the signed compare */
+        const uint32_t bias = 0x80000000u;
+#endif
+#if defined(__AVX2__)
+        const __m256i low8 = _mm256_set1_epi32((int32_t)((size - 1) ^ bias));
+        const __m256i bias8 = _mm256_set1_epi32((int32_t)bias);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&sizes[i]), bias8);
+            uint32_t mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, low8)));
+            if (mask != 0)
+                return i + __builtin_ctz(mask);
+        }
+#elif defined(__SSE2__)
+        const __m128i low4 = _mm_set1_epi32((int32_t)((size - 1) ^ bias));
+        const __m128i bias4 = _mm_set1_epi32((int32_t)bias);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&sizes[i]), bias4);
+            uint32_t mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, low4)));
+            if (mask != 0)
+                return i + __builtin_ctz(mask);
+        }
+#endif
+        for (; i < count; i++)
+            if (sizes[i] >= size)
+                return i;
+        return count;
+    }
+
+    static void memFitLargest(MemFitArray &array, uint32_t b)
+    {
+        const MemFitBucket *bucket = array.buckets[b];
+        uint32_t largest = 0;
+        for (uint32_t i = 0; i < bucket->count; i++)
+            largest = bucket->size[i] > largest ? bucket->size[i] : largest;
+        array.largest[b] = largest;
+    }
+
+    /* the bucket holding, or to hold, the given start address */
+    static uint32_t memFitBucket(const MemFitArray &array, uint32_t start)
+    {
+        uint32_t lo = 0, hi = array.buckets.size();
+        while (hi - lo > 1)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            if (array.first[mid] <= start)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    /* position, in the given bucket, of the first block not below the given start address */
+    static uint32_t memFitPosition(const MemFitArray &array, uint32_t b, uint32_t start)
+    {
+        const MemFitBucket *bucket = array.buckets[b];
+        uint32_t lo = 0, hi = bucket->count;
+        while (lo < hi)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            if (bucket->start[mid] < start)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    /* bucket and position of the block of the given address, which must exist */
+    static void memFitLocate(const MemFitArray &array, Address address, uint32_t *b, uint32_t *i)
+    {
+        uint32_t start = memFitChunks(address);
+        *b = memFitBucket(array, start);
+        *i = memFitPosition(array, *b, start);
+        require(*i < array.buckets[*b]->count and array.buckets[*b]->start[*i] == start, "a block must exist at the given address");
+    }
+
+    static void memFitAddBucket(MemFitArray &array, uint32_t b, MemFitBucket *bucket)
+    {
+        array.buckets.insert(array.buckets.begin() + b, bucket);
+        array.first.insert(array.first.begin() + b, bucket->start[0]);
+        array.largest.insert(array.largest.begin() + b, 0);
+        memFitLargest(array, b);
+    }
+
+    /* split a full bucket in two halves */
+    static void memFitSplit(MemFitArray &array, uint32_t b)
+    {
+        MemFitBucket *lower = array.buckets[b];
+        MemFitBucket *upper = new MemFitBucket;
+        uint32_t half = lower->count / 2;
+        upper->count = lower->count - half;
+        memcpy(upper->start, &lower->start[half], upper->count * sizeof(uint32_t));
+        memcpy(upper->size, &lower->size[half], upper->count * sizeof(uint32_t));
+        memcpy(upper->node, &lower->node[half], upper->count * sizeof(MemListNode *));
+        lower->count = half;
+
+        memFitLargest(array, b);
+        memFitAddBucket(array, b + 1, upper);
+    }
+
+    static void memFitClear(MemFitArray &array)
+    {
+        for (MemFitBucket *bucket : array.buckets)
+            delete bucket;
+        array.buckets.clear();
+        array.first.clear();
+        array.largest.clear();
+    }
+
+    /* build an array from a list, its buckets half full */
+    static void memFitBuild(MemFitArray &array, MemListNode *head)
+    {
+        memFitClear(array);
+        MemFitBucket *bucket = NULL;
+        for (MemListNode *p = head; p != NULL; p = p->next)
+        {
+            if (bucket == NULL or bucket->count == MEM_FIT_BUCKET / 2)
+            {
+                if (bucket != NULL)
+                    memFitAddBucket(array, array.buckets.size(), bucket);
+                bucket = new MemFitBucket;
+                bucket->count = 0;
+            }
+            bucket->start[bucket->count] = memFitChunks(p->block.address);
+            bucket->size[bucket->count] = memFitChunks(p->block.size);
+            bucket->node[bucket->count] = p;
+            bucket->count++;
+        }
+        if (bucket != NULL)
+            memFitAddBucket(array, array.buckets.size(), bucket);
+    }
+
+// ================================================================================== //
+
+    void memFitReset()
+    {
+        memFitClear(freeArray);
+        memFitClear(occupiedArray);
+    }
+
+    /* build the arrays from the lists */
+    void memFitRebuild()
+    {
+        memFitReset();
+        if (not memFitIndexed())
+            return;
+
+        memFitBuild(freeArray, memFreeHead);
+        memFitBuild(occupiedArray, memOccupiedHead);
+    }
+
+    /* a block was put in the free (or the occupied) list */
+    void memFitInsert(MemListNode *node, bool occupied)
+    {
+        if (not memFitIndexed())
+            return;
+
+        MemFitArray &array = occupied ? occupiedArray : freeArray;
+        uint32_t start = memFitChunks(node->block.address);
+        if (array.buckets.empty())
+        {
+            MemFitBucket *bucket = new MemFitBucket;
+            bucket->count = 1;
+            bucket->start[0] = start;
+            bucket->size[0] = memFitChunks(node->block.size);
+            bucket->node[0] = node;
+            memFitAddBucket(array, 0, bucket);
+            return;
+        }
+
+        uint32_t b = memFitBucket(array, start);
+        if (array.buckets[b]->count == MEM_FIT_BUCKET)
+        {
+            memFitSplit(array, b);
+            b = memFitBucket(array, start);
+        }
+
+        MemFitBucket *bucket = array.buckets[b];
+        uint32_t i = memFitPosition(array, b, start);
+        uint32_t rest = bucket->count - i;
+        memmove(&bucket->start[i + 1], &bucket->start[i], rest * sizeof(uint32_t));
+        memmove(&bucket->size[i + 1], &bucket->size[i], rest * sizeof(uint32_t));
+        memmove(&bucket->node[i + 1], &bucket->node[i], rest * sizeof(MemListNode *));
+        bucket->start[i] = start;
+        bucket->size[i] = memFitChunks(node->block.size);
+        bucket->node[i] = node;
+        bucket->count++;
+
+        if (i == 0)
+            array.first[b] = start;
+        if (bucket->size[i] > array.largest[b])
+            array.largest[b] = bucket->size[i];
+    }
+
+    /* a block is about to leave the free (or the occupied) list */
+    void memFitErase(const MemListNode *node, bool occupied)
+    {
+        if (not memFitIndexed())
+            return;
+
+        MemFitArray &array = occupied ? occupiedArray : freeArray;
+        uint32_t b, i;
+        memFitLocate(array, node->block.address, &b, &i);
+        MemFitBucket *bucket = array.buckets[b];
+        uint32_t size = bucket->size[i];
+        uint32_t rest = bucket->count - i - 1;
+        memmove(&bucket->start[i], &bucket->start[i + 1], rest * sizeof(uint32_t));
+        memmove(&bucket->size[i], &bucket->size[i + 1], rest * sizeof(uint32_t));
+        memmove(&bucket->node[i], &bucket->node[i + 1], rest * sizeof(MemListNode *));
+        bucket->count--;
+
+        if (bucket->count == 0)
+        {
+            delete bucket;
+            array.buckets.erase(array.buckets.begin() + b);
+            array.first.erase(array.first.begin() + b);
+            array.largest.erase(array.largest.begin() + b);
+            return;
+        }
+        if (i == 0)
+            array.first[b] = bucket->start[0];
+        if (size == array.largest[b])
+            memFitLargest(array, b);
+    }
+
+    /* a free block, formerly at the given address, changed its address or size, keeping its place in the list */
+    void memFitUpdate(const MemListNode *node, Address address)
+    {
+        if (not memFitIndexed())
+            return;
+
+        uint32_t b, i;
+        memFitLocate(freeArray, address, &b, &i);
+        MemFitBucket *bucket = freeArray.buckets[b];
+        uint32_t size = bucket->size[i];
+        bucket->start[i] = memFitChunks(node->block.address);
+        bucket->size[i] = memFitChunks(node->block.size);
+
+        if (i == 0)
+            freeArray.first[b] = bucket->start[0];
+        if (bucket->size[i] > freeArray.largest[b])
+            freeArray.largest[b] = bucket->size[i];
+        else if (size == freeArray.largest[b])
+            memFitLargest(freeArray, b);
+    }
+
+    /* the first free block of at least the given size, or NULL if there is none */
+    MemListNode *memFitFind(MemSize size)
+    {
+        uint32_t chunks = memFitChunks(size);
+        uint32_t b = memFitScan(freeArray.largest.data(), freeArray.largest.size(), chunks);
+        if (b == freeArray.buckets.size())
+            return NULL;
+        const MemFitBucket *bucket = freeArray.buckets[b];
+        return bucket->node[memFitScan(bucket->size, bucket->count, chunks)];
+    }
+
+    /*
+     * the blocks of the free (or the occupied) list right below the given address,
+     * and at or right above it; either may be NULL
+     */
+    void memFitNeighbours(Address address, bool occupied, MemListNode **prev, MemListNode **next)
+    {
+        const MemFitArray &array = occupied ? occupiedArray : freeArray;
+        *prev = *next = NULL;
+        if (array.buckets.empty())
+            return;
+
+        uint32_t start = memFitChunks(address);
+        uint32_t b = memFitBucket(array, start);
+        uint32_t i = memFitPosition(array, b, start);
+        if (i < array.buckets[b]->count)
+            *next = array.buckets[b]->node[i];
+        else if (b + 1 < array.buckets.size())
+            *next = array.buckets[b + 1]->node[0];
+        if (i > 0)
+            *prev = array.buckets[b]->node[i - 1];
+        else if (b > 0)
+            *prev = array.buckets[b - 1]->node[array.buckets[b - 1]->count - 1];
+    }
+
+// ================================================================================== //
+
+    void memFirstFitArray(bool enable)
+    {
+        soProbe(520, "%s(%s)\n", __func__, enable ? "true" : "false");
+
+        memFitArrayEnabled = enable;
+        memFitRebuild();
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
@@ -3,96 +3,114 @@
 
 namespace group {
 
-    void sortFreeBlocksByAddress() {
-        if (memFreeHead == nullptr || memFreeHead->next == nullptr) return;
+    extern bool memMergeDeferred;
+    bool memFitIndexed();
+
+    void memStatsInsert(MemSize size);
+    void memStatsErase(MemSize size);
+    void memBitmapMark(Address address, MemSize size, bool occupied);
+    void memFitInsert(MemListNode *node, bool occupied);
+    void memFitErase(const MemListNode *node, bool occupied);
+    void memFitUpdate(const MemListNode *node, Address address);
+    void memFitNeighbours(Address address, bool occupied, MemListNode **prev, MemListNode **next);
+
+    // Merge node with its successor in the free list, if they are adjacent
+    static bool mergeWithNext(MemListNode *current) {
+        MemListNode *next = current->next;
+        if (next == nullptr || current->block.address + current->block.size != next->block.address) {
+            return false;
+        }
 
-        bool swapped;
-        do {
-            swapped = false;
-            MemListNode *current = memFreeHead;
-            while (current->next != nullptr) {
-                if (current->block.address > current->next->block.address) {
-                    // Swap the blocks
-                    MemBlock tempBlock = current->block;
-                    current->block = current->next->block;
-                    current->next->block = tempBlock;
-                    swapped = true;
-                }
-                current = current->next;
-            }
-        } while (swapped);
-    }
+        memStatsErase(current->block.size);
+        memStatsErase(next->block.size);
+        memFitErase(next, false);
+        current->block.size += next->block.size;
+        memStatsInsert(current->block.size);
+        memFitUpdate(current, current->block.address);
 
+        current->next = next->next;
+        if (next->next != nullptr) {
+            next->next->prev = current;
+        }
+        delete next;
+        return true;
+    }
 
+    // Merge every pair of adjacent blocks of the (address sorted) free list, in a single pass
     void mergeFreeBlocks() {
-        if (memFreeHead == nullptr) return;
-
-        // Sort the blocks by address
-        sortFreeBlocksByAddress();
-
         MemListNode *current = memFreeHead;
-        while (current != nullptr && current->next != nullptr) {
-            Address currentEnd = current->block.address + current->block.size;
-
-            // Merge with adjacent blocks
-            while (current->next != nullptr && currentEnd == current->next->block.address) {
-                current->block.size += current->next->block.size;
-                MemListNode *toDelete = current->next;
-                current->next = toDelete->next;
-                if (toDelete->next != nullptr) {
-                    toDelete->next->prev = current;
-                }
-                delete toDelete;
-
-                // Update the end address after merging
-                currentEnd = current->block.address + current->block.size;
+        while (current != nullptr) {
+            if (not mergeWithNext(current)) {
+                current = current->next;
             }
-
-            current = current->next;
         }
     }
 
     void memFirstFitFree(Address address) {
-        soProbe(508, "%s(%u)\n", __func__, address);
-
-        // Ensure that the occupied list is not NULL
-        require(memOccupiedHead != nullptr, "Occupied list should contain nodes");
+        soProbe(508, "%s(%#" FMT_ADDR ")\n", __func__, address);
 
         // Search for the block with the given address in the occupied list
         MemListNode *current = memOccupiedHead;
-        MemListNode *prev = nullptr;
-
-        while (current != nullptr) {
-            if (current->block.address == address) {
-                break;
+        if (memFitIndexed()) {
+            MemListNode *below;
+            memFitNeighbours(address, true, &below, &current);
+        } else {
+            while (current != nullptr && current->block.address != address) {
+                current = current->next;
             }
-            prev = current;
-            current = current->next;
         }
 
         // Handle the block not found case
-        require(current != nullptr, "Block not found in the occupied list");
+        if (current == nullptr || current->block.address != address) {
+            throw Exception(EINVAL, __func__);
+        }
+        memFitErase(current, true);
 
         // Remove the block from the occupied list
-        if (prev != nullptr) {
-            prev->next = current->next;
+        if (current->prev != nullptr) {
+            current->prev->next = current->next;
         } else {
             memOccupiedHead = current->next;
         }
         if (current->next != nullptr) {
-            current->next->prev = prev;
+            current->next->prev = current->prev;
         }
 
-        // Add the block to the free list
-        current->next = memFreeHead;
-        if (memFreeHead != nullptr) {
-            memFreeHead->prev = current;
+        // Add the block to the free list, keeping it sorted by address
+        MemListNode *prev = nullptr;
+        MemListNode *next = memFreeHead;
+        if (memFitIndexed()) {
+            memFitNeighbours(address, false, &prev, &next);
+        } else {
+            while (next != nullptr && next->block.address < address) {
+                prev = next;
+                next = next->next;
+            }
         }
-        current->prev = nullptr;
-        memFreeHead = current;
 
-        // Optionally, merge adjacent free blocks to prevent fragmentation
-        mergeFreeBlocks();
+        current->block.pid = 0;
+        current->prev = prev;
+        current->next = next;
+        if (prev != nullptr) {
+            prev->next = current;
+        } else {
+            memFreeHead = current;
+        }
+        if (next != nullptr) {
+            next->prev = current;
+        }
+        memStatsInsert(current->block.size);
+        memBitmapMark(current->block.address, current->block.size, false);
+        memFitInsert(current, false);
+
+        // Merge with the adjacent free blocks
+        // (left to memDeferMerge, if merging is deferred)
+        if (not memMergeDeferred) {
+            mergeWithNext(current);
+            if (prev != nullptr) {
+                mergeWithNext(prev);
+            }
+        }
     }
 
-} // end of namespace group
\ No newline at end of file
+} // end of namespace group
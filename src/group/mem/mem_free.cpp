@@ -1,5 +1,5 @@
 /*
- *  \author ...
+ *  \author Gonçalo Oliveira 108405
  */
 
 #include "somm23.h"
@@ -22,8 +22,12 @@ namespace group
 
                     if (memParameters.policy == FirstFit) {
                         memFirstFitFree(blockAddress);
-                    } else if (memParameters.policy == BuddySystem) {
+                    } else if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest) {
                         memBuddySystemFree(blockAddress);
+                    } else if (memParameters.policy == Slab) {
+                        memSlabFree(blockAddress);
+                    } else {
+                        memTlsfFree(blockAddress);
                     }
                 }
             } catch (Exception &e) {
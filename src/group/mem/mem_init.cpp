@@ -1,5 +1,5 @@
 /*
- *  \author ...
+ *  \author Gonçalo Oliveira 108405
  */
 
 #include "somm23.h"
@@ -9,65 +9,86 @@
 namespace group 
 {
 
+    void memStatsReset();
+    void memStatsInsert(MemSize size);
+    void memTlsfInit(Address address, MemSize size);
+    MemTreeNode *memBuddyForestInit(Address address, MemSize size);
+    void memBitmapRebuild();
+    void memFitRebuild();
+
 // ================================================================================== //
 
-    void memInit(uint32_t mSize, uint32_t osSize, uint32_t cSize, AllocationPolicy policy) 
+    void memInit(MemSize mSize, MemSize osSize, MemSize cSize, AllocationPolicy policy) 
     {
-        const char *pas = policy == FirstFit ? "FirstFit" : policy == BuddySystem ? "BuddySystem" : "Unkown";
-        soProbe(501, "%s(%#x, %#x, %#x, %s)\n", __func__, mSize, osSize, cSize, pas);
+        const char *pas = policy == FirstFit ? "FirstFit" : policy == BuddySystem ? "BuddySystem" : policy == Slab ? "Slab" : policy == Tlsf ? "Tlsf" : policy == BuddyForest ? "BuddyForest" : "Unkown";
+        soProbe(501, "%s(%#" FMT_ADDR ", %#" FMT_ADDR ", %#" FMT_ADDR ", %s)\n", __func__, mSize, osSize, cSize, pas);
 
         require(mSize > osSize, "memory must be bigger than the one use by OS");
         require((mSize % cSize) == 0, "memory size must be a multiple of chunck size");
         require((osSize % cSize) == 0, "memory size for OS must be a multiple of chunck size");
-        require(policy == FirstFit or policy == BuddySystem, "policy must be FirstFit or BuddySystem");
+        require(mSize / cSize <= UINT32_MAX, "memory size, in chuncks, must fit in 32 bits");
+        require(policy == FirstFit or policy == BuddySystem or policy == Slab or policy == Tlsf or policy == BuddyForest,
+                "policy must be FirstFit, BuddySystem, Slab, Tlsf or BuddyForest");
+        require(policy != BuddyForest or (cSize & (cSize - 1)) == 0, "chunk size must be a power of two for BuddyForest");
 
         /* TODO POINT: Replace next instruction with your code */
-        try {
-            // Memory Parameters Setting
-            memParameters.chunkSize = cSize;
-            memParameters.totalSize = mSize;
-            memParameters.kernelSize = osSize;
-            memParameters.policy = policy;
-    
-            // Handling for FirstFit policy
-            if (policy == FirstFit)
-            {
-                MemListNode *headFree = (MemListNode *) malloc(sizeof(MemListNode));
-                headFree->block.pid = 0;
-                headFree->block.size = mSize - osSize;
-                headFree->block.address = osSize;
-                headFree->prev = NULL;
-                headFree->next = NULL;
-                memFreeHead = headFree;
-    
-                MemListNode *headOccupied = (MemListNode *) malloc(sizeof(MemListNode));
-                headOccupied->block.pid = 0;
-                headOccupied->block.size = 0;
-                headOccupied->block.address = osSize;
-                headOccupied->prev = NULL;
-                headOccupied->next = NULL;
-                memOccupiedHead = headOccupied;
-    
-                memTreeRoot = NULL;
-            }
-            // Handling for BuddySystem policy
-            else if (policy == BuddySystem)
-            {
-                MemTreeNode *rootNode = (MemTreeNode *) malloc(sizeof(MemTreeNode));
-                rootNode->state = FREE;
-                rootNode->block.pid = 0;
-                rootNode->block.address = osSize;
-                rootNode->block.size = mSize - osSize;
-                rootNode->left = NULL;
-                rootNode->right = NULL;
-                memTreeRoot = rootNode;
-    
-                memFreeHead = NULL;
-                memOccupiedHead = NULL;
-            }
-        } catch (const std::exception &e) {
-            throw Exception(ENOSYS, __func__);
+        memParameters.chunkSize = cSize;
+        memParameters.totalSize = mSize;
+        memParameters.kernelSize = osSize;
+        memParameters.policy = policy;
+
+        memStatsReset();
+
+        /* the memory above the one used by the OS is a single free block (with no slabs yet) */
+        if (policy == FirstFit or policy == Slab)
+        {
+            MemListNode *node = new MemListNode;
+            node->block.pid = 0;
+            node->block.size = mSize - osSize;
+            node->block.address = osSize;
+            node->prev = NULL;
+            node->next = NULL;
+            memFreeHead = node;
+            memOccupiedHead = NULL;
+            memTreeRoot = NULL;
+            memStatsInsert(node->block.size);
+        }
+        /* for the buddy system, the largest power of two that fits in it */
+        else if (policy == BuddySystem)
+        {
+            MemSize size = (MemSize)1 << (63 - __builtin_clzll(mSize - osSize));
+            MemTreeNode *root = new MemTreeNode;
+            root->state = FREE;
+            root->block.pid = 0;
+            root->block.size = size;
+            root->block.address = osSize;
+            root->left = NULL;
+            root->right = NULL;
+            memTreeRoot = root;
+            memFreeHead = NULL;
+            memOccupiedHead = NULL;
+            memStatsInsert(size);
         }
+        /* for the buddy forest, the biggest aligned powers of two that cover it */
+        else if (policy == BuddyForest)
+        {
+            memTreeRoot = memBuddyForestInit(osSize, mSize - osSize);
+            memFreeHead = NULL;
+            memOccupiedHead = NULL;
+        }
+        /* for TLSF, a single free block of its own */
+        else
+        {
+            memFreeHead = NULL;
+            memOccupiedHead = NULL;
+            memTreeRoot = NULL;
+            memTlsfInit(osSize, mSize - osSize);
+            memStatsInsert(mSize - osSize);
+        }
+
+        /* and, if enabled, the shadow bitmap, all free, and the first fit array */
+        memBitmapRebuild();
+        memFitRebuild();
     }
 
 // ================================================================================== //
@@ -0,0 +1,34 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+namespace group
+{
+
+// ================================================================================== //
+
+    /* number of free blocks per order the buddy system leaves unmerged; 0 if it merges eagerly */
+    uint32_t memLazyWatermark = 0;
+
+    void memBuddySystemMergeAll(MemTreeNode *node);
+
+// ================================================================================== //
+
+    void memLazyMerge(uint32_t watermark)
+    {
+        soProbe(517, "%s(%u)\n", __func__, watermark);
+
+        /* the blocks left unmerged so far are merged, as an eager buddy system would have done */
+        if (memLazyWatermark != 0 and memTreeRoot != NULL)
+            memBuddySystemMergeAll(memTreeRoot);
+
+        memLazyWatermark = watermark;
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
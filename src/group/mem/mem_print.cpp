@@ -1,5 +1,5 @@
 /*
- *  \author ...
+ *  \author Gonçalo Oliveira 108405
  */
 
 #include "somm23.h"
@@ -7,64 +7,160 @@
 #include <stdio.h>
 #include <stdint.h>
 
+#include <vector>
+
 namespace group
 {
+    uint32_t memSlabObjects(Address address, MemBlock *blocks);
+    void memTlsfBlocks(std::vector<MemBlock> &blocks);
+
+    static void memPrintBlock(FILE *fout, const MemBlock &block)
+    {
+        if (block.pid == 0)
+            fprintf(fout, "|   ---   | %#11" FMT_ADDR " | %10" FMT_SIZE " |\n", block.address, block.size);
+        else
+            fprintf(fout, "| %7u | %#11" FMT_ADDR " | %10" FMT_SIZE " |\n", block.pid, block.address, block.size);
+    }
+
     // Helper function to print the linked list
-    void memPrintList(FILE *fout, MemListNode *head)
+    static void memPrintList(FILE *fout, MemListNode *head)
+    {
+        for (MemListNode *current = head; current != nullptr; current = current->next)
+            memPrintBlock(fout, current->block);
+    }
+
+    // Helper function to print the leaves of the tree in the given state, in depth-first order
+    static void memPrintTree(FILE *fout, MemTreeNode *node, MemTreeNodeType state)
     {
-        if (head == nullptr)
+        if (node == nullptr)
+            return;
+        if (node->state == SPLITTED)
         {
-            fprintf(fout, "|   ---   |     ---     |     ---    |\n");
+            memPrintTree(fout, node->left, state);
+            memPrintTree(fout, node->right, state);
         }
-        else
+        else if (node->state == state)
+        {
+            memPrintBlock(fout, node->block);
+        }
+    }
+
+    // Helper function to print the occupied blocks of the slab policy, with the objects of the slabs in place of them
+    static void memPrintSlabOccupied(FILE *fout)
+    {
+        MemBlock objects[MEM_SLAB_OBJECTS];
+        for (MemListNode *current = memOccupiedHead; current != nullptr; current = current->next)
         {
-            MemListNode *current = head;
-            while (current != nullptr)
+            if (current->block.pid != MEM_SLAB_PID)
             {
-                if (current->block.size != 0)
-                {
-                    if (current->block.pid == 0) // If PID is 0, it's a free block
-                    {
-                        fprintf(fout, "|   ---   |   0x%X |   %u   |\n",
-                                current->block.address,
-                                current->block.size);
-                    }
-                    else
-                    {
-                        fprintf(fout, "|    %u    |   0x%X |   %u   |\n",
-                                current->block.pid,
-                                current->block.address,
-                                current->block.size);
-                    }
-                }
-                current = current->next;
+                memPrintBlock(fout, current->block);
+                continue;
             }
+            uint32_t n = memSlabObjects(current->block.address, objects);
+            for (uint32_t i = 0; i < n; i++)
+                if (objects[i].pid != 0)
+                    memPrintBlock(fout, objects[i]);
         }
     }
 
-    void memPrint(FILE *fout)
+    // Helper function to print the free blocks of the slab policy, merging the free list with the free objects of the slabs
+    static void memPrintSlabFree(FILE *fout)
     {
-        soProbe(503, "%s(\"%p\")\n", __func__, fout);
-        require(fout != NULL and fileno(fout) != -1, "fout must be a valid file stream");
+        MemBlock objects[MEM_SLAB_OBJECTS];
+        MemListNode *free = memFreeHead;
+        for (MemListNode *current = memOccupiedHead; current != nullptr; current = current->next)
+        {
+            if (current->block.pid != MEM_SLAB_PID)
+                continue;
+            for (; free != nullptr and free->block.address < current->block.address; free = free->next)
+                memPrintBlock(fout, free->block);
+            uint32_t n = memSlabObjects(current->block.address, objects);
+            for (uint32_t i = 0; i < n; i++)
+                if (objects[i].pid == 0)
+                    memPrintBlock(fout, objects[i]);
+        }
+        memPrintList(fout, free);
+    }
 
-        // Print occupied blocks
-        fprintf(fout, "+====================================+\n");
-        fprintf(fout, "|   FirstFit memory occupied blocks  |\n");
-        fprintf(fout, "+---------+-------------+------------+\n");
-        fprintf(fout, "|   PID   |   address   |    size    |\n");
-        fprintf(fout, "+---------+-------------+------------+\n");
-        memPrintList(fout, memOccupiedHead);
-        fprintf(fout, "+====================================+\n");
-        fprintf(fout, "\n");
+    // Helper function to print the blocks of the TLSF policy that are free or occupied, as asked for
+    static void memPrintTlsf(FILE *fout, bool free)
+    {
+        std::vector<MemBlock> blocks;
+        memTlsfBlocks(blocks);
+        for (const MemBlock &block : blocks)
+            if ((block.pid == 0) == free)
+                memPrintBlock(fout, block);
+    }
 
-        // Print free blocks
+    static void memPrintHeader(FILE *fout, const char *title)
+    {
         fprintf(fout, "+====================================+\n");
-        fprintf(fout, "|     FirstFit memory free blocks    |\n");
+        fprintf(fout, "|%s|\n", title);
         fprintf(fout, "+---------+-------------+------------+\n");
         fprintf(fout, "|   PID   |   address   |    size    |\n");
         fprintf(fout, "+---------+-------------+------------+\n");
-        memPrintList(fout, memFreeHead);
+    }
+
+    static void memPrintFooter(FILE *fout)
+    {
         fprintf(fout, "+====================================+\n");
         fprintf(fout, "\n");
     }
-} // end of namespace group
\ No newline at end of file
+
+    void memPrint(FILE *fout)
+    {
+        soProbe(503, "%s(\"%p\")\n", __func__, fout);
+        require(fout != NULL and fileno(fout) != -1, "fout must be a valid file stream");
+
+        if (memParameters.policy == FirstFit)
+        {
+            memPrintHeader(fout, "   FirstFit memory occupied blocks  ");
+            memPrintList(fout, memOccupiedHead);
+            memPrintFooter(fout);
+
+            memPrintHeader(fout, "     FirstFit memory free blocks    ");
+            memPrintList(fout, memFreeHead);
+            memPrintFooter(fout);
+        }
+        else if (memParameters.policy == Slab)
+        {
+            memPrintHeader(fout, "     Slab memory occupied blocks    ");
+            memPrintSlabOccupied(fout);
+            memPrintFooter(fout);
+
+            memPrintHeader(fout, "       Slab memory free blocks      ");
+            memPrintSlabFree(fout);
+            memPrintFooter(fout);
+        }
+        else if (memParameters.policy == Tlsf)
+        {
+            memPrintHeader(fout, "     Tlsf memory occupied blocks    ");
+            memPrintTlsf(fout, false);
+            memPrintFooter(fout);
+
+            memPrintHeader(fout, "       Tlsf memory free blocks      ");
+            memPrintTlsf(fout, true);
+            memPrintFooter(fout);
+        }
+        else if (memParameters.policy == BuddyForest)
+        {
+            memPrintHeader(fout, " BuddyForest memory occupied blocks ");
+            memPrintTree(fout, memTreeRoot, OCCUPIED);
+            memPrintFooter(fout);
+
+            memPrintHeader(fout, "   BuddyForest memory free blocks   ");
+            memPrintTree(fout, memTreeRoot, FREE);
+            memPrintFooter(fout);
+        }
+        else
+        {
+            memPrintHeader(fout, " BuddySystem memory occupied blocks ");
+            memPrintTree(fout, memTreeRoot, OCCUPIED);
+            memPrintFooter(fout);
+
+            memPrintHeader(fout, "   BuddySystem memory free blocks   ");
+            memPrintTree(fout, memTreeRoot, FREE);
+            memPrintFooter(fout);
+        }
+    }
+} // end of namespace group
@@ -0,0 +1,301 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace group
+{
+
+    void memStatsInsert(MemSize size);
+    void memStatsErase(MemSize size);
+
+// ================================================================================== //
+
+    /*
+     * A slab is a block taken from the first fit lists, holding MEM_SLAB_OBJECTS objects
+     * of the same size, which is one of the first MEM_SLAB_CLASSES multiples of the chunk size.
+     * In the occupied list, a slab is a block of PID MEM_SLAB_PID.
+     * The slabs of a class with free objects are kept in a list, so allocating an object
+     * of a class size takes a slab from the head of it and the lowest free object of the slab.
+     * Freeing an object finds its slab through a hash table of the allocated objects,
+     * and the slabs are kept sorted by address, so no address within a slab is freed as a block.
+     * A slab getting empty is returned to the first fit lists, except the last one of its class,
+     * which is kept, unless memory is short.
+     */
+    struct MemSlab {
+        Address address;                    // start address of the slab
+        MemSize objectSize;                 // size of its objects
+        uint32_t freeCount;                 // number of free objects
+        uint32_t freeMask;                  // bit i is set if object i is free
+        uint32_t pid[MEM_SLAB_OBJECTS];     // PID of every object, 0 if free
+        MemSlab *prev;                      // previous slab with free objects of the same class
+        MemSlab *next;                      // next slab with free objects of the same class
+    };
+
+    static_assert(MEM_SLAB_OBJECTS <= 32, "the free objects of a slab are a 32-bit mask");
+
+    static MemSlab *partialHead[MEM_SLAB_CLASSES];              // slabs with free objects, per class
+    static MemSlab *emptySlab[MEM_SLAB_CLASSES];                // the empty slab kept, per class
+    static std::map<Address, MemSlab *> slabs;                  // slabs, by start address
+    static std::unordered_map<Address, MemSlab *> objects;      // slabs of the allocated objects, by object address
+
+// ================================================================================== //
+
+    static inline uint32_t memSlabClass(const MemSlab *slab)
+    {
+        return slab->objectSize / memParameters.chunkSize - 1;
+    }
+
+    static void memSlabLink(MemSlab *slab)
+    {
+        MemSlab *&head = partialHead[memSlabClass(slab)];
+        slab->prev = NULL;
+        slab->next = head;
+        if (head != NULL)
+            head->prev = slab;
+        head = slab;
+    }
+
+    static void memSlabUnlink(MemSlab *slab)
+    {
+        MemSlab *&head = partialHead[memSlabClass(slab)];
+        if (slab->prev != NULL)
+            slab->prev->next = slab->next;
+        else
+            head = slab->next;
+        if (slab->next != NULL)
+            slab->next->prev = slab->prev;
+        slab->prev = slab->next = NULL;
+    }
+
+    /* a new slab for objects of the given size, carved from the first fit lists, or NULL if there is no room */
+    static MemSlab *memSlabCreate(MemSize objectSize)
+    {
+        Address address = memFirstFitAlloc(MEM_SLAB_PID, objectSize * MEM_SLAB_OBJECTS);
+        if (address == NULL_ADDRESS)
+            return NULL;
+
+        MemSlab *slab = new MemSlab;
+        slab->address = address;
+        slab->objectSize = objectSize;
+        slab->freeCount = MEM_SLAB_OBJECTS;
+        slab->freeMask = (uint32_t)((1ull << MEM_SLAB_OBJECTS) - 1);
+        for (uint32_t i = 0; i < MEM_SLAB_OBJECTS; i++)
+        {
+            slab->pid[i] = 0;
+            memStatsInsert(objectSize);
+        }
+        slabs[address] = slab;
+        memSlabLink(slab);
+        return slab;
+    }
+
+    /* give an empty slab back to the first fit lists */
+    static void memSlabRelease(MemSlab *slab)
+    {
+        memSlabUnlink(slab);
+        for (uint32_t i = 0; i < MEM_SLAB_OBJECTS; i++)
+            memStatsErase(slab->objectSize);
+        slabs.erase(slab->address);
+        memFirstFitFree(slab->address);
+        delete slab;
+    }
+
+    /* give the kept empty slabs back to the first fit lists; return true if there was any */
+    static bool memSlabReclaim()
+    {
+        bool any = false;
+        for (uint32_t c = 0; c < MEM_SLAB_CLASSES; c++)
+        {
+            if (emptySlab[c] != NULL)
+            {
+                memSlabRelease(emptySlab[c]);
+                emptySlab[c] = NULL;
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    /* first fit allocation, after giving the kept empty slabs back if needed */
+    static Address memSlabFallback(uint32_t pid, MemSize size)
+    {
+        Address address = memFirstFitAlloc(pid, size);
+        if (address == NULL_ADDRESS and memSlabReclaim())
+            address = memFirstFitAlloc(pid, size);
+        return address;
+    }
+
+// ================================================================================== //
+
+    void memSlabReset()
+    {
+        for (std::pair<const Address, MemSlab *> &s : slabs)
+            delete s.second;
+        slabs.clear();
+        objects.clear();
+        for (uint32_t c = 0; c < MEM_SLAB_CLASSES; c++)
+        {
+            partialHead[c] = NULL;
+            emptySlab[c] = NULL;
+        }
+    }
+
+    /* the objects of the slab at the given address, PID 0 if free; return their number */
+    uint32_t memSlabObjects(Address address, MemBlock *blocks)
+    {
+        std::map<Address, MemSlab *>::iterator it = slabs.find(address);
+        require(it != slabs.end(), "a slab must exist at the given address");
+
+        MemSlab *slab = it->second;
+        for (uint32_t i = 0; i < MEM_SLAB_OBJECTS; i++)
+            blocks[i] = { slab->pid[i], slab->objectSize, slab->address + i * slab->objectSize };
+        return MEM_SLAB_OBJECTS;
+    }
+
+    /*
+     * append the objects of all slabs to blocks, MEM_SLAB_OBJECTS per slab, the full ones first
+     * and then the lists of every class from tail to head, so that restoring them in order rebuilds the lists
+     */
+    void memSlabSnapshot(std::vector<MemBlock> &blocks)
+    {
+        for (MemListNode *p = memOccupiedHead; p != NULL; p = p->next)
+        {
+            if (p->block.pid == MEM_SLAB_PID and slabs[p->block.address]->freeCount == 0)
+            {
+                blocks.resize(blocks.size() + MEM_SLAB_OBJECTS);
+                memSlabObjects(p->block.address, &blocks[blocks.size() - MEM_SLAB_OBJECTS]);
+            }
+        }
+        for (uint32_t c = 0; c < MEM_SLAB_CLASSES; c++)
+        {
+            MemSlab *tail = partialHead[c];
+            while (tail != NULL and tail->next != NULL)
+                tail = tail->next;
+            for (MemSlab *s = tail; s != NULL; s = s->prev)
+            {
+                blocks.resize(blocks.size() + MEM_SLAB_OBJECTS);
+                memSlabObjects(s->address, &blocks[blocks.size() - MEM_SLAB_OBJECTS]);
+            }
+        }
+    }
+
+    /* rebuild a slab, already in the occupied list, from its objects, as given by memSlabSnapshot */
+    void memSlabRestore(const MemBlock *blocks)
+    {
+        MemSlab *slab = new MemSlab;
+        slab->address = blocks[0].address;
+        slab->objectSize = blocks[0].size;
+        slab->freeCount = 0;
+        slab->freeMask = 0;
+        slab->prev = slab->next = NULL;
+        slabs[slab->address] = slab;
+
+        for (uint32_t i = 0; i < MEM_SLAB_OBJECTS; i++)
+        {
+            slab->pid[i] = blocks[i].pid;
+            if (blocks[i].pid == 0)
+            {
+                slab->freeCount++;
+                slab->freeMask |= 1u << i;
+                memStatsInsert(slab->objectSize);
+            }
+            else
+            {
+                objects[blocks[i].address] = slab;
+            }
+        }
+
+        if (slab->freeCount != 0)
+            memSlabLink(slab);
+        if (slab->freeCount == MEM_SLAB_OBJECTS and emptySlab[memSlabClass(slab)] == NULL)
+            emptySlab[memSlabClass(slab)] = slab;
+    }
+
+// ================================================================================== //
+
+    Address memSlabAlloc(uint32_t pid, MemSize size)
+    {
+        soProbe(513, "%s(%u, %#" FMT_ADDR ")\n", __func__, pid, size);
+
+        require(pid > 0 and pid != MEM_SLAB_PID, "a valid process ID must be greater than zero and not the one of slabs");
+        require(size, "the size of a memory segment must be greater than zero");
+
+        /* odd sizes go to the first fit lists */
+        MemSize chunks = size / memParameters.chunkSize;
+        if (size % memParameters.chunkSize != 0 or chunks > MEM_SLAB_CLASSES)
+            return memSlabFallback(pid, size);
+
+        uint32_t c = chunks - 1;
+        MemSlab *slab = partialHead[c];
+        if (slab == NULL and (slab = memSlabCreate(size)) == NULL)
+            return memSlabFallback(pid, size);
+
+        if (slab == emptySlab[c])
+            emptySlab[c] = NULL;
+
+        uint32_t i = __builtin_ctz(slab->freeMask);
+        slab->freeMask &= ~(1u << i);
+        slab->pid[i] = pid;
+        if (--slab->freeCount == 0)
+            memSlabUnlink(slab);
+        memStatsErase(size);
+
+        Address address = slab->address + i * size;
+        objects[address] = slab;
+        return address;
+    }
+
+// ================================================================================== //
+
+    void memSlabFree(Address address)
+    {
+        soProbe(514, "%s(%#" FMT_ADDR ")\n", __func__, address);
+
+        std::unordered_map<Address, MemSlab *>::iterator it = objects.find(address);
+        if (it == objects.end())
+        {
+            /* not an allocated object, so it must not be within a slab, a slab being freed with its last object */
+            std::map<Address, MemSlab *>::iterator s = slabs.upper_bound(address);
+            if (s != slabs.begin())
+            {
+                --s;
+                if (address < s->first + s->second->objectSize * MEM_SLAB_OBJECTS)
+                    throw Exception(EINVAL, __func__);
+            }
+
+            /* so a block of the first fit lists */
+            memFirstFitFree(address);
+            return;
+        }
+
+        MemSlab *slab = it->second;
+        objects.erase(it);
+
+        uint32_t i = (address - slab->address) / slab->objectSize;
+        slab->pid[i] = 0;
+        slab->freeMask |= 1u << i;
+        memStatsInsert(slab->objectSize);
+        if (slab->freeCount++ == 0)
+            memSlabLink(slab);
+
+        if (slab->freeCount == MEM_SLAB_OBJECTS)
+        {
+            uint32_t c = memSlabClass(slab);
+            if (emptySlab[c] == NULL)
+                emptySlab[c] = slab;
+            else
+                memSlabRelease(slab);
+        }
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
@@ -0,0 +1,102 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace group
+{
+
+// ================================================================================== //
+
+    /*
+     * Statistics of the free blocks, kept up to date by the allocation and free functions,
+     * every time a free block appears, disappears, is splitted or merged.
+     * Besides the number of free blocks per size class, in the histogram, the bytes per class
+     * and a mask of the classes with free blocks are kept, so every update takes constant time
+     * and the largest free block is taken from the highest class: its size is exact if the class
+     * has a single block, or only blocks whose size is a power of two, as with the buddy policies,
+     * and otherwise an upper bound, below the next power of two.
+     */
+    static MemStats stats;
+    static MemSize classBytes[8 * sizeof(MemSize)];
+    static uint64_t classMask;
+
+    static inline uint32_t memStatsClass(MemSize size)
+    {
+        return 63 - __builtin_clzll(size);
+    }
+
+    void memStatsReset()
+    {
+        memset(&stats, 0, sizeof(stats));
+        memset(classBytes, 0, sizeof(classBytes));
+        classMask = 0;
+    }
+
+    /* a free block of the given size appeared */
+    void memStatsInsert(MemSize size)
+    {
+        if (size == 0)
+            return;
+        uint32_t cls = memStatsClass(size);
+        stats.freeBlocks++;
+        stats.freeBytes += size;
+        stats.histogram[cls]++;
+        classBytes[cls] += size;
+        classMask |= 1ull << cls;
+    }
+
+    /* a free block of the given size disappeared */
+    void memStatsErase(MemSize size)
+    {
+        if (size == 0)
+            return;
+        uint32_t cls = memStatsClass(size);
+        require(stats.histogram[cls] != 0 and classBytes[cls] >= size, "a free block of the given size must exist");
+        stats.freeBlocks--;
+        stats.freeBytes -= size;
+        classBytes[cls] -= size;
+        if (--stats.histogram[cls] == 0)
+            classMask &= ~(1ull << cls);
+    }
+
+    /* number of free blocks of the given size class, the position of the highest bit of their sizes */
+    uint32_t memStatsCount(uint32_t cls)
+    {
+        return stats.histogram[cls];
+    }
+
+    /* total amount of free memory, read without probing */
+    MemSize memStatsFreeBytes()
+    {
+        return stats.freeBytes;
+    }
+
+// ================================================================================== //
+
+    void memGetStats(MemStats *s)
+    {
+        soProbe(511, "%s(%p)\n", __func__, s);
+
+        require(s != NULL, "s must be a valid pointer to a MemStats variable");
+
+        stats.largestFree = 0;
+        if (classMask != 0)
+        {
+            /* the other blocks of the highest class have at least its lower bound */
+            uint32_t cls = 63 - __builtin_clzll(classMask);
+            MemSize lower = (MemSize)1 << cls;
+            stats.largestFree = classBytes[cls] - (stats.histogram[cls] - 1) * lower;
+            if (stats.largestFree > 2 * lower - 1)
+                stats.largestFree = 2 * lower - 1;
+        }
+        *s = stats;
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
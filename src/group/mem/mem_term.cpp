@@ -1,5 +1,5 @@
 /*
- *  \author ...
+ *  \author Gonçalo Oliveira 108405
  */
 
 #include "somm23.h"
@@ -7,6 +7,15 @@
 namespace group 
 {
 
+    extern bool memMergeDeferred;
+    void memStatsReset();
+    void memSlabReset();
+    void memTlsfReset();
+    void memBuddyForestReset();
+    void memBitmapReset();
+    void memFitReset();
+    void memCompactReset();
+
 // ================================================================================== //
     // Helper function to recursively release memory in the binary tree
     void memTermHelper(MemTreeNode* node)
@@ -43,9 +52,17 @@ namespace group
         if (memTreeRoot != nullptr)
         {
             memTermHelper(memTreeRoot);
-            delete memTreeRoot;
             memTreeRoot = nullptr;
         }
+
+        memSlabReset();
+        memTlsfReset();
+        memBuddyForestReset();
+        memBitmapReset();
+        memFitReset();
+        memCompactReset();
+        memMergeDeferred = false;
+        memStatsReset();
     }
 
 // ================================================================================== //
@@ -0,0 +1,393 @@
+/*
+ *  \author Gonçalo Oliveira 108405
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace group
+{
+
+    extern bool memMergeDeferred;
+
+    void memStatsInsert(MemSize size);
+    void memStatsErase(MemSize size);
+    void memBitmapMark(Address address, MemSize size, bool occupied);
+
+// ================================================================================== //
+
+    /*
+     * Every block, free or occupied, is a node of a list sorted by address, so the
+     * neighbours of a block, to be merged with, are known in constant time.
+     * Free blocks are also kept in lists per size class, measured in chunks:
+     * sizes below 1 << MEM_TLSF_SECOND_LEVEL chunks have a class each, while every
+     * other power of two range is split into 1 << MEM_TLSF_SECOND_LEVEL classes.
+     * A bitmap of the first level (power of two) and one per first level of the
+     * second level classes tell which lists are not empty, so finding a free block
+     * at least as big as the requested size takes a couple of bit scans.
+     * Occupied blocks are found, when freed, through a hash table, by address, which also keeps their PIDs.
+     * Nodes live in a single array, linked by index, with their blocks in chunk units,
+     * so a node takes 24 bytes, whatever the width of addresses.
+     */
+    struct MemTlsfNode {
+        MemChunkBlock block;                // the block
+        uint32_t prevPhys;                  // block right below this one
+        uint32_t nextPhys;                  // block right above this one
+        uint32_t prevFree;                  // previous free block of the same class
+        uint32_t nextFree;                  // next free block of the same class
+    };
+
+    static_assert(sizeof(MemTlsfNode) == 24, "a node must take 24 bytes");
+
+    struct MemTlsfOccupied {
+        uint32_t node;                      // node of the block
+        uint32_t pid;                       // PID of the process using it
+    };
+
+    static const uint32_t NIL = UINT32_MAX;         // index of no node
+    static const uint32_t subclasses = 1u << MEM_TLSF_SECOND_LEVEL;
+    static const uint32_t levels = 32 - MEM_TLSF_SECOND_LEVEL + 1;
+
+    static_assert(MEM_TLSF_SECOND_LEVEL >= 1 and MEM_TLSF_SECOND_LEVEL <= 5, "the second level of a class is a 32-bit mask");
+
+    static std::vector<MemTlsfNode> nodes;                              // all nodes, in use or not
+    static std::vector<uint32_t> spare;                                 // nodes not in use
+    static uint32_t physHead = NIL;                                     // block of lowest address
+    static uint64_t firstMap;                                           // bit f is set if any list of level f is not empty
+    static uint32_t secondMap[levels];                                  // bit s is set if list (f, s) is not empty
+    static uint32_t freeHead[levels][subclasses];                       // free blocks, per class
+    static std::unordered_map<uint32_t, MemTlsfOccupied> occupied;      // occupied blocks, by start chunk
+
+// ================================================================================== //
+
+    static inline MemSize memTlsfBytes(uint32_t n)
+    {
+        return (MemSize)nodes[n].block.count * memParameters.chunkSize;
+    }
+
+    /* a node for the given block, not linked to any other */
+    static uint32_t memTlsfNew(const MemChunkBlock &block)
+    {
+        uint32_t n;
+        if (spare.empty())
+        {
+            n = nodes.size();
+            nodes.push_back({});
+        }
+        else
+        {
+            n = spare.back();
+            spare.pop_back();
+        }
+        nodes[n] = { block, NIL, NIL, NIL, NIL };
+        return n;
+    }
+
+    /* the class of the given number of chunks */
+    static inline void memTlsfMapping(uint32_t chunks, uint32_t *fl, uint32_t *sl)
+    {
+        if (chunks < subclasses)
+        {
+            *fl = 0;
+            *sl = chunks;
+        }
+        else
+        {
+            uint32_t log = 31 - __builtin_clz(chunks);
+            *fl = log - MEM_TLSF_SECOND_LEVEL + 1;
+            *sl = (chunks >> (log - MEM_TLSF_SECOND_LEVEL)) - subclasses;
+        }
+    }
+
+    static void memTlsfInsert(uint32_t n)
+    {
+        MemTlsfNode &node = nodes[n];
+        uint32_t fl, sl;
+        memTlsfMapping(node.block.count, &fl, &sl);
+        uint32_t &head = freeHead[fl][sl];
+        node.prevFree = NIL;
+        node.nextFree = head;
+        if (head != NIL)
+            nodes[head].prevFree = n;
+        head = n;
+        firstMap |= 1ull << fl;
+        secondMap[fl] |= 1u << sl;
+    }
+
+    static void memTlsfRemove(uint32_t n)
+    {
+        MemTlsfNode &node = nodes[n];
+        uint32_t fl, sl;
+        memTlsfMapping(node.block.count, &fl, &sl);
+        uint32_t &head = freeHead[fl][sl];
+        if (node.prevFree != NIL)
+            nodes[node.prevFree].nextFree = node.nextFree;
+        else
+            head = node.nextFree;
+        if (node.nextFree != NIL)
+            nodes[node.nextFree].prevFree = node.prevFree;
+        node.prevFree = node.nextFree = NIL;
+        if (head == NIL)
+        {
+            secondMap[fl] &= ~(1u << sl);
+            if (secondMap[fl] == 0)
+                firstMap &= ~(1ull << fl);
+        }
+    }
+
+    /*
+     * a free block of at least the given number of chunks, or NIL if there is none;
+     * the size is rounded up to the next class, so any block of the class found fits,
+     * and only if there is none the class of the size itself is walked
+     */
+    static uint32_t memTlsfFind(uint32_t chunks)
+    {
+        uint64_t rounded = chunks;
+        if (chunks >= subclasses)
+            rounded += (1u << (31 - __builtin_clz(chunks) - MEM_TLSF_SECOND_LEVEL)) - 1;
+
+        uint32_t fl = levels, sl = 0, map = 0;
+        if (rounded <= UINT32_MAX)
+        {
+            memTlsfMapping(rounded, &fl, &sl);
+            map = secondMap[fl] & (~0u << sl);
+        }
+        if (map == 0)
+        {
+            uint64_t upper = fl + 1 < levels ? firstMap & (~0ull << (fl + 1)) : 0;
+            if (upper != 0)
+            {
+                fl = __builtin_ctzll(upper);
+                map = secondMap[fl];
+            }
+        }
+        if (map != 0)
+            return freeHead[fl][__builtin_ctz(map)];
+
+        memTlsfMapping(chunks, &fl, &sl);
+        uint32_t n = freeHead[fl][sl];
+        while (n != NIL and nodes[n].block.count < chunks)
+            n = nodes[n].nextFree;
+        return n;
+    }
+
+    /* merge a free block with the free block right above it, both out of the class lists */
+    static void memTlsfAbsorb(uint32_t n, uint32_t next)
+    {
+        MemTlsfNode &node = nodes[n];
+        node.block.count += nodes[next].block.count;
+        node.nextPhys = nodes[next].nextPhys;
+        if (node.nextPhys != NIL)
+            nodes[node.nextPhys].prevPhys = n;
+        spare.push_back(next);
+    }
+
+// ================================================================================== //
+
+    void memTlsfReset()
+    {
+        nodes.clear();
+        spare.clear();
+        physHead = NIL;
+        occupied.clear();
+        firstMap = 0;
+        for (uint32_t f = 0; f < levels; f++)
+        {
+            secondMap[f] = 0;
+            for (uint32_t s = 0; s < subclasses; s++)
+                freeHead[f][s] = NIL;
+        }
+    }
+
+    /* a block, in bytes, with the PID of the process using it */
+    static MemBlock memTlsfBlock(uint32_t n)
+    {
+        const MemChunkBlock &block = nodes[n].block;
+        return memByteBlock(block, memParameters.chunkSize, block.occupied ? occupied[block.start].pid : 0);
+    }
+
+    /* a single free block, covering the given memory */
+    void memTlsfInit(Address address, MemSize size)
+    {
+        require(size / memParameters.chunkSize < (1u << 31), "memory size, in chuncks, must fit in 31 bits for Tlsf");
+
+        memTlsfReset();
+        physHead = memTlsfNew(memChunkBlock({ 0, size, address }, memParameters.chunkSize));
+        memTlsfInsert(physHead);
+    }
+
+    /* append all blocks, free (of PID 0) and occupied, to blocks, in ascending order of addresses */
+    void memTlsfBlocks(std::vector<MemBlock> &blocks)
+    {
+        for (uint32_t n = physHead; n != NIL; n = nodes[n].nextPhys)
+            blocks.push_back(memTlsfBlock(n));
+    }
+
+    /* append all blocks to blocks, in chunk units, in ascending order of addresses */
+    void memTlsfChunkBlocks(std::vector<MemChunkBlock> &blocks)
+    {
+        for (uint32_t n = physHead; n != NIL; n = nodes[n].nextPhys)
+            blocks.push_back(nodes[n].block);
+    }
+
+    /*
+     * append the free blocks to blocks, the lists of every class from tail to head,
+     * so that inserting them in order rebuilds the lists
+     */
+    void memTlsfFreeBlocks(std::vector<MemBlock> &blocks)
+    {
+        for (uint32_t f = 0; f < levels; f++)
+        {
+            for (uint32_t s = 0; s < subclasses; s++)
+            {
+                uint32_t tail = freeHead[f][s];
+                while (tail != NIL and nodes[tail].nextFree != NIL)
+                    tail = nodes[tail].nextFree;
+                for (uint32_t n = tail; n != NIL; n = nodes[n].prevFree)
+                    blocks.push_back(memTlsfBlock(n));
+            }
+        }
+    }
+
+    /* rebuild the blocks, from the free ones, as given by memTlsfFreeBlocks, and the occupied ones, in ascending order of addresses */
+    void memTlsfRestore(const std::vector<MemBlock> &freeBlocks, const std::vector<MemBlock> &occupiedBlocks)
+    {
+        memTlsfReset();
+
+        std::vector<MemBlock> sorted(freeBlocks);
+        std::sort(sorted.begin(), sorted.end(), [](const MemBlock &a, const MemBlock &b) { return a.address < b.address; });
+
+        std::unordered_map<uint32_t, uint32_t> free;
+        uint32_t last = NIL;
+        uint32_t f = 0, o = 0;
+        while (f < sorted.size() or o < occupiedBlocks.size())
+        {
+            bool isFree = o == occupiedBlocks.size()
+                or (f < sorted.size() and sorted[f].address < occupiedBlocks[o].address);
+            const MemBlock &b = isFree ? sorted[f++] : occupiedBlocks[o++];
+            uint32_t n = memTlsfNew(memChunkBlock(b, memParameters.chunkSize));
+            nodes[n].prevPhys = last;
+            if (isFree)
+                free[nodes[n].block.start] = n;
+            else
+                occupied[nodes[n].block.start] = { n, b.pid };
+            if (last == NIL)
+                physHead = n;
+            else
+                nodes[last].nextPhys = n;
+            last = n;
+        }
+
+        for (const MemBlock &b : freeBlocks)
+            memTlsfInsert(free[b.address / memParameters.chunkSize]);
+    }
+
+    /* merge every pair of adjacent free blocks, in a single pass */
+    void memTlsfMergeAll()
+    {
+        for (uint32_t n = physHead; n != NIL; n = nodes[n].nextPhys)
+        {
+            uint32_t next = nodes[n].nextPhys;
+            if (nodes[n].block.occupied or next == NIL or nodes[next].block.occupied)
+                continue;
+
+            memTlsfRemove(n);
+            memStatsErase(memTlsfBytes(n));
+            while ((next = nodes[n].nextPhys) != NIL and not nodes[next].block.occupied)
+            {
+                memTlsfRemove(next);
+                memStatsErase(memTlsfBytes(next));
+                memTlsfAbsorb(n, next);
+            }
+            memTlsfInsert(n);
+            memStatsInsert(memTlsfBytes(n));
+        }
+    }
+
+// ================================================================================== //
+
+    Address memTlsfAlloc(uint32_t pid, MemSize size)
+    {
+        soProbe(515, "%s(%u, %#" FMT_ADDR ")\n", __func__, pid, size);
+
+        require(pid > 0, "a valid process ID must be greater than zero");
+        require(size, "the size of a memory segment must be greater than zero");
+
+        uint32_t chunks = size / memParameters.chunkSize;
+        uint32_t n = memTlsfFind(chunks);
+        if (n == NIL)
+            return NULL_ADDRESS;
+
+        memTlsfRemove(n);
+        memStatsErase(memTlsfBytes(n));
+
+        /* the lower part is used, the upper one remaining free (nodes may move, so no references are kept) */
+        if (nodes[n].block.count > chunks)
+        {
+            uint32_t rest = memTlsfNew({ nodes[n].block.start + chunks, nodes[n].block.count - chunks, 0 });
+            nodes[rest].prevPhys = n;
+            nodes[rest].nextPhys = nodes[n].nextPhys;
+            if (nodes[n].nextPhys != NIL)
+                nodes[nodes[n].nextPhys].prevPhys = rest;
+            nodes[n].nextPhys = rest;
+            nodes[n].block.count = chunks;
+            memTlsfInsert(rest);
+            memStatsInsert(memTlsfBytes(rest));
+        }
+
+        Address address = (Address)nodes[n].block.start * memParameters.chunkSize;
+        nodes[n].block.occupied = 1;
+        occupied[nodes[n].block.start] = { n, pid };
+        memBitmapMark(address, size, true);
+        return address;
+    }
+
+// ================================================================================== //
+
+    void memTlsfFree(Address address)
+    {
+        soProbe(516, "%s(%#" FMT_ADDR ")\n", __func__, address);
+
+        std::unordered_map<uint32_t, MemTlsfOccupied>::iterator it = occupied.end();
+        if (address % memParameters.chunkSize == 0)
+            it = occupied.find(address / memParameters.chunkSize);
+        if (it == occupied.end())
+            throw Exception(EINVAL, __func__);
+
+        uint32_t n = it->second.node;
+        occupied.erase(it);
+        nodes[n].block.occupied = 0;
+        memBitmapMark(address, memTlsfBytes(n), false);
+
+        /* merge with the adjacent free blocks (left to memDeferMerge, if merging is deferred) */
+        if (not memMergeDeferred)
+        {
+            uint32_t next = nodes[n].nextPhys;
+            if (next != NIL and not nodes[next].block.occupied)
+            {
+                memTlsfRemove(next);
+                memStatsErase(memTlsfBytes(next));
+                memTlsfAbsorb(n, next);
+            }
+            uint32_t prev = nodes[n].prevPhys;
+            if (prev != NIL and not nodes[prev].block.occupied)
+            {
+                memTlsfRemove(prev);
+                memStatsErase(memTlsfBytes(prev));
+                memTlsfAbsorb(prev, n);
+                n = prev;
+            }
+        }
+
+        memTlsfInsert(n);
+        memStatsInsert(memTlsfBytes(n));
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
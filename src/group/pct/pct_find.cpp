@@ -0,0 +1,54 @@
+/*
+ *  \author Guilherme Santos 107961
+ *  \author João Gaspar 107708
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+#include <unordered_map>
+
+namespace group 
+{
+
+// ================================================================================== //
+
+    /*
+     * Rows are appended in the order processes are inserted, and never move,
+     * so the row of every PID is kept in a hash index, updated once per insertion
+     */
+    static std::unordered_map<uint32_t, uint32_t> pctRows;
+
+    /* empty the index */
+    void pctIndexReset()
+    {
+        pctRows.clear();
+    }
+
+    /* add the given row, whose PID must already be set, to the index */
+    void pctIndexAdd(uint32_t row)
+    {
+        pctRows[pctTable.pid[row]] = row;
+    }
+
+    /* the row of the given PID, or PCT_NO_ROW if it is not in the table */
+    uint32_t pctLookup(uint32_t pid)
+    {
+        std::unordered_map<uint32_t, uint32_t>::const_iterator it = pctRows.find(pid);
+        return it == pctRows.end() ? PCT_NO_ROW : it->second;
+    }
+
+    /* the row of the given PID, which must be in the table */
+    uint32_t pctFind(uint32_t pid)
+    {
+        uint32_t row = pctLookup(pid);
+        if (row == PCT_NO_ROW)
+            throw Exception(EINVAL, "The entry for the given PID does NOT EXIST");
+        return row;
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
+
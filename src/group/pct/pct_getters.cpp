@@ -8,9 +8,11 @@
     namespace group 
     {
 
+    uint32_t pctFind(uint32_t pid);
+
 // ================================================================================== //
 
-    uint32_t pctGetLifetime(uint32_t pid)
+    SimTime pctGetLifetime(uint32_t pid)
     {
         soProbe(305, "%s(%u)\n", __func__, pid);
 
@@ -19,16 +21,7 @@
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
-        PctNode *current = pctHead;
-        while (current != NULL) {
-            if (current->pcb.pid == pid) {
-                return current->pcb.lifetime;
-            }
-            current = current->next;
-        }
-
-        throw Exception(EINVAL, "The entry for the given PID does NOT EXIST");
-
+        return pctTable.lifetime[pctFind(pid)];
     }
 
 // ================================================================================== //
@@ -42,16 +35,7 @@
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
-        PctNode *current = pctHead;
-        while (current != NULL) {
-            if (current->pcb.pid == pid) {
-                return &(current->pcb.memProfile);
-            }
-            current = current->next;
-        }
-
-        throw Exception(EINVAL, "The entry for the given PID does NOT EXIST");
-
+        return &pctTable.memProfile[pctFind(pid)];
     }
 
 // ================================================================================== //
@@ -65,15 +49,7 @@
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
-        PctNode *current = pctHead;
-        while (current != NULL) {
-            if (current->pcb.pid == pid) {
-                return &(current->pcb.memMapping);
-            }
-            current = current->next;
-        }
-
-        throw Exception(EINVAL, "The entry for the given PID does NOT EXIST");
+        return &pctTable.memMapping[pctFind(pid)];
     }
 
 // ================================================================================== //
@@ -87,29 +63,20 @@
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
-        PctNode *current = pctHead;
-        while (current != NULL) {
-            if (current->pcb.pid == pid) {
-                switch (current->pcb.state) {
-                    case NEW:
-                        return "NEW";
-                    case ACTIVE:
-                        return "ACTIVE";
-                    case SWAPPED:
-                        return "SWAPPED";
-                    case FINISHED:
-                        return "FINISHED";
-                    case DISCARDED:
-                        return "DISCARDED";
-                    default:
-                        throw Exception(ENOSYS, __func__);
-                }
-            }
-            current = current->next;
+        switch (pctTable.state[pctFind(pid)]) {
+            case NEW:
+                return "NEW";
+            case ACTIVE:
+                return "ACTIVE";
+            case SWAPPED:
+                return "SWAPPED";
+            case FINISHED:
+                return "FINISHED";
+            case DISCARDED:
+                return "DISCARDED";
+            default:
+                throw Exception(ENOSYS, __func__);
         }
-
-        throw Exception(EINVAL, "The entry for the given PID does NOT EXIST");
-        
     }
 
 // ================================================================================== //
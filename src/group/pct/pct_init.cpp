@@ -8,6 +8,9 @@
 namespace group 
 {
 
+    void pctStateReset();
+    void pctIndexReset();
+
 // ================================================================================== //
 
     void pctInit() 
@@ -17,7 +20,9 @@ namespace group
         /* TODO POINT: Replace next instruction with your code */
         //throw Exception(ENOSYS, __func__);
 
-        pctHead = NULL;
+        pctTable.count = 0;
+        pctStateReset();
+        pctIndexReset();
     }
 
 // ================================================================================== //
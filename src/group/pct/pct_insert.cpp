@@ -6,15 +6,55 @@
 #include "somm23.h"
 
 #include <stdint.h>
+#include <stdlib.h>
 
 namespace group 
 {
 
+    uint32_t pctLookup(uint32_t pid);
+    void pctIndexAdd(uint32_t row);
+    void pctStateLink(uint32_t row);
+
 // ================================================================================== //
 
-    void pctInsert(uint32_t pid, uint32_t time, uint32_t lifetime, AddressSpaceProfile *profile)
+    /* reallocate a column with room for the given number of rows */
+    template <typename T>
+    static void pctGrowColumn(T *&column, uint32_t rows)
+    {
+        T *p = (T *)realloc(column, rows * sizeof(T));
+        if (p == NULL)
+            throw Exception(ENOMEM, "pctInsert");
+        column = p;
+    }
+
+    /* make room in every column for at least the given number of rows */
+    void pctReserve(uint32_t rows)
     {
-        soProbe(304, "%s(%d, %u, %u, %p)\n", __func__, pid, time, lifetime, profile);
+        if (rows <= pctTable.capacity)
+            return;
+
+        uint32_t capacity = pctTable.capacity == 0 ? MAX_PROCESSES : pctTable.capacity;
+        while (capacity < rows)
+            capacity *= 2;
+
+        pctGrowColumn(pctTable.pid, capacity);
+        pctGrowColumn(pctTable.state, capacity);
+        pctGrowColumn(pctTable.arrivalTime, capacity);
+        pctGrowColumn(pctTable.lifetime, capacity);
+        pctGrowColumn(pctTable.activationTime, capacity);
+        pctGrowColumn(pctTable.finishTime, capacity);
+        pctGrowColumn(pctTable.memProfile, capacity);
+        pctGrowColumn(pctTable.memMapping, capacity);
+        pctGrowColumn(pctTable.stateNext, capacity);
+        pctGrowColumn(pctTable.statePrev, capacity);
+        pctTable.capacity = capacity;
+    }
+
+// ================================================================================== //
+
+    void pctInsert(uint32_t pid, SimTime time, SimTime lifetime, AddressSpaceProfile *profile)
+    {
+        soProbe(304, "%s(%d, %" FMT_TIME ", %" FMT_TIME ", %p)\n", __func__, pid, time, lifetime, profile);
 
         require(pid > 0, "a valid process ID must be greater than zero");
         require(time >= 0, "time must be >= 0");
@@ -24,32 +64,24 @@ namespace group
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
-        PctNode *newNode = new PctNode;
-        newNode->pcb.pid = pid;
-        newNode->pcb.state = NEW;
-        newNode->pcb.arrivalTime = time;
-        newNode->pcb.lifetime = lifetime;
-        newNode->pcb.activationTime = NO_TIME;
-        newNode->pcb.finishTime = NO_TIME;
-        newNode->pcb.memProfile = *profile;
-        newNode->next = NULL;
-
-        if(pctHead == NULL || pctHead->pcb.pid > pid){
-            newNode->next = pctHead;
-            pctHead = newNode;
-        }
-        else{
-            PctNode *node = pctHead;
-            while(node->next != NULL && node->next->pcb.pid < pid){
-                node = node->next;
-            }
-            if(node->next != NULL && node->next->pcb.pid == pid){
-                throw Exception(EINVAL, "PID already exists");
-            }
-            newNode->next = node->next;
-            node->next = newNode;
+        if (pctLookup(pid) != PCT_NO_ROW) {
+            throw Exception(EINVAL, "PID already exists");
         }
+        pctReserve(pctTable.count + 1);
+
+        /* the new row goes after the last one */
+        uint32_t row = pctTable.count++;
 
+        pctTable.pid[row] = pid;
+        pctTable.state[row] = NEW;
+        pctTable.arrivalTime[row] = time;
+        pctTable.lifetime[row] = lifetime;
+        pctTable.activationTime[row] = NO_TIME;
+        pctTable.finishTime[row] = NO_TIME;
+        pctTable.memProfile[row] = *profile;
+        pctTable.memMapping[row].blockCount = 0;
+        pctIndexAdd(row);
+        pctStateLink(row);
     }
 
 // ================================================================================== //
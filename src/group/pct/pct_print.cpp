@@ -9,9 +9,38 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace group 
 {
 
+// ================================================================================== //
+
+    /* widths of the address space columns, which depend on the number of segments */
+    static const int PROFILE_WIDTH = 10 * MAX_SEGMENTS - 1;
+    static_assert(PROFILE_WIDTH >= 21, "the address space profile column is narrower than its header");
+    static const int MAPPING_WIDTH = 12 * MAX_BLOCKS - 1;
+    static const int PCT_WIDTH = 61 + PROFILE_WIDTH + 1 + MAPPING_WIDTH;
+
+    /* print an horizontal rule, with or without the column separators */
+    static void pctPrintRule(FILE *fout, char fill, bool columns)
+    {
+        static const int widths[] = { 7, 11, 9, 10, 9, 9, PROFILE_WIDTH, MAPPING_WIDTH };
+
+        fputc('+', fout);
+        for (uint32_t c = 0; c < sizeof(widths) / sizeof(widths[0]); c++)
+        {
+            for (int i = 0; i < widths[c]; i++)
+                fputc(fill, fout);
+            if (columns or c == sizeof(widths) / sizeof(widths[0]) - 1)
+                fputc('+', fout);
+            else
+                fputc(fill, fout);
+        }
+        fputc('\n', fout);
+    }
+
 // ================================================================================== //
 
     void pctPrint(FILE *fout)
@@ -27,31 +56,39 @@ namespace group
             throw Exception(ENOSYS, __func__);
         }
 
-        fprintf(fout, "+====================================================================================================================================================+\n");
-        fprintf(fout, "|                                                                  Process Control Table                                                             |\n");
-        fprintf(fout, "+-------+-----------+---------+----------+---------+---------+---------------------------------------+-----------------------------------------------+\n");
-        fprintf(fout, "|  PID  |   state   | arrival | lifetime | active  | finish  |         address space profile         |             address space mapping             |\n");
-        fprintf(fout, "+-------+-----------+---------+----------+---------+---------+---------------------------------------+-----------------------------------------------+\n");
+        pctPrintRule(fout, '=', false);
+        fprintf(fout, "|%66s%-*s|\n", "", PCT_WIDTH - 66, "Process Control Table");
+        pctPrintRule(fout, '-', true);
+        fprintf(fout, "|  PID  |   state   | arrival | lifetime | active  | finish  |");
+        fprintf(fout, "%*s%-*s|", (PROFILE_WIDTH - 21) / 2, "", PROFILE_WIDTH - (PROFILE_WIDTH - 21) / 2, "address space profile");
+        fprintf(fout, "%*s%-*s|\n", (MAPPING_WIDTH - 21) / 2, "", MAPPING_WIDTH - (MAPPING_WIDTH - 21) / 2, "address space mapping");
+        pctPrintRule(fout, '-', true);
         
-        PctNode *current = pctHead;
-        uint32_t maxBlocks = 4;
-
-        current = pctHead;
-        while (current != NULL) {
-            fprintf(fout, "| %5u |", current->pcb.pid);
-            fprintf(fout, " %-8s  |",pctGetStateAsString(current->pcb.pid));
-            fprintf(fout, " %7u |", current->pcb.arrivalTime);
-            fprintf(fout, " %8u |", current->pcb.lifetime);
-            fprintf(fout, " %7u |", current->pcb.activationTime);
-            if (strcmp(pctGetStateAsString(current->pcb.pid), "ACTIVE") == 0) {
+        uint32_t maxBlocks = MAX_BLOCKS;
+
+        /* rows are in insertion order, and are printed in ascending order of the PID */
+        std::vector<uint32_t> rows(pctTable.count);
+        for (uint32_t k = 0; k < pctTable.count; k++)
+            rows[k] = k;
+        std::sort(rows.begin(), rows.end(), [](uint32_t a, uint32_t b) { return pctTable.pid[a] < pctTable.pid[b]; });
+
+        for (uint32_t k = 0; k < pctTable.count; k++) {
+            uint32_t i = rows[k];
+            uint32_t pid = pctTable.pid[i];
+            fprintf(fout, "| %5u |", pid);
+            fprintf(fout, " %-8s  |",pctGetStateAsString(pid));
+            fprintf(fout, " %7" FMT_TIME " |", pctTable.arrivalTime[i]);
+            fprintf(fout, " %8" FMT_TIME " |", pctTable.lifetime[i]);
+            fprintf(fout, " %7" FMT_TIME " |", pctTable.activationTime[i]);
+            if (strcmp(pctGetStateAsString(pid), "ACTIVE") == 0) {
                 fprintf(fout, "   ---   |");
             } else {
-                fprintf(fout, " %7u |", current->pcb.finishTime);
+                fprintf(fout, " %7" FMT_TIME " |", pctTable.finishTime[i]);
             }
 
             for (uint32_t j = 0; j < maxBlocks; ++j){
-                if (j < current->pcb.memProfile.segmentCount) {
-                    fprintf(fout, " %7u", current->pcb.memProfile.size[j]);
+                if (j < pctTable.memProfile[i].segmentCount) {
+                    fprintf(fout, " %7" FMT_SIZE, pctTable.memProfile[i].size[j]);
                 } else {
                     fprintf(fout, "   ---  ");
                 }
@@ -62,8 +99,8 @@ namespace group
             fprintf(fout, " |");
 
             for (uint32_t j = 0; j < maxBlocks; ++j){
-                if (j < current->pcb.memMapping.blockCount) {
-                    fprintf(fout, " 0x%07x", current->pcb.memMapping.address[j]);
+                if (j < pctTable.memMapping[i].blockCount) {
+                    fprintf(fout, " 0x%07" FMT_ADDR, pctTable.memMapping[i].address[j]);
                 } else {
                     fprintf(fout, "    ---   ");
                 }
@@ -72,10 +109,9 @@ namespace group
                 }
             }
             fprintf(fout, " |\n");
-            current = current->next;
         }
 
-        fprintf(fout, "+====================================================================================================================================================+\n");
+        pctPrintRule(fout, '=', false);
         fprintf(fout, "\n");
     }
 
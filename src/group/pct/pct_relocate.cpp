@@ -0,0 +1,75 @@
+/*
+ *  \author Guilherme Santos 107961
+ *  \author João Gaspar 107708
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+
+namespace group 
+{
+
+    uint32_t pctLookup(uint32_t pid);
+
+// ================================================================================== //
+
+    /*
+     * by PID and, within a process, by ascending address;
+     * as blocks only move down, replacing the lower addresses first means no new address
+     * is ever taken for one of the blocks still to be replaced
+     */
+    static bool pctRelocationLess(const BlockRelocation &a, const BlockRelocation &b)
+    {
+        return a.pid < b.pid or (a.pid == b.pid and a.from < b.from);
+    }
+
+    void pctRelocate(RelocationTable *table)
+    {
+        soProbe(310, "%s(%p)\n", __func__, table);
+
+        require(table != NULL, "table must be a valid pointer to a RelocationTable");
+
+        /*
+         * with the entries sorted by PID, a single walk through the (sorted) list reaches them all;
+         * in the table, the row of every PID is looked up in its index
+         */
+        std::sort(table->block, table->block + table->count, pctRelocationLess);
+
+        /* the PCT is either in the list, if built by the binary version, or in the table */
+        bool inList = soBinSelected(304);
+        PctNode *current = pctHead;
+        for (uint32_t i = 0; i < table->count; i++)
+        {
+            BlockRelocation &r = table->block[i];
+            AddressSpaceMapping *mapping;
+            if (inList)
+            {
+                while (current != NULL and current->pcb.pid < r.pid)
+                    current = current->next;
+                if (current == NULL or current->pcb.pid != r.pid)
+                    throw Exception(EINVAL, __func__);
+                mapping = &current->pcb.memMapping;
+            }
+            else
+            {
+                uint32_t row = pctLookup(r.pid);
+                if (row == PCT_NO_ROW)
+                    throw Exception(EINVAL, __func__);
+                mapping = &pctTable.memMapping[row];
+            }
+
+            uint32_t j = 0;
+            while (j < mapping->blockCount and mapping->address[j] != r.from)
+                j++;
+            if (j == mapping->blockCount)
+                throw Exception(EINVAL, __func__);
+            mapping->address[j] = r.to;
+        }
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
@@ -0,0 +1,113 @@
+/*
+ *  \author Guilherme Santos 107961
+ *  \author João Gaspar 107708
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+namespace group 
+{
+
+// ================================================================================== //
+
+    /* empty all the per-state lists */
+    void pctStateReset()
+    {
+        for (uint32_t s = 0; s < PCT_STATES; s++)
+        {
+            pctTable.stateHead[s] = pctTable.stateTail[s] = PCT_NO_ROW;
+            pctTable.stateCount[s] = 0;
+        }
+    }
+
+    /* append the given row to the list of its state */
+    void pctStateLink(uint32_t row)
+    {
+        uint32_t s = pctTable.state[row];
+        pctTable.stateNext[row] = PCT_NO_ROW;
+        pctTable.statePrev[row] = pctTable.stateTail[s];
+        if (pctTable.stateTail[s] == PCT_NO_ROW)
+            pctTable.stateHead[s] = row;
+        else
+            pctTable.stateNext[pctTable.stateTail[s]] = row;
+        pctTable.stateTail[s] = row;
+        pctTable.stateCount[s]++;
+    }
+
+    /* remove the given row from the list of its state */
+    void pctStateUnlink(uint32_t row)
+    {
+        uint32_t s = pctTable.state[row];
+        uint32_t next = pctTable.stateNext[row];
+        uint32_t prev = pctTable.statePrev[row];
+        if (prev == PCT_NO_ROW)
+            pctTable.stateHead[s] = next;
+        else
+            pctTable.stateNext[prev] = next;
+        if (next == PCT_NO_ROW)
+            pctTable.stateTail[s] = prev;
+        else
+            pctTable.statePrev[next] = prev;
+        pctTable.stateCount[s]--;
+    }
+
+// ================================================================================== //
+
+    uint32_t pctCountInState(ProcessState state)
+    {
+        soProbe(311, "%s(%u)\n", __func__, state);
+
+        if ((uint32_t)state >= PCT_STATES)
+            throw Exception(EINVAL, __func__);
+
+        /* the list built by the binary version has no per-state lists */
+        if (soBinSelected(304))
+        {
+            uint32_t n = 0;
+            for (PctNode *p = pctHead; p != NULL; p = p->next)
+            {
+                if (p->pcb.state == state)
+                    n++;
+            }
+            return n;
+        }
+
+        return pctTable.stateCount[state];
+    }
+
+// ================================================================================== //
+
+    uint32_t pctGetPidsInState(ProcessState state, uint32_t *pids, uint32_t max)
+    {
+        soProbe(312, "%s(%u, %p, %u)\n", __func__, state, pids, max);
+
+        require(pids != NULL or max == 0, "pids must be a valid pointer to an array of max entries");
+
+        if ((uint32_t)state >= PCT_STATES)
+            throw Exception(EINVAL, __func__);
+
+        uint32_t n = 0;
+        if (soBinSelected(304))
+        {
+            for (PctNode *p = pctHead; p != NULL; p = p->next)
+            {
+                if (p->pcb.state != state)
+                    continue;
+                if (n < max)
+                    pids[n] = p->pcb.pid;
+                n++;
+            }
+            return n;
+        }
+
+        for (uint32_t row = pctTable.stateHead[state]; row != PCT_NO_ROW and n < max; row = pctTable.stateNext[row])
+            pids[n++] = pctTable.pid[row];
+        return pctTable.stateCount[state];
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
+
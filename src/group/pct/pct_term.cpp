@@ -5,9 +5,15 @@
 
 #include "somm23.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 namespace group 
 {
 
+    void pctStateReset();
+    void pctIndexReset();
+
 // ================================================================================== //
 
     void pctTerm() 
@@ -17,14 +23,19 @@ namespace group
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
-        PctNode *current = pctHead;
-        while (current != NULL) {
-            PctNode *next = current->next;
-            free(current);
-            current = next;
-        }
-
-        pctHead = NULL;
+        free(pctTable.pid);
+        free(pctTable.state);
+        free(pctTable.arrivalTime);
+        free(pctTable.lifetime);
+        free(pctTable.activationTime);
+        free(pctTable.finishTime);
+        free(pctTable.memProfile);
+        free(pctTable.memMapping);
+        free(pctTable.stateNext);
+        free(pctTable.statePrev);
+        memset(&pctTable, 0, sizeof(pctTable));
+        pctStateReset();
+        pctIndexReset();
     }
 
 // ================================================================================== //
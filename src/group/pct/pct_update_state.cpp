@@ -10,37 +10,40 @@
 namespace group 
 {
 
+    uint32_t pctLookup(uint32_t pid);
+    void pctStateLink(uint32_t row);
+    void pctStateUnlink(uint32_t row);
+
 // ================================================================================== //
 
-    void pctUpdateState(uint32_t pid, ProcessState state, uint32_t time = NO_TIME, AddressSpaceMapping *mapping = NULL)
+    void pctUpdateState(uint32_t pid, ProcessState state, SimTime time = NO_TIME, AddressSpaceMapping *mapping = NULL)
     {
-        soProbe(309, "%s(%d, %u, %u)\n", __func__, pid, state, time);
+        soProbe(309, "%s(%d, %u, %" FMT_TIME ")\n", __func__, pid, state, time);
 
         require(pid > 0, "a valid process ID must be greater than zero");
+        require((uint32_t)state < PCT_STATES, "state must be a valid process state");
 
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
-        PctNode *current = pctHead;
-        while (current != NULL) {
-            if(current->pcb.pid == pid) {
-                current->pcb.state = state;
-                if(state == ACTIVE) {
-                    current->pcb.activationTime = time;
-                    if(mapping != NULL) {
-                        current->pcb.memMapping = *mapping;
-                    } else {
-                        throw Exception(EINVAL, "Mapping not defined for the ACTIVE state");
-                    }
-                } else if (state == FINISHED){
-                    current->pcb.finishTime = time;
+        uint32_t row = pctLookup(pid);
+        if (row != PCT_NO_ROW) {
+            if (pctTable.state[row] != state) {
+                pctStateUnlink(row);
+                pctTable.state[row] = state;
+                pctStateLink(row);
+            }
+            if(state == ACTIVE) {
+                pctTable.activationTime[row] = time;
+                if(mapping != NULL) {
+                    pctTable.memMapping[row] = *mapping;
+                } else {
+                    throw Exception(EINVAL, "Mapping not defined for the ACTIVE state");
                 }
+            } else if (state == FINISHED){
+                pctTable.finishTime[row] = time;
             }
-            current = current->next;
         }
-
-        
-
     }
 
 // ================================================================================== //
@@ -0,0 +1,513 @@
+/*
+ *  \author Guilherme Santos 107961
+ *  \author João Gaspar 107708
+ */
+
+#include "somm23.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+namespace group
+{
+
+    void memStatsReset();
+    void memStatsInsert(MemSize size);
+    void memSlabSnapshot(std::vector<MemBlock> &blocks);
+    void memSlabRestore(const MemBlock *blocks);
+    void memTlsfBlocks(std::vector<MemBlock> &blocks);
+    void memTlsfFreeBlocks(std::vector<MemBlock> &blocks);
+    void memBuddyForestRestore(MemTreeNode *top);
+    void memTlsfRestore(const std::vector<MemBlock> &freeBlocks, const std::vector<MemBlock> &occupiedBlocks);
+    void memBitmapRebuild();
+    void memFitRebuild();
+    void pctReserve(uint32_t rows);
+    void pctStateReset();
+    void pctStateLink(uint32_t row);
+    void pctIndexReset();
+    void pctIndexAdd(uint32_t row);
+
+    extern uint32_t memLazyWatermark;
+    extern bool memMergeDeferred;
+    extern bool simCompactionOn;
+    extern SimTime simCompactionFixedCost;
+    extern SimTime simCompactionChunkCost;
+
+// ================================================================================== //
+
+    /*
+     * Snapshot layout:
+     *   header, with magic, version and the sizes of the stored types
+     *   sim: stepCount, simTime, forthcoming count, forthcoming processes
+     *   pct: count, blocks in list order
+     *   feq: count, events in list order
+     *   swp: count, tail index, processes in list order
+     *   mem: parameters, free list, occupied list, buddy tree in pre-order, objects of the slabs
+     *   pct: rows of the per-state lists, state by state, in list order (none if built by the binary version)
+     *   settings: lazy merge watermark, deferred merge flag, compaction on, fixed and per chunk costs
+     *   metrics
+     * Every list is written with a single bulk write, and pointers are stored
+     * as indices into the arrays, so a snapshot does not depend on where nodes were allocated.
+     */
+
+    static const char snapshotMagic[8] = { 'S', 'O', 'M', 'M', '2', '3', 'C', 'K' };
+    static const uint32_t snapshotVersion = 3;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t sizes[8];      // sizes of the stored types, to reject snapshots of other builds
+    };
+
+    struct SnapshotTreeNode {
+        MemTreeNodeType state;
+        MemBlock block;
+        int32_t left;           // index of the left child, -1 if none
+        int32_t right;          // index of the right child, -1 if none
+    };
+
+    struct SnapshotSettings {
+        uint32_t lazyWatermark;
+        uint32_t mergeDeferred;
+        uint32_t compactionOn;
+        SimTime compactionFixedCost;
+        SimTime compactionChunkCost;
+    };
+
+    static void snapshotHeader(SnapshotHeader &h)
+    {
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, snapshotMagic, sizeof(h.magic));
+        h.version = snapshotVersion;
+        h.sizes[0] = sizeof(ForthcomingProcess);
+        h.sizes[1] = sizeof(PctBlock);
+        h.sizes[2] = sizeof(FutureEvent);
+        h.sizes[3] = sizeof(SwappedProcess);
+        h.sizes[4] = sizeof(MemBlock);
+        h.sizes[5] = sizeof(SnapshotTreeNode);
+        h.sizes[6] = sizeof(SnapshotSettings);
+        h.sizes[7] = sizeof(SoMetrics);
+    }
+
+// ================================================================================== //
+
+    static void snapshotWrite(FILE *fout, const void *buf, size_t size, const char *func)
+    {
+        if (size != 0 and fwrite(buf, size, 1, fout) != 1)
+        {
+            int en = errno;
+            fclose(fout);
+            throw Exception(en, func);
+        }
+    }
+
+    template <typename T>
+    static void snapshotWriteArray(FILE *fout, const std::vector<T> &v, const char *func)
+    {
+        uint32_t count = v.size();
+        snapshotWrite(fout, &count, sizeof(count), func);
+        snapshotWrite(fout, v.data(), count * sizeof(T), func);
+    }
+
+    static uint32_t snapshotTree(MemTreeNode *node, std::vector<SnapshotTreeNode> &v)
+    {
+        uint32_t idx = v.size();
+        v.push_back({ node->state, node->block, -1, -1 });
+        if (node->left != NULL)
+            v[idx].left = snapshotTree(node->left, v);
+        if (node->right != NULL)
+            v[idx].right = snapshotTree(node->right, v);
+        return idx;
+    }
+
+// ================================================================================== //
+
+    void simCheckpoint(const char *fname)
+    {
+        soProbe(109, "%s(\"%s\")\n", __func__, fname);
+
+        require(fname != NULL, "fname can not be a NULL pointer");
+
+        /* gather every list into a contiguous array */
+        /* the PCT is either in the list, if built by the binary version, or in the table */
+        std::vector<PctBlock> pct;
+        if (soBinSelected(304))
+        {
+            for (PctNode *p = pctHead; p != NULL; p = p->next)
+                pct.push_back(p->pcb);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < pctTable.count; i++)
+                pct.push_back({ pctTable.pid[i], pctTable.state[i], pctTable.arrivalTime[i], pctTable.lifetime[i],
+                        pctTable.activationTime[i], pctTable.finishTime[i], pctTable.memProfile[i], pctTable.memMapping[i] });
+        }
+
+        std::vector<FutureEvent> feq;
+        for (FeqEventNode *p = feqHead; p != NULL; p = p->next)
+            feq.push_back(p->event);
+
+        std::vector<SwappedProcess> swp;
+        int32_t swpTailIdx = -1;
+        for (SwpNode *p = swpHead; p != NULL; p = p->next)
+        {
+            if (p == swpTail)
+                swpTailIdx = swp.size();
+            swp.push_back(p->process);
+        }
+
+        std::vector<MemBlock> memFree, memOccupied;
+        for (MemListNode *p = memFreeHead; p != NULL; p = p->next)
+            memFree.push_back(p->block);
+        for (MemListNode *p = memOccupiedHead; p != NULL; p = p->next)
+            memOccupied.push_back(p->block);
+
+        /* the blocks of TLSF are stored as the ones of the first fit lists, the free ones in the order of their classes */
+        if (memParameters.policy == Tlsf)
+        {
+            std::vector<MemBlock> blocks;
+            memTlsfBlocks(blocks);
+            for (const MemBlock &b : blocks)
+                if (b.pid != 0)
+                    memOccupied.push_back(b);
+            memTlsfFreeBlocks(memFree);
+        }
+
+        std::vector<SnapshotTreeNode> memTree;
+        if (memTreeRoot != NULL)
+            snapshotTree(memTreeRoot, memTree);
+
+        std::vector<MemBlock> memSlabs;
+        if (memParameters.policy == Slab)
+            memSlabSnapshot(memSlabs);
+
+        /* the per-state lists keep the order processes entered their states in, which is not the row order */
+        std::vector<uint32_t> pctStateRows;
+        if (not soBinSelected(304))
+        {
+            for (uint32_t st = 0; st < PCT_STATES; st++)
+                for (uint32_t row = pctTable.stateHead[st]; row != PCT_NO_ROW; row = pctTable.stateNext[row])
+                    pctStateRows.push_back(row);
+        }
+
+        SnapshotSettings settings;
+        memset(&settings, 0, sizeof(settings));
+        settings.lazyWatermark = memLazyWatermark;
+        settings.mergeDeferred = memMergeDeferred;
+        settings.compactionOn = simCompactionOn;
+        settings.compactionFixedCost = simCompactionFixedCost;
+        settings.compactionChunkCost = simCompactionChunkCost;
+
+        SoMetrics metrics;
+        soMetricsGet(&metrics);
+
+        /* and write them in bulk */
+        FILE *fout = fopen(fname, "wb");
+        if (fout == NULL)
+            throw Exception(errno, __func__);
+
+        SnapshotHeader header;
+        snapshotHeader(header);
+        snapshotWrite(fout, &header, sizeof(header), __func__);
+
+        snapshotWrite(fout, &stepCount, sizeof(stepCount), __func__);
+        snapshotWrite(fout, &simTime, sizeof(simTime), __func__);
+        snapshotWrite(fout, &forthcomingTable.count, sizeof(forthcomingTable.count), __func__);
+        snapshotWrite(fout, forthcomingTable.process, forthcomingTable.count * sizeof(ForthcomingProcess), __func__);
+
+        snapshotWriteArray(fout, pct, __func__);
+        snapshotWriteArray(fout, feq, __func__);
+        snapshotWriteArray(fout, swp, __func__);
+        snapshotWrite(fout, &swpTailIdx, sizeof(swpTailIdx), __func__);
+
+        snapshotWrite(fout, &memParameters, sizeof(memParameters), __func__);
+        snapshotWriteArray(fout, memFree, __func__);
+        snapshotWriteArray(fout, memOccupied, __func__);
+        snapshotWriteArray(fout, memTree, __func__);
+        snapshotWriteArray(fout, memSlabs, __func__);
+
+        snapshotWriteArray(fout, pctStateRows, __func__);
+        snapshotWrite(fout, &settings, sizeof(settings), __func__);
+        snapshotWrite(fout, &metrics, sizeof(metrics), __func__);
+
+        if (fclose(fout) != 0)
+            throw Exception(errno, __func__);
+    }
+
+// ================================================================================== //
+
+    static void snapshotRead(FILE *fin, void *buf, size_t size, const char *func)
+    {
+        if (size != 0 and fread(buf, size, 1, fin) != 1)
+        {
+            fclose(fin);
+            fprintf(stderr, "%s: truncated snapshot\n", func);
+            throw Exception(EINVAL, func);
+        }
+    }
+
+    template <typename T>
+    static void snapshotReadArray(FILE *fin, std::vector<T> &v, const char *func)
+    {
+        uint32_t count;
+        snapshotRead(fin, &count, sizeof(count), func);
+        v.resize(count);
+        snapshotRead(fin, v.data(), count * sizeof(T), func);
+    }
+
+    static MemListNode *restoreList(const std::vector<MemBlock> &v)
+    {
+        MemListNode *head = NULL, *last = NULL;
+        for (const MemBlock &b : v)
+        {
+            MemListNode *node = new MemListNode;
+            node->block = b;
+            node->prev = last;
+            node->next = NULL;
+            if (last == NULL)
+                head = node;
+            else
+                last->next = node;
+            last = node;
+        }
+        return head;
+    }
+
+    /* the indices were checked by simRestore before anything is rebuilt */
+    static MemTreeNode *restoreTree(const std::vector<SnapshotTreeNode> &v, int32_t idx)
+    {
+        if (idx < 0)
+            return NULL;
+        MemTreeNode *node = new MemTreeNode;
+        node->state = v[idx].state;
+        node->block = v[idx].block;
+        node->left = restoreTree(v, v[idx].left);
+        node->right = restoreTree(v, v[idx].right);
+        return node;
+    }
+
+// ================================================================================== //
+
+    void simRestore(const char *fname)
+    {
+        soProbe(110, "%s(\"%s\")\n", __func__, fname);
+
+        require(fname != NULL, "fname can not be a NULL pointer");
+
+        FILE *fin = fopen(fname, "rb");
+        if (fin == NULL)
+            throw Exception(errno, __func__);
+
+        /* read everything before touching the current state */
+        SnapshotHeader header, expected;
+        snapshotHeader(expected);
+        snapshotRead(fin, &header, sizeof(header), __func__);
+        if (memcmp(&header, &expected, sizeof(header)) != 0)
+        {
+            fclose(fin);
+            fprintf(stderr, "%s: \"%s\" is not a snapshot of this simulator build\n", __func__, fname);
+            throw Exception(EINVAL, __func__);
+        }
+
+        uint32_t steps, count;
+        SimTime time;
+        snapshotRead(fin, &steps, sizeof(steps), __func__);
+        snapshotRead(fin, &time, sizeof(time), __func__);
+        snapshotRead(fin, &count, sizeof(count), __func__);
+        if (count > MAX_PROCESSES)
+        {
+            fclose(fin);
+            fprintf(stderr, "%s: too many forthcoming processes\n", __func__);
+            throw Exception(EINVAL, __func__);
+        }
+        std::vector<ForthcomingProcess> forthcoming(count);
+        snapshotRead(fin, forthcoming.data(), count * sizeof(ForthcomingProcess), __func__);
+
+        std::vector<PctBlock> pct;
+        std::vector<FutureEvent> feq;
+        std::vector<SwappedProcess> swp;
+        int32_t swpTailIdx;
+        snapshotReadArray(fin, pct, __func__);
+        snapshotReadArray(fin, feq, __func__);
+        snapshotReadArray(fin, swp, __func__);
+        snapshotRead(fin, &swpTailIdx, sizeof(swpTailIdx), __func__);
+
+        MemParameters parameters;
+        std::vector<MemBlock> memFree, memOccupied, memSlabs;
+        std::vector<SnapshotTreeNode> memTree;
+        snapshotRead(fin, &parameters, sizeof(parameters), __func__);
+        snapshotReadArray(fin, memFree, __func__);
+        snapshotReadArray(fin, memOccupied, __func__);
+        snapshotReadArray(fin, memTree, __func__);
+        snapshotReadArray(fin, memSlabs, __func__);
+
+        std::vector<uint32_t> pctStateRows;
+        SnapshotSettings settings;
+        SoMetrics metrics;
+        snapshotReadArray(fin, pctStateRows, __func__);
+        snapshotRead(fin, &settings, sizeof(settings), __func__);
+        snapshotRead(fin, &metrics, sizeof(metrics), __func__);
+        fclose(fin);
+
+        /* every row must be in the per-state lists exactly once */
+        bool pctBinary = soBinSelected(304);
+        bool pctListsValid = pctStateRows.size() == (pctBinary ? 0 : pct.size());
+        std::vector<bool> pctListed(pct.size(), false);
+        for (uint32_t i = 0; pctListsValid and i < pctStateRows.size(); i++)
+        {
+            uint32_t row = pctStateRows[i];
+            pctListsValid = row < pct.size() and not pctListed[row];
+            if (pctListsValid)
+                pctListed[row] = true;
+        }
+        if (not pctListsValid)
+        {
+            fprintf(stderr, "%s: the per-state lists do not match the PCT\n", __func__);
+            throw Exception(EINVAL, __func__);
+        }
+
+        /* the tree must be rooted at node 0, with every node reached exactly once */
+        bool memTreeValid = true;
+        std::vector<bool> memTreeVisited(memTree.size(), false);
+        std::vector<int32_t> memTreePending;
+        if (not memTree.empty())
+            memTreePending.push_back(0);
+        while (memTreeValid and not memTreePending.empty())
+        {
+            int32_t idx = memTreePending.back();
+            memTreePending.pop_back();
+            memTreeValid = idx < (int32_t)memTree.size() and not memTreeVisited[idx];
+            if (memTreeValid)
+            {
+                memTreeVisited[idx] = true;
+                if (memTree[idx].left >= 0)
+                    memTreePending.push_back(memTree[idx].left);
+                if (memTree[idx].right >= 0)
+                    memTreePending.push_back(memTree[idx].right);
+            }
+        }
+        for (uint32_t i = 0; memTreeValid and i < memTree.size(); i++)
+            memTreeValid = memTreeVisited[i];
+        if (not memTreeValid)
+        {
+            fprintf(stderr, "%s: the memory tree is not a tree\n", __func__);
+            throw Exception(EINVAL, __func__);
+        }
+
+        /* release the current state */
+        pctTerm();
+        feqTerm();
+        swpTerm();
+        memTerm();
+
+        /* and rebuild every structure */
+        stepCount = steps;
+        simTime = time;
+        forthcomingTable.count = count;
+        memcpy(forthcomingTable.process, forthcoming.data(), count * sizeof(ForthcomingProcess));
+
+        if (pctBinary)
+        {
+            PctNode **pctLink = &pctHead;
+            for (const PctBlock &b : pct)
+            {
+                *pctLink = new PctNode;
+                (*pctLink)->pcb = b;
+                pctLink = &(*pctLink)->next;
+            }
+            *pctLink = NULL;
+        }
+        else
+        {
+            pctReserve(pct.size());
+            pctTable.count = pct.size();
+            for (uint32_t i = 0; i < pct.size(); i++)
+            {
+                pctTable.pid[i] = pct[i].pid;
+                pctTable.state[i] = pct[i].state;
+                pctTable.arrivalTime[i] = pct[i].arrivalTime;
+                pctTable.lifetime[i] = pct[i].lifetime;
+                pctTable.activationTime[i] = pct[i].activationTime;
+                pctTable.finishTime[i] = pct[i].finishTime;
+                pctTable.memProfile[i] = pct[i].memProfile;
+                pctTable.memMapping[i] = pct[i].memMapping;
+            }
+            pctIndexReset();
+            for (uint32_t row = 0; row < pct.size(); row++)
+                pctIndexAdd(row);
+            pctStateReset();
+            for (uint32_t row : pctStateRows)
+                pctStateLink(row);
+        }
+
+        FeqEventNode **feqLink = &feqHead;
+        for (const FutureEvent &e : feq)
+        {
+            *feqLink = new FeqEventNode;
+            (*feqLink)->event = e;
+            feqLink = &(*feqLink)->next;
+        }
+        *feqLink = NULL;
+
+        SwpNode **swpLink = &swpHead;
+        swpTail = NULL;
+        for (uint32_t i = 0; i < swp.size(); i++)
+        {
+            *swpLink = new SwpNode;
+            (*swpLink)->process = swp[i];
+            if ((int32_t)i == swpTailIdx)
+                swpTail = *swpLink;
+            swpLink = &(*swpLink)->next;
+        }
+        *swpLink = NULL;
+
+        memParameters = parameters;
+        if (parameters.policy == Tlsf)
+        {
+            memFreeHead = memOccupiedHead = NULL;
+            memTlsfRestore(memFree, memOccupied);
+        }
+        else
+        {
+            memFreeHead = restoreList(memFree);
+            memOccupiedHead = restoreList(memOccupied);
+        }
+        memTreeRoot = memTree.empty() ? NULL : restoreTree(memTree, 0);
+
+        /* the free memory statistics are not stored, as they follow from the free blocks */
+        memStatsReset();
+        for (const MemBlock &b : memFree)
+            memStatsInsert(b.size);
+        for (const SnapshotTreeNode &n : memTree)
+        {
+            if (n.state == FREE)
+                memStatsInsert(n.block.size);
+        }
+
+        /* the slabs, whose blocks are already in the occupied list */
+        for (uint32_t k = 0; k + MEM_SLAB_OBJECTS <= memSlabs.size(); k += MEM_SLAB_OBJECTS)
+            memSlabRestore(&memSlabs[k]);
+
+        /* the roots of a buddy forest, and the free blocks per root, follow from the tree */
+        if (parameters.policy == BuddyForest)
+            memBuddyForestRestore(memTreeRoot);
+
+        /* and so do the shadow bitmap and the first fit array, if enabled */
+        memBitmapRebuild();
+        memFitRebuild();
+
+        /* the settings that change how the simulation goes on, and the metrics so far */
+        memLazyWatermark = settings.lazyWatermark;
+        memMergeDeferred = settings.mergeDeferred;
+        simCompactionOn = settings.compactionOn;
+        simCompactionFixedCost = settings.compactionFixedCost;
+        simCompactionChunkCost = settings.compactionChunkCost;
+        soMetricsSet(&metrics);
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
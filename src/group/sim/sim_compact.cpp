@@ -0,0 +1,60 @@
+/*
+ *  \author Joseane Pereira 107474
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+namespace group
+{
+
+// ================================================================================== //
+
+    MemSize simProfileSize(const AddressSpaceProfile *profile);
+    MemSize simFreeMemory();
+
+    /* compaction settings, kept across simInit, and stored by simCheckpoint */
+    bool simCompactionOn = false;
+    SimTime simCompactionFixedCost = 0;
+    SimTime simCompactionChunkCost = 0;
+
+    /*
+     * Called when memAlloc fails to map the given profile.
+     * After a compaction, all the free memory is a single block, so the profile
+     * can be mapped if and only if it is not bigger than the whole free memory;
+     * thus, that cheap check decides whether compacting is worth it.
+     * The blocks moved are updated in the PCT in one batch, and the time
+     * the compaction takes is returned in delay, to be charged to the process.
+     */
+    AddressSpaceMapping *simCompactAlloc(uint32_t pid, AddressSpaceProfile *profile, SimTime *delay)
+    {
+        if (not simCompactionOn or memParameters.policy != FirstFit)
+            return NO_MAPPING;
+
+        if (simProfileSize(profile) > simFreeMemory())
+            return NO_MAPPING;
+
+        RelocationTable *table = memCompact();
+        pctRelocate(table);
+
+        *delay = simCompactionFixedCost + simCompactionChunkCost * (table->bytes / memParameters.chunkSize);
+        soMetricsCompact(simTime, table->bytes, *delay);
+
+        return memAlloc(pid, profile);
+    }
+
+// ================================================================================== //
+
+    void simSetCompaction(bool on, SimTime fixedCost, SimTime chunkCost)
+    {
+        soProbe(114, "%s(%s, %" FMT_TIME ", %" FMT_TIME ")\n", __func__, on ? "true" : "false", fixedCost, chunkCost);
+
+        simCompactionOn = on;
+        simCompactionFixedCost = fixedCost;
+        simCompactionChunkCost = chunkCost;
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
@@ -32,7 +32,7 @@ namespace group
 
         srand(seed);
 
-    	uint32_t arrivalTime = 0;
+    	SimTime arrivalTime = 0;
         for(uint32_t i = 0; i < n; ++i){
             uint32_t pid = rand() % 65535 + 1;
             uint32_t t = 1;
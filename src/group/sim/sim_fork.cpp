@@ -0,0 +1,246 @@
+/*
+ *  \author Guilherme Santos 107961
+ *  \author João Gaspar 107708
+ */
+
+#include "somm23.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <map>
+#include <vector>
+
+namespace group
+{
+
+    MemSize simFreeMemory();
+    void simAdmitSwapped();
+
+// ================================================================================== //
+
+    /*
+     * The state of every module lives in global variables and heap nodes,
+     * so a branch is a child process: fork shares all pages copy-on-write,
+     * and only the pages a branch touches are actually copied.
+     * A branch sends its metrics, through a pipe, when it exits,
+     * which the parent takes in simJoin.
+     */
+    static int branchFd = -1;                   // in a branch, the pipe its metrics go to
+    static bool branchExitSet = false;          // true once simBranchExit is registered
+    static std::map<pid_t, int> branches;       // in the parent, the pipe of every branch
+
+    static void simBranchExit()
+    {
+        if (branchFd == -1)
+            return;
+
+        SoMetrics metrics;
+        soMetricsGet(&metrics);
+        const char *p = (const char *)&metrics;
+        size_t left = sizeof(metrics);
+        while (left != 0)
+        {
+            ssize_t n = write(branchFd, p, left);
+            if (n == -1 and errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            p += n;
+            left -= n;
+        }
+        close(branchFd);
+        branchFd = -1;
+    }
+
+// ================================================================================== //
+
+    /* the active processes, in the order they became active */
+    static void simActivePids(std::vector<uint32_t> &pids)
+    {
+        if (soBinSelected(304))
+        {
+            for (PctNode *p = pctHead; p != NULL; p = p->next)
+            {
+                if (p->pcb.state == ACTIVE)
+                    pids.push_back(p->pcb.pid);
+            }
+        }
+        else
+        {
+            pids.resize(pctCountInState(ACTIVE));
+            pctGetPidsInState(ACTIVE, pids.data(), pids.size());
+        }
+    }
+
+    /* remove the pending TERMINATE event of the given process, if any */
+    static void simDropTermination(uint32_t pid)
+    {
+        for (FeqEventNode **link = &feqHead; *link != NULL; link = &(*link)->next)
+        {
+            if ((*link)->event.type == TERMINATE and (*link)->event.pid == pid)
+            {
+                FeqEventNode *node = *link;
+                *link = node->next;
+                delete node;
+                return;
+            }
+        }
+    }
+
+    /*
+     * Release the memory of the branch and map the active processes into a new one,
+     * in the order they became active; their mappings in the PCT are replaced.
+     * As on arrival, a process that does not fit is swapped, or discarded if it can never fit,
+     * and its termination is dropped.
+     * The metrics take the capacity of the new memory, and the memory the processes use in it.
+     * The swapped processes that fit into the new memory are then activated.
+     */
+    static void simRemap(MemSize mSize, MemSize osSize, MemSize cSize, AllocationPolicy policy)
+    {
+        std::vector<uint32_t> pids;
+        simActivePids(pids);
+
+        memTerm();
+        memInit(mSize, osSize, cSize, policy);
+
+        SoMetrics metrics;
+        soMetricsGet(&metrics);
+        metrics.memCapacity = simFreeMemory();
+        uint32_t swapped = 0, discarded = 0;
+        for (uint32_t pid : pids)
+        {
+            AddressSpaceProfile *profile = pctGetAddressSpaceProfile(pid);
+            AddressSpaceMapping *mapping = memAlloc(pid, profile);
+            if (mapping == IMPOSSIBLE_MAPPING)
+            {
+                simDropTermination(pid);
+                pctUpdateState(pid, DISCARDED);
+                discarded++;
+            }
+            else if (mapping == NO_MAPPING)
+            {
+                simDropTermination(pid);
+                swpAdd(pid, profile);
+                pctUpdateState(pid, SWAPPED);
+                swapped++;
+            }
+            else
+            {
+                *pctGetAddressSpaceMapping(pid) = *mapping;
+            }
+        }
+        metrics.memUsed = metrics.memCapacity - simFreeMemory();
+        if (metrics.memUsed > metrics.memPeak)
+            metrics.memPeak = metrics.memUsed;
+        soMetricsSet(&metrics);
+        for (uint32_t i = 0; i < discarded; i++)
+            soMetricsDiscard(simTime, false);
+        for (uint32_t i = 0; i < swapped; i++)
+            soMetricsSwap(simTime);
+
+        simAdmitSwapped();
+    }
+
+// ================================================================================== //
+
+    pid_t simFork(MemSize mSize, MemSize osSize, MemSize cSize, AllocationPolicy policy)
+    {
+        const char *pas = policy == FirstFit ? "FirstFit" : policy == BuddySystem ? "BuddySystem" : policy == Slab ? "Slab" : policy == Tlsf ? "Tlsf" : policy == BuddyForest ? "BuddyForest" : "Unkown";
+        soProbe(111, "%s(%#" FMT_ADDR ", %#" FMT_ADDR ", %#" FMT_ADDR ", %s)\n", __func__, mSize, osSize, cSize, pas);
+
+        int fds[2];
+        if (pipe(fds) == -1)
+            throw Exception(errno, __func__);
+
+        /* avoid buffered output to be written by both branches */
+        fflush(NULL);
+
+        pid_t pid = fork();
+        if (pid == -1)
+        {
+            int en = errno;
+            close(fds[0]);
+            close(fds[1]);
+            throw Exception(en, __func__);
+        }
+
+        if (pid != 0)
+        {
+            close(fds[1]);
+            branches[pid] = fds[0];
+            return pid;
+        }
+
+        /* the new branch only keeps the pipe to its parent */
+        close(fds[0]);
+        for (const auto &b : branches)
+            close(b.second);
+        branches.clear();
+        if (branchFd != -1)
+            close(branchFd);
+        branchFd = fds[1];
+        if (not branchExitSet)
+        {
+            atexit(simBranchExit);
+            branchExitSet = true;
+        }
+
+        /* a branch with the memory in use is a plain clone */
+        if (mSize != memParameters.totalSize or osSize != memParameters.kernelSize
+                or cSize != memParameters.chunkSize or policy != memParameters.policy)
+            simRemap(mSize, osSize, cSize, policy);
+        return 0;
+    }
+
+// ================================================================================== //
+
+    int simJoin(pid_t pid, SoMetrics *metrics)
+    {
+        soProbe(112, "%s(%d, %p)\n", __func__, pid, metrics);
+
+        auto it = branches.find(pid);
+        if (it == branches.end())
+            throw Exception(EINVAL, __func__);
+        int fd = it->second;
+        branches.erase(it);
+
+        /* the metrics are sent when the branch exits, and the pipe is closed if it dies before */
+        SoMetrics received;
+        char *p = (char *)&received;
+        size_t left = sizeof(received);
+        while (left != 0)
+        {
+            ssize_t n = read(fd, p, left);
+            if (n == -1 and errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            p += n;
+            left -= n;
+        }
+        close(fd);
+        if (left != 0)
+            memset(&received, 0, sizeof(received));
+        if (metrics != NULL)
+            *metrics = received;
+
+        int status;
+        while (waitpid(pid, &status, 0) == -1)
+        {
+            if (errno != EINTR)
+                throw Exception(errno, __func__);
+        }
+
+        if (WIFSIGNALED(status))
+            return 128 + WTERMSIG(status);
+        return WEXITSTATUS(status);
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
@@ -7,15 +7,17 @@
 namespace group
 {
 
+    MemSize simFreeMemory();
+
 // ================================================================================== //
 
     /*
      * \brief Init the module's internal data structure
      */
-    void simInit(uint32_t mSize, uint32_t osSize, uint32_t cSize, AllocationPolicy policy)
+    void simInit(MemSize mSize, MemSize osSize, MemSize cSize, AllocationPolicy policy)
     {
-        const char *pas = policy == FirstFit ? "FirstFit" : policy == BuddySystem ? "BuddySystem" : "Unkown";
-        soProbe(101, "%s(%#x, %#x, %#x, %s)\n", __func__, mSize, osSize, cSize, pas);
+        const char *pas = policy == FirstFit ? "FirstFit" : policy == BuddySystem ? "BuddySystem" : policy == Slab ? "Slab" : policy == Tlsf ? "Tlsf" : policy == BuddyForest ? "BuddyForest" : "Unkown";
+        soProbe(101, "%s(%#" FMT_ADDR ", %#" FMT_ADDR ", %#" FMT_ADDR ", %s)\n", __func__, mSize, osSize, cSize, pas);
 
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
@@ -24,10 +26,12 @@ namespace group
         stepCount = 0;
         simTime = 0;
 
-        pctInit();
         feqInit();
+        pctInit();
         swpInit();
         memInit(mSize, osSize, cSize, policy);
+
+        soMetricsReset(simFreeMemory());
     }
 
 // ================================================================================== //
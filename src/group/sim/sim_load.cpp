@@ -7,11 +7,31 @@
 
 #include "somm23.h"
 #include <cstring>
+#include <cctype>
+#include <cstdlib>
+
+#include <string>
 
 
 namespace group
 {
 
+// ================================================================================== //
+
+    /* read a whole line, of any length, into line; return false at the end of the file */
+    static bool simReadLine(FILE *file, std::string &line)
+    {
+        char buf[256];
+        line.clear();
+        while (fgets(buf, sizeof(buf), file) != NULL)
+        {
+            line += buf;
+            if (line.back() == '\n')
+                break;
+        }
+        return not line.empty();
+    }
+
 // ================================================================================== //
 
     void simLoad(const char *fname)
@@ -31,23 +51,42 @@ namespace group
             throw Exception(errno, __func__);
         }
 
-        char line[256];
+        std::string line;
         uint32_t lineNumber = 0;
 
-        while (fgets(line, sizeof(line), file) != NULL)
+        while (simReadLine(file, line))
         {
             lineNumber++;
 
-            if (line[0] == '%' || line[0] == '\n')
+            /* whitespaces are syntactically irrelevant, so they are removed first */
+            size_t dst = 0;
+            for (char c : line)
+            {
+                if (not isspace((unsigned char)c))
+                    line[dst++] = c;
+            }
+            line.resize(dst);
+
+            if (line.empty() || line[0] == '%')
                 continue;
 
-            uint32_t pid, arrivalTime, lifetime;
-            char segmentCountStr[256];
+            if (forthcomingTable.count == MAX_PROCESSES)
+            {
+                fprintf(stderr, "Error parsing line %u: Too many processes\n", lineNumber);
+                fclose(file);
+                throw Exception(EINVAL, __func__);
+            }
+
+            uint32_t pid;
+            unsigned long long arrivalTime, lifetime;
+            int n = 0;
 
-            int result = sscanf(line, "%u;%u;%u;%s", &pid, &arrivalTime, &lifetime, segmentCountStr);
-            if (result != 4)
+            errno = 0;
+            int result = sscanf(line.c_str(), "%u;%llu;%llu;%n", &pid, &arrivalTime, &lifetime, &n);
+            if (result != 3 || n == 0)
             {
                 fprintf(stderr, "Error parsing line %u: Invalid format\n", lineNumber);
+                fclose(file);
                 throw Exception(EINVAL, __func__);
             }
 
@@ -56,6 +95,7 @@ namespace group
                 if (forthcomingTable.process[i].pid == pid)
                 {
                     fprintf(stderr, "Error parsing line %u: Duplicate PID\n", lineNumber);
+                    fclose(file);
                     throw Exception(EINVAL, __func__);
                 }
             }
@@ -63,61 +103,65 @@ namespace group
             if (forthcomingTable.count > 0 && arrivalTime < forthcomingTable.process[forthcomingTable.count - 1].arrivalTime)
             {
                 fprintf(stderr, "Error parsing line %u: Arrival times must be in ascending order\n", lineNumber);
+                fclose(file);
                 throw Exception(EINVAL, __func__);
             }
 
-            if (lifetime <= 0)
+            if (lifetime == 0)
             {
                 fprintf(stderr, "Error parsing line %u: Lifetime must be greater than zero\n", lineNumber);
+                fclose(file);
                 throw Exception(EINVAL, __func__);
             }
 
-            forthcomingTable.process[forthcomingTable.count].pid = pid;
-            forthcomingTable.process[forthcomingTable.count].arrivalTime = arrivalTime;
-            forthcomingTable.process[forthcomingTable.count].lifetime = lifetime;
+            /* the times are narrowed to SimTime, which must also hold the end of the lifetime */
+            if (errno == ERANGE || arrivalTime > (SimTime)-1 || lifetime > (SimTime)-1 - arrivalTime)
+            {
+                fprintf(stderr, "Error parsing line %u: Time out of range\n", lineNumber);
+                fclose(file);
+                throw Exception(EINVAL, __func__);
+            }
 
-            int segmentCount = 0;
-            
-            const char outer_delimiters[] = ";";
-            const char inner_delimiters[] = ",";
- 
-            char* token;
-            char* outer_saveptr = NULL;
-            char* inner_saveptr = NULL;
-            
-            token = strtok_r(line, outer_delimiters, &outer_saveptr);
-    
-            int counter = 0; 
-            int cnt = 0;   
-            while (token != NULL)
+            ForthcomingProcess &process = forthcomingTable.process[forthcomingTable.count];
+            process.pid = pid;
+            process.arrivalTime = arrivalTime;
+            process.lifetime = lifetime;
+
+            /* the address space profile, a comma-separated list of segment sizes */
+            uint32_t segmentCount = 0;
+            const char *p = line.c_str() + n;
+            while (true)
             {
-                cnt = 0;
-                char* inner_token = strtok_r(token, inner_delimiters, &inner_saveptr);
-                
-                segmentCount++;
-                if (segmentCount > MAX_SEGMENTS)
+                char *end;
+                errno = 0;
+                unsigned long long size = strtoull(p, &end, 0);
+                if (end == p || (*end != ',' && *end != '\0'))
                 {
-                    fprintf(stderr, "Error parsing line %u: Exceeded maximum segment count\n", lineNumber);
+                    fprintf(stderr, "Error parsing line %u: Invalid format\n", lineNumber);
+                    fclose(file);
                     throw Exception(EINVAL, __func__);
                 }
-
-                if (counter >= 3){
-                    while (inner_token != NULL){
-                        
-                        int size = atoi(inner_token);
-                        inner_token = strtok_r(NULL, inner_delimiters, &inner_saveptr);
-                        forthcomingTable.process[forthcomingTable.count].addressSpace.size[cnt] = size;
-                        cnt++;
-                    }
+                if (errno == ERANGE || size > (MemSize)-1)
+                {
+                    fprintf(stderr, "Error parsing line %u: Segment size out of range\n", lineNumber);
+                    fclose(file);
+                    throw Exception(EINVAL, __func__);
                 }
-                
-
-                token = strtok_r(NULL, outer_delimiters, &outer_saveptr);  
-                counter++;         
+                if (segmentCount == MAX_SEGMENTS)
+                {
+                    fprintf(stderr, "Error parsing line %u: Exceeded maximum segment count\n", lineNumber);
+                    fclose(file);
+                    throw Exception(EINVAL, __func__);
+                }
+                process.addressSpace.size[segmentCount++] = size;
+                if (*end == '\0')
+                    break;
+                p = end + 1;
             }
-            forthcomingTable.process[forthcomingTable.count].addressSpace.segmentCount = segmentCount;
+            process.addressSpace.segmentCount = segmentCount;
 
             forthcomingTable.count++;
+            feqInsert(ARRIVAL, arrivalTime, pid);
         }
 
         fclose(file);
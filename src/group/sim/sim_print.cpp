@@ -12,6 +12,31 @@
 namespace group 
 {
 
+// ================================================================================== //
+
+    /* width of the address space profile column, which depends on the number of segments */
+    static const int PROFILE_WIDTH = 10 * MAX_SEGMENTS - 1;
+    static_assert(PROFILE_WIDTH >= 25, "the address space profile column is narrower than the simulation time header");
+    static const int SIM_WIDTH = 28 + 1 + PROFILE_WIDTH;
+
+    /* print an horizontal rule, with or without the column separators */
+    static void simPrintRule(FILE *fout, char fill, bool columns)
+    {
+        static const int widths[] = { 7, 9, 10, PROFILE_WIDTH };
+
+        fputc('+', fout);
+        for (uint32_t c = 0; c < sizeof(widths) / sizeof(widths[0]); c++)
+        {
+            for (int i = 0; i < widths[c]; i++)
+                fputc(fill, fout);
+            if (columns or c == sizeof(widths) / sizeof(widths[0]) - 1)
+                fputc('+', fout);
+            else
+                fputc(fill, fout);
+        }
+        fputc('\n', fout);
+    }
+
 // ================================================================================== //
 
     void simPrint(FILE *fout)
@@ -20,34 +45,34 @@ namespace group
 
         require(fout != NULL and fileno(fout) != -1, "fout must be a valid file stream");
 
-        fprintf(fout, "+====================================================================+\n");
-        fprintf(fout, "|                          forthcomingTable                          |\n");
-        fprintf(fout, "+-------+---------+----------+---------------------------------------+\n");
-        fprintf(fout, "|    Simulation step: %6u |              Simulation time: %7u |\n", stepCount, simTime);
-        fprintf(fout, "+-------+---------+----------+---------------------------------------+\n");
-        fprintf(fout, "|  PID  | arrival | lifetime |         address space profile         |\n");
-        fprintf(fout, "+-------+---------+----------+---------------------------------------+\n");
+        simPrintRule(fout, '=', false);
+        fprintf(fout, "|%*s%-*s|\n", (SIM_WIDTH - 16) / 2, "", SIM_WIDTH - (SIM_WIDTH - 16) / 2, "forthcomingTable");
+        simPrintRule(fout, '-', true);
+        fprintf(fout, "|    Simulation step: %6u |%*sSimulation time: %7" FMT_TIME " |\n", stepCount, PROFILE_WIDTH - 25, "", simTime);
+        simPrintRule(fout, '-', true);
+        fprintf(fout, "|  PID  | arrival | lifetime |%*s%-*s|\n", (PROFILE_WIDTH - 21) / 2, "", PROFILE_WIDTH - (PROFILE_WIDTH - 21) / 2, "address space profile");
+        simPrintRule(fout, '-', true);
 
         for (uint32_t i = 0; i < forthcomingTable.count; ++i)
         {
-            uint32_t sizes[forthcomingTable.process[i].addressSpace.segmentCount];   
-            fprintf(fout, "| %5u | %7u | %8u |", forthcomingTable.process[i].pid, forthcomingTable.process[i].arrivalTime, forthcomingTable.process[i].lifetime);
+            MemSize sizes[forthcomingTable.process[i].addressSpace.segmentCount];   
+            fprintf(fout, "| %5u | %7" FMT_TIME " | %8" FMT_TIME " |", forthcomingTable.process[i].pid, forthcomingTable.process[i].arrivalTime, forthcomingTable.process[i].lifetime);
             
-            for (uint32_t j = 0; j < 4; ++j) {
+            for (uint32_t j = 0; j < MAX_SEGMENTS; ++j) {
                 if (j < forthcomingTable.process[i].addressSpace.segmentCount && forthcomingTable.process[i].addressSpace.size[j] != 0) {
                     sizes[j] = forthcomingTable.process[i].addressSpace.size[j];
-                    fprintf(fout, " %7u", sizes[j]);
+                    fprintf(fout, " %7" FMT_SIZE, sizes[j]);
                 } else {
                     fprintf(fout, "   ---  ");
                 }
-                if (j < 3) {
+                if (j < MAX_SEGMENTS - 1) {
                     fprintf(fout, " :");
                 }
             }
             fprintf(fout," |\n");            
         }
 
-        fprintf(fout, "+====================================================================+\n");
+        simPrintRule(fout, '=', false);
         fprintf(fout, "\n");
 
     }
@@ -17,7 +17,7 @@ namespace group
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
-        for (uint32_t i = 0; i < cnt || (cnt == 0 && simStep()); ++i){}
+        for (uint32_t i = 0; (cnt == 0 || i < cnt) && simStep(); ++i){}
     }
 
 // ================================================================================== //
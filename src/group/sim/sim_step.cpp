@@ -9,80 +9,197 @@ namespace group
 
 // ================================================================================== //
 
-    bool simStep()
+    /*
+     * The processing of each kind of event is shared with simStepTime,
+     * and feeds the metrics toolkit, with the memory a process takes
+     * measured as the change of the free memory, so that the rounding of every policy is accounted for
+     */
+
+    AddressSpaceMapping *simCompactAlloc(uint32_t pid, AddressSpaceProfile *profile, SimTime *delay);
+    MemSize memStatsFreeBytes();
+
+    /*
+     * Size of the block memAlloc assigns to a segment:
+     * the size rounded up to the chunk size, and, for the buddy system,
+     * further rounded up to a power of two.
+     */
+    static MemSize simBlockSize(MemSize size)
     {
-        soProbe(107, "%s()\n", __func__);
-
-        /* TODO POINT: Replace next instruction with your code */
-        
-            //Process, if possible, a step of the simulation.
+        MemSize chunk = memParameters.chunkSize;
+        MemSize block = (size + chunk - 1) / chunk * chunk;
+        if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest)
+        {
+            MemSize pow2 = chunk;
+            while (pow2 < block)
+                pow2 <<= 1;
+            block = pow2;
+        }
+        return block;
+    }
 
-            //This function is responsible for fetching an event from the FEQ module and process it, interacting with all the other modules as necessary. If the FEQ queue is empty, nothing should be done and the function must return false. Otherwise, true must be returned after the properly processing.
+    /* memory assigned to a whole address space */
+    MemSize simProfileSize(const AddressSpaceProfile *profile)
+    {
+        MemSize total = 0;
+        for (uint32_t i = 0; i < profile->segmentCount; i++)
+            total += simBlockSize(profile->size[i]);
+        return total;
+    }
 
-            ///When processing occurs, the sequence of operation is as follows:
+    static MemSize simTreeFreeBytes(const MemTreeNode *node)
+    {
+        if (node == NULL)
+            return 0;
+        if (node->state == SPLITTED)
+            return simTreeFreeBytes(node->left) + simTreeFreeBytes(node->right);
+        return node->state == FREE ? node->block.size : 0;
+    }
 
-                //An event should be fetched from the future event queue and processed. The processing to be done depends on the event type, ARRIVAL or TERMINATE.
+    /* total amount of free memory */
+    MemSize simFreeBytes()
+    {
+        if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest)
+            return simTreeFreeBytes(memTreeRoot);
 
-                //An ARRIVAL event firstly cause the addition of a NEW process to the set of active processes. Then, depending on memory requestements and memory availability, the new process changes state to ACTIVE, SWAPPED or DISCARDED.
-                
-                //A TERMINATE event causes the associated process to change state to FINISHED. Then, because memory is released, some swapped-out processes can now be activated for execution. Processes in the SWP queue must be handled in order, but a previously swapped-out process should not prevent a later one from being activated.
+        MemSize total = 0;
+        for (MemListNode *p = memFreeHead; p != NULL; p = p->next)
+            total += p->block.size;
+        return total;
+    }
 
-            //Returns
+    /*
+     * total amount of free memory, taken from the statistics the group version
+     * of the MEM module keeps up to date, or, if any binary version is in use,
+     * by walking the free list or tree;
+     * it is read without probing, as it is called on every event to feed the metrics
+     */
+    MemSize simFreeMemory()
+    {
+        for (uint32_t id = 501; id <= 509; id++)
+        {
+            if (soBinSelected(id))
+                return simFreeBytes();
+        }
+        return memStatsFreeBytes();
+    }
 
-                //true if one step was processed; false otherwise
+    /*
+     * forthcoming process with the given PID, looked up without probing,
+     * so that feeding the metrics does not show up in the probing trace
+     */
+    static const ForthcomingProcess *simFindProcess(uint32_t pid)
+    {
+        for (uint32_t i = 0; i < forthcomingTable.count; i++)
+        {
+            if (forthcomingTable.process[i].pid == pid)
+                return &forthcomingTable.process[i];
+        }
+        throw Exception(EINVAL, __func__);
+    }
 
-        
-        if (feqIsEmpty()){
-            return false;
+    /* ARRIVAL: the new process becomes ACTIVE, SWAPPED or DISCARDED */
+    void simArrive(uint32_t pid)
+    {
+        ForthcomingProcess *process = simGetProcess(pid);
+        pctInsert(pid, process->arrivalTime, process->lifetime, &process->addressSpace);
+        soMetricsArrival(simTime);
+
+        SimTime delay = 0;
+        MemSize freeBytes = simFreeMemory();
+        AddressSpaceMapping *mapping = memAlloc(pid, &process->addressSpace);
+        if (mapping == NO_MAPPING)
+            mapping = simCompactAlloc(pid, &process->addressSpace, &delay);
+
+        if (mapping == IMPOSSIBLE_MAPPING)
+        {
+            pctUpdateState(pid, DISCARDED);
+            soMetricsDiscard(simTime, false);
         }
-        
-        FutureEvent event = feqPop();
+        else if (mapping == NO_MAPPING)
+        {
+            swpAdd(pid, &process->addressSpace);
+            pctUpdateState(pid, SWAPPED);
+            soMetricsSwap(simTime);
+        }
+        else
+        {
+            feqInsert(TERMINATE, simTime + delay + process->lifetime, pid);
+            pctUpdateState(pid, ACTIVE, simTime + delay, mapping);
+            soMetricsActivate(simTime + delay, process->arrivalTime, freeBytes - simFreeMemory(), false);
+        }
+    }
 
-        // new process
-        ForthcomingProcess* process = simGetProcess(event.pid);
-        pctInsert(process->pid, process->arrivalTime, process->lifetime, &process->addressSpace);
-        ProcessState state;
-        // try allocate memory
-        AddressSpaceMapping* space = memAlloc(process->pid, &process->addressSpace);
-        fprintf (stderr, "space: %p\n", space);
-
-        if(event.type == ARRIVAL){
-            
-
-            if(space == NULL_ADDRESS){
-                // no memory available now
-                state = SWAPPED;
-                pctUpdateState(process->pid, state);
-                // add to swap queue
-                swpAdd(process->pid, &process->addressSpace);
-                feqInsert(TERMINATE, process->arrivalTime + process->lifetime, process->pid);
-                return true;
-            }else if (space == IMPOSSIBLE_MAPPING) {
-                // no memory available 
-                state = DISCARDED;
-                pctUpdateState(process->pid, state);
-                feqInsert(TERMINATE, process->arrivalTime + process->lifetime, process->pid);
-                return true;
-            }else{
-                // memory available 
-                state = ACTIVE;
-                
-                pctUpdateState(process->pid, state, process->arrivalTime, pctGetAddressSpaceMapping(process->pid));
-                feqInsert(TERMINATE, process->arrivalTime + process->lifetime, process->pid);
-                return true;
-            }
+    /* TERMINATE: the process releases its memory and becomes FINISHED */
+    void simFinish(uint32_t pid)
+    {
+        MemSize freeBytes = simFreeMemory();
+        memFree(pctGetAddressSpaceMapping(pid));
+        pctUpdateState(pid, FINISHED, simTime);
+        const ForthcomingProcess *process = simFindProcess(pid);
+        soMetricsFinish(simTime, process->arrivalTime, simFreeMemory() - freeBytes);
+    }
 
+    /*
+     * Swapped processes are tried in queue order,
+     * one that does not fit does not prevent later ones from being activated;
+     * one that can never fit, which only happens in a branch with a smaller memory, is discarded
+     */
+    void simAdmitSwapped()
+    {
+        uint32_t idx = 0;
+        SwappedProcess *swapped;
+        while ((swapped = swpPeek(idx)) != NULL)
+        {
+            uint32_t pid = swapped->pid;
+            SimTime delay = 0;
+            MemSize freeBytes = simFreeMemory();
+            AddressSpaceProfile *profile = pctGetAddressSpaceProfile(pid);
+            AddressSpaceMapping *mapping = memAlloc(pid, profile);
+            if (mapping == NO_MAPPING)
+                mapping = simCompactAlloc(pid, profile, &delay);
+            if (mapping == NO_MAPPING)
+            {
+                idx++;
+                continue;
+            }
+            if (mapping == IMPOSSIBLE_MAPPING)
+            {
+                pctUpdateState(pid, DISCARDED);
+                soMetricsDiscard(simTime, true);
+                swpRemove(idx);
+                continue;
+            }
+            feqInsert(TERMINATE, simTime + delay + pctGetLifetime(pid), pid);
+            pctUpdateState(pid, ACTIVE, simTime + delay, mapping);
+            soMetricsActivate(simTime + delay, simFindProcess(pid)->arrivalTime, freeBytes - simFreeMemory(), true);
+            swpRemove(idx);
         }
+    }
+
+// ================================================================================== //
 
-        if (event.type == TERMINATE){
-            ForthcomingProcess* process = simGetProcess(event.pid);
-            pctInsert(process->pid, process->arrivalTime, process->lifetime, &process->addressSpace);
-            pctUpdateState(process->pid, FINISHED, process->lifetime);
-            memFree(space);
-            feqInsert(TERMINATE, process->arrivalTime + process->lifetime, process->pid);
-            return true;
+    bool simStep()
+    {
+        soProbe(107, "%s()\n", __func__);
+
+        if (feqIsEmpty())
+            return false;
+
+        FutureEvent event = feqPop();
+        stepCount++;
+        simTime = event.time;
+
+        if (event.type == ARRIVAL)
+        {
+            simArrive(event.pid);
         }
-        return false;
+        else
+        {
+            simFinish(event.pid);
+            simAdmitSwapped();
+        }
+
+        return true;
     }
 
 // ================================================================================== //
@@ -0,0 +1,148 @@
+/*
+ *  \author Joseane Pereira 107474
+ */
+
+#include "somm23.h"
+
+#include <stdint.h>
+
+namespace group
+{
+
+// ================================================================================== //
+
+    void simArrive(uint32_t pid);
+    void simFinish(uint32_t pid);
+    void simAdmitSwapped();
+    MemSize simProfileSize(const AddressSpaceProfile *profile);
+    MemSize simFreeMemory();
+
+    extern uint32_t memLazyWatermark;
+
+    /*
+     * smallest amount of memory any swapped process needs, the largest size if none is swapped;
+     * the queue is walked directly, as swpPeek costs a walk per index,
+     * skipping nodes with PID 0, which are not processes
+     */
+    static MemSize simMinSwappedSize()
+    {
+        MemSize least = (MemSize)-1;
+        for (SwpNode *p = swpHead; p != NULL; p = p->next)
+        {
+            if (p->process.pid == 0)
+                continue;
+            MemSize size = simProfileSize(&p->process.profile);
+            if (size < least)
+                least = size;
+        }
+        return least;
+    }
+
+    /*
+     * true if an admission pass that activates no process leaves the memory as it was;
+     * not for slabs, as a failed allocation gives the kept empty slabs back, nor for TLSF,
+     * whose free lists take the segments given back by a failed allocation in another order,
+     * nor for a lazy buddy system, which merges all free blocks if a search fails
+     */
+    static bool simSkipAdmission()
+    {
+        if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest)
+            return memLazyWatermark == 0;
+        return memParameters.policy == FirstFit;
+    }
+
+    /*
+     * true if merging the released blocks once ends in the same memory as merging them one by one;
+     * not for TLSF, whose free lists keep the order blocks were released in, nor for a lazy
+     * buddy system, which decides on every release whether to merge
+     */
+    static bool simDeferMerge()
+    {
+        if (memParameters.policy == Tlsf)
+            return false;
+        if (memParameters.policy == BuddySystem or memParameters.policy == BuddyForest)
+            return memLazyWatermark == 0;
+        return true;
+    }
+
+    /* true if the next event exists and happens at the current time */
+    static bool simSameTime()
+    {
+        return not feqIsEmpty() and feqHead->event.time == simTime;
+    }
+
+// ================================================================================== //
+
+    /*
+     * A swapped process can only be admitted if the whole free memory is at least
+     * the memory it needs, so, while that does not hold for any of them, the admission
+     * pass that follows a TERMINATE can not change anything and is skipped,
+     * for the policies where a pass that admits nothing has no side effects.
+     * The pass only removes processes from the SWP queue, so the smallest need taken before
+     * the first TERMINATE remains a lower bound for the whole time stamp.
+     * Since no allocation happens in between, releases are not merged one by one,
+     * but only before an admission pass, or at the end of the TERMINATE events,
+     * for the policies where the merged free memory does not depend on the order blocks were released.
+     * So the final state is the same as the one reached by calling simStep for every event.
+     */
+    bool simStepTime()
+    {
+        soProbe(113, "%s()\n", __func__);
+
+        if (feqIsEmpty())
+            return false;
+
+        FutureEvent event = feqPop();
+        stepCount++;
+        simTime = event.time;
+
+        /* TERMINATE events come first in a time stamp */
+        if (event.type == TERMINATE)
+        {
+            MemSize freeBytes = simFreeMemory();
+            MemSize needed = simSkipAdmission() ? simMinSwappedSize() : 0;
+            bool defer = simDeferMerge();
+            memDeferMerge(defer);
+            while (true)
+            {
+                freeBytes += simProfileSize(pctGetAddressSpaceProfile(event.pid));
+                simFinish(event.pid);
+
+                if (freeBytes >= needed)
+                {
+                    memDeferMerge(false);
+                    simAdmitSwapped();
+                    freeBytes = simFreeMemory();
+                    memDeferMerge(defer);
+                }
+
+                if (not simSameTime() or feqHead->event.type != TERMINATE)
+                    break;
+                event = feqPop();
+                stepCount++;
+            }
+            memDeferMerge(false);
+
+            if (not simSameTime())
+                return true;
+            event = feqPop();
+            stepCount++;
+        }
+
+        /* followed by the ARRIVAL ones */
+        while (true)
+        {
+            simArrive(event.pid);
+
+            if (not simSameTime())
+                break;
+            event = feqPop();
+            stepCount++;
+        }
+
+        return true;
+    }
+
+// ================================================================================== //
+
+} // end of namespace group
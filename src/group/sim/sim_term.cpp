@@ -16,14 +16,20 @@ namespace group
         /* TODO POINT: Replace next instruction with your code */
         /* throw Exception(ENOSYS, __func__); */
 
+        /* aggregate results, if a report stream was given */
+        soMetricsReport();
+
+        memTerm();
+        swpTerm();
         pctTerm();
-        //feqTerm();
-        //swpTerm();
-        //memTerm();
+        feqTerm();
 
         forthcomingTable.count = 0;
         stepCount = 0;
         simTime = 0;
+
+        /* per-function summary, if profiling is on */
+        soProfileReport();
     }
 
 // ================================================================================== //
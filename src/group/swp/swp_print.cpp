@@ -10,6 +10,31 @@
 namespace group
 {
 
+// ================================================================================== //
+
+    /* width of the address space profile column, which depends on the number of segments */
+    static const int PROFILE_WIDTH = 10 * MAX_SEGMENTS - 1;
+    static_assert(PROFILE_WIDTH >= 21, "the address space profile column is narrower than its header");
+    static const int SWP_WIDTH = 7 + 1 + PROFILE_WIDTH;
+
+    /* print an horizontal rule, with or without the column separators */
+    static void swpPrintRule(FILE *fout, char fill, bool columns)
+    {
+        static const int widths[] = { 7, PROFILE_WIDTH };
+
+        fputc('+', fout);
+        for (uint32_t c = 0; c < sizeof(widths) / sizeof(widths[0]); c++)
+        {
+            for (int i = 0; i < widths[c]; i++)
+                fputc(fill, fout);
+            if (columns or c == sizeof(widths) / sizeof(widths[0]) - 1)
+                fputc('+', fout);
+            else
+                fputc(fill, fout);
+        }
+        fputc('\n', fout);
+    }
+
 // ================================================================================== //
 
     void swpPrint(FILE *fout)
@@ -20,11 +45,11 @@ namespace group
 
         try
         {
-            fprintf(fout, "+===============================================+\n");
-            fprintf(fout, "|             Swapped Process Queue             |\n");
-            fprintf(fout, "+-------+---------------------------------------+\n");
-            fprintf(fout, "|  PID  |         address space profile         |\n");
-            fprintf(fout, "+-------+---------------------------------------+\n");
+            swpPrintRule(fout, '=', false);
+            fprintf(fout, "|%*s%-*s|\n", (SWP_WIDTH - 21) / 2, "", SWP_WIDTH - (SWP_WIDTH - 21) / 2, "Swapped Process Queue");
+            swpPrintRule(fout, '-', true);
+            fprintf(fout, "|  PID  |%*s%-*s|\n", (PROFILE_WIDTH - 21) / 2, "", PROFILE_WIDTH - (PROFILE_WIDTH - 21) / 2, "address space profile");
+            swpPrintRule(fout, '-', true);
 
             SwpNode *current = swpHead;
             while (current != nullptr)
@@ -35,17 +60,17 @@ namespace group
 
                     AddressSpaceProfile profile = current->process.profile;
 
-                    // Iterate over all segments, including empty ones up to 4 (or max segment count)
-                    for (uint32_t i = 0; i < 4; ++i)
+                    // Iterate over all segments, including empty ones up to the max segment count
+                    for (uint32_t i = 0; i < MAX_SEGMENTS; ++i)
                     {
                         if (i > 0) fprintf(fout, " : ");
 
                         if (i < profile.segmentCount) {
                             if (i == 0){
-                                fprintf(fout, "%8u", profile.size[i]);
+                                fprintf(fout, "%8" FMT_SIZE, profile.size[i]);
                             }
                             else {
-                                fprintf(fout, "%7u", profile.size[i]);
+                                fprintf(fout, "%7" FMT_SIZE, profile.size[i]);
                             }
                         } else {
                             fprintf(fout, "  ---  ");
@@ -57,7 +82,7 @@ namespace group
 
                 current = current->next;
             }
-            fprintf(fout, "+===============================================+\n");
+            swpPrintRule(fout, '=', false);
             fprintf(fout, "\n");
         }
         catch (const Exception &e)
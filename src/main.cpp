@@ -22,23 +22,32 @@
 
 /* ******************************************** */
 /* print help message */
-static uint32_t chunkSize = 0x100;
-static uint32_t memSize= 0x1000 * 0x100;
-static uint32_t osSize= 0x100 * 0x100;
+static MemSize chunkSize = 0x100;
+static MemSize memSize= 0x1000 * 0x100;
+static MemSize osSize= 0x100 * 0x100;
 static void printUsage(const char *cmd_name)
 {
     printf("Sinopsis: %s [OPTIONS] \n"
            "  OPTIONS:\n"
            "  -i infile     --- set input file (default: none)\n"
            "  -o outfile    --- set output file (default: stdout)\n"
-           "  -f buddy      --- set buddy system as the allocation policy (default: first fit)\n"
-           "  -c size       --- chunk size (default: %u or %#x)\n"
-           "  -m size       --- total memory size, in bytes, (default: %u or %#x)\n"
-           "  -k address    --- memory size, in bytes, used by (kernel) OS (default: %u or %#x)\n"
+           "  -f policy     --- set the allocation policy: first, buddy, forest, slab or tlsf (default: first)\n"
+           "  -c size       --- chunk size (default: %" FMT_SIZE " or %#" FMT_ADDR ")\n"
+           "  -m size       --- total memory size, in bytes, (default: %" FMT_SIZE " or %#" FMT_ADDR ")\n"
+           "  -k address    --- memory size, in bytes, used by (kernel) OS (default: %" FMT_SIZE " or %#" FMT_ADDR ")\n"
            "  -O outfile    --- set probing file (default: stdout)\n"
            "  -P num-num    --- set probing map to given ID range (default: 0-0)\n"
            "  -A num-num    --- add range of IDs to probing map\n"
            "  -R num-num    --- remove range of IDs from probing map\n"
+           "  -T outfile    --- turn on per-function profiling, reported to given file at the end (default: off)\n"
+           "  -M outfile    --- report simulation metrics to given file at the end (default: off)\n"
+           "  -C cost,cost  --- turn on first fit memory compaction, with given fixed and per chunk costs (default: off)\n"
+           "  -L num        --- lazy buddy system, leaving up to num free blocks per order unmerged (default: 0, off)\n"
+           "  -F            --- first fit search over arrays of the free block sizes, instead of the free list (default: off)\n"
+           "  -V            --- validate the memory blocks against a shadow bitmap of the chunks, after every step (default: off)\n"
+           "  -t            --- step a whole time stamp at a time, instead of a single event (default: off)\n"
+           "  -q            --- batch mode: run without pausing and print only a final report\n"
+           "  -p num        --- in batch mode, print a progress line to stderr every num steps, or time stamps (default: off)\n"
            "  -b            --- set bin selection map to 100-599\n"
            "  -g            --- set bin selection map to 0-0 (default)\n"
            "  -a num-num    --- add range of IDs to bin selection map\n"
@@ -77,6 +86,56 @@ bool pauseSim(const char *prompt = "")
     return true;
 }
 
+/* ******************************************** */
+/*
+ * print the final report of a batch run, before simTerm clears the state of the modules
+ */
+static void printReport(FILE *fout, uint64_t nanos)
+{
+    static const char *stateName[PCT_STATES] = { "NEW", "ACTIVE", "SWAPPED", "FINISHED", "DISCARDED" };
+
+    fprintf(fout, "Simulation report\n");
+    fprintf(fout, "  steps: %u, final time: %" FMT_TIME ", wall time: %.3f ms (%.0f steps/s)\n",
+            stepCount, simTime, nanos / 1e6, stepCount * 1e9 / (nanos != 0 ? nanos : 1));
+
+    uint32_t total = 0;
+    for (uint32_t s = 0; s < PCT_STATES; s++)
+        total += pctCountInState((ProcessState)s);
+    fprintf(fout, "  processes: %u (", total);
+    for (uint32_t s = 0; s < PCT_STATES; s++)
+        fprintf(fout, "%s%s %u", s == 0 ? "" : ", ", stateName[s], pctCountInState((ProcessState)s));
+    fprintf(fout, ")\n");
+
+    /* the statistics are kept by the group versions of the allocation functions only */
+    if (not soBinSelected(504) and not soBinSelected(505) and not soBinSelected(506)
+            and not soBinSelected(507) and not soBinSelected(508) and not soBinSelected(509))
+    {
+        MemStats stats;
+        memGetStats(&stats);
+        fprintf(fout, "  free memory: %#" FMT_ADDR " bytes in %u blocks, largest %#" FMT_ADDR
+                ", external fragmentation %.2f%%\n",
+                stats.freeBytes, stats.freeBlocks, stats.largestFree,
+                stats.freeBytes != 0 ? 100.0 * (stats.freeBytes - stats.largestFree) / stats.freeBytes : 0.0);
+    }
+}
+
+/* ******************************************** */
+/*
+ * run the given number of steps (all of them, if 0), of a single event,
+ * or of a whole time stamp, if byTime is set
+ */
+static void runSteps(uint32_t cnt, bool byTime)
+{
+    if (not byTime)
+    {
+        simRun(cnt);
+        return;
+    }
+    for (uint32_t i = 0; (cnt == 0 or i < cnt) and simStepTime(); i++)
+    {
+    }
+}
+
 /* ******************************************** */
 /* The main function */
 int main(int argc, char *argv[])
@@ -90,12 +149,20 @@ int main(int argc, char *argv[])
 
     /* default values for command line options */
     AllocationPolicy memPolicy = FirstFit;
+    bool compaction = false;
+    uint32_t lazyWatermark = 0;
+    bool fitArray = false;
+    bool validate = false;
+    bool byTime = false;
+    uint32_t fixedCost = 0, chunkCost = 0;
+    bool batch = false;
+    uint32_t progress = 0;
     const char *infile = NULL;
     const char *outfile = NULL;
 
     /* process command line options */
     int opt;
-    while ((opt = getopt(argc, argv, "i:o:f:k:m:c:O:P:A:R:bga:r:h")) != -1)
+    while ((opt = getopt(argc, argv, "i:o:f:k:m:c:O:P:A:R:T:M:C:L:FVtqp:bga:r:h")) != -1)
     {
         switch (opt)
         {
@@ -116,39 +183,45 @@ int main(int argc, char *argv[])
             }
             case 'f':
             {
-                if (optarg[0] == 'b') memPolicy = BuddySystem;
+                if (strcmp(optarg, "forest") == 0) memPolicy = BuddyForest;
+                else if (optarg[0] == 'b') memPolicy = BuddySystem;
+                else if (optarg[0] == 's') memPolicy = Slab;
+                else if (optarg[0] == 't') memPolicy = Tlsf;
                 break;
             }
             case 'c':          // set memory chunk size
             {
                 int n = 0;
-                sscanf(optarg, "%u%n", &chunkSize, &n);
-                if ((size_t)n == strlen(optarg)) break;
+                unsigned long long value;
+                sscanf(optarg, "%llu%n", &value, &n);
+                if ((size_t)n == strlen(optarg)) { chunkSize = value; break; }
                 n = 0;
-                sscanf(optarg, "%x%n", &chunkSize, &n);
-                if ((size_t)n == strlen(optarg)) break;
+                sscanf(optarg, "%llx%n", &value, &n);
+                if ((size_t)n == strlen(optarg)) { chunkSize = value; break; }
                 fprintf(stderr, "%s: Bad argument (%s) to '-c' option.\n", progName, optarg);
                 return EXIT_FAILURE;
             }
             case 'm':          // set memory size
             {
                 int n = 0;
-                sscanf(optarg, "%u%n", &memSize, &n);
-                if ((size_t)n == strlen(optarg)) break;
+                unsigned long long value;
+                sscanf(optarg, "%llu%n", &value, &n);
+                if ((size_t)n == strlen(optarg)) { memSize = value; break; }
                 n = 0;
-                sscanf(optarg, "%x%n", &memSize, &n);
-                if ((size_t)n == strlen(optarg)) break;
+                sscanf(optarg, "%llx%n", &value, &n);
+                if ((size_t)n == strlen(optarg)) { memSize = value; break; }
                 fprintf(stderr, "%s: Bad argument (%s) to '-m' option.\n", progName, optarg);
                 return EXIT_FAILURE;
             }
             case 'k':          // set memory size used by OS
             {
                 int n = 0;
-                sscanf(optarg, "%u%n", &osSize, &n);
-                if ((size_t)n == strlen(optarg)) break;
+                unsigned long long value;
+                sscanf(optarg, "%llu%n", &value, &n);
+                if ((size_t)n == strlen(optarg)) { osSize = value; break; }
                 n = 0;
-                sscanf(optarg, "%x%n", &osSize, &n);
-                if ((size_t)n == strlen(optarg)) break;
+                sscanf(optarg, "%llx%n", &value, &n);
+                if ((size_t)n == strlen(optarg)) { osSize = value; break; }
                 fprintf(stderr, "%s: Bad argument (%s) to '-k' option.\n", progName, optarg);
                 return EXIT_FAILURE;
             }
@@ -157,6 +230,84 @@ int main(int argc, char *argv[])
                 soProbeFile(optarg);
                 break;
             }
+            case 'T':          /* turn on profiling */
+            {
+                FILE *fs = strcmp(optarg, "-") == 0 ? stdout : fopen(optarg, "w");
+                if (fs == NULL)
+                {
+                    fprintf(stderr, "%s: Bad argument (%s): fail opening file.\n", progName, optarg);
+                    return EXIT_FAILURE;
+                }
+                soProfileOpen(fs);
+                break;
+            }
+            case 'M':          /* report simulation metrics */
+            {
+                FILE *fs = strcmp(optarg, "-") == 0 ? stdout : fopen(optarg, "w");
+                if (fs == NULL)
+                {
+                    fprintf(stderr, "%s: Bad argument (%s): fail opening file.\n", progName, optarg);
+                    return EXIT_FAILURE;
+                }
+                soMetricsOpen(fs);
+                break;
+            }
+            case 'C':          /* turn on memory compaction */
+            {
+                uint32_t cnt = 0;
+                if ( (sscanf(optarg, "%u,%u%n", &fixedCost, &chunkCost, &cnt) != 2) 
+                        or (cnt != strlen(optarg)) )
+                {
+                    fprintf(stderr, "%s: Bad argument to '-C' option.\n", progName);
+                    printUsage(progName);
+                    return EXIT_FAILURE;
+                }
+                compaction = true;
+                break;
+            }
+            case 'L':          /* lazy buddy system */
+            {
+                uint32_t cnt = 0;
+                if ( (sscanf(optarg, "%u%n", &lazyWatermark, &cnt) != 1) 
+                        or (cnt != strlen(optarg)) )
+                {
+                    fprintf(stderr, "%s: Bad argument to '-L' option.\n", progName);
+                    printUsage(progName);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            case 'F':          /* first fit over arrays */
+            {
+                fitArray = true;
+                break;
+            }
+            case 'V':          /* validation against a shadow bitmap */
+            {
+                validate = true;
+                break;
+            }
+            case 't':          /* a time stamp per step */
+            {
+                byTime = true;
+                break;
+            }
+            case 'q':          /* batch mode */
+            {
+                batch = true;
+                break;
+            }
+            case 'p':          /* progress lines in batch mode */
+            {
+                uint32_t cnt = 0;
+                if ( (sscanf(optarg, "%u%n", &progress, &cnt) != 1) or (cnt != strlen(optarg)) )
+                {
+                    fprintf(stderr, "%s: Bad argument to '-p' option.\n", progName);
+                    printUsage(progName);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
             case 'P':          /* set ID range to probing system */
             {
                 uint32_t lower, upper;
@@ -251,7 +402,82 @@ int main(int argc, char *argv[])
         }
     }
 
+    /* batch mode: full speed, fully buffered output, and only a final report */
+    if (batch)
+    {
+        setvbuf(fout, NULL, _IOFBF, 1 << 16);
+        if (compaction)
+        {
+            simSetCompaction(true, fixedCost, chunkCost);
+        }
+        if (lazyWatermark != 0)
+        {
+            memLazyMerge(lazyWatermark);
+        }
+        if (validate)
+        {
+            memShadowBitmap(true);
+        }
+        if (fitArray)
+        {
+            memFirstFitArray(true);
+        }
+        simInit(memSize, osSize, chunkSize, memPolicy);
+        if (infile != NULL)
+        {
+            simLoad(infile);
+        }
+
+        uint64_t start = soProfileNow();
+        if (progress == 0 and not validate)
+        {
+            runSteps(0, byTime);
+        }
+        else
+        {
+            /* when validating, the blocks are checked every step, or every progress line */
+            while (not feqIsEmpty())
+            {
+                runSteps(progress != 0 ? progress : 1, byTime);
+                if (progress != 0)
+                {
+                    fprintf(stderr, "step %u, time %" FMT_TIME ", %u active, %u swapped\n",
+                            stepCount, simTime, pctCountInState(ACTIVE), pctCountInState(SWAPPED));
+                }
+                if (validate and not memBitmapCheck())
+                {
+                    fprintf(stderr, "%s: memory blocks disagree with the shadow bitmap at step %u\n", progName, stepCount);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        printReport(fout, soProfileNow() - start);
+
+        simTerm();
+        if (fout != stdout)
+        {
+            fclose(fout);
+        }
+        return EXIT_SUCCESS;
+    }
+
     fprintf(fout, "\n\e[34;1mStarting simulation\e[0m\n\n");
+    if (compaction)
+    {
+        simSetCompaction(true, fixedCost, chunkCost);
+    }
+    if (lazyWatermark != 0)
+    {
+        memLazyMerge(lazyWatermark);
+    }
+    if (validate)
+    {
+        memShadowBitmap(true);
+    }
+    if (fitArray)
+    {
+        memFirstFitArray(true);
+    }
     simInit(memSize, osSize, chunkSize, memPolicy);
     if (infile != NULL)
     {
@@ -274,7 +500,11 @@ int main(int argc, char *argv[])
     }
     
     int counter = 1;
-    while(simStep()) {
+    while(byTime ? simStepTime() : simStep()) {
+        if (validate and not memBitmapCheck()) {
+            fprintf(stderr, "%s: memory blocks disagree with the shadow bitmap at step %d\n", progName, counter);
+            return EXIT_FAILURE;
+        }
         // Imprime o estado da simulação após a primeira etapa
         fprintf(fout, "\n\e[34;1mStep %d\e[0m\n\n",counter);
         simPrint(fout);pctPrint(fout); feqPrint(fout); swpPrint(fout); memPrint(fout);